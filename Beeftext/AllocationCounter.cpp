@@ -0,0 +1,147 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of a class counting heap allocations
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+#ifdef _DEBUG
+#include <crtdbg.h>
+#endif
+
+
+namespace {
+
+
+thread_local qint64 threadAllocationCount = 0; ///< The number of heap allocations performed by the current thread
+
+
+#ifdef _DEBUG
+//**********************************************************************************************************************
+/// \brief CRT allocation hook counting the allocations and reallocations of the current thread.
+///
+/// The hook must not allocate memory or call CRT functions that do.
+///
+/// \return TRUE, so that the allocation proceeds
+//**********************************************************************************************************************
+int __cdecl allocationHook(int allocType, void*, size_t, int blockType, long, unsigned char const*, int)
+{
+   if ((_CRT_BLOCK != blockType) && ((_HOOK_ALLOC == allocType) || (_HOOK_REALLOC == allocType)))
+      ++threadAllocationCount;
+   return TRUE;
+}
+
+
+_CRT_ALLOC_HOOK const previousAllocationHook = _CrtSetAllocHook(allocationHook); ///< Install the hook at startup
+#endif // #ifdef _DEBUG
+
+
+//**********************************************************************************************************************
+/// \param[in] size The size of the block
+/// \return A pointer to the allocated block, or null if the allocation failed
+//**********************************************************************************************************************
+void* allocate(std::size_t size) noexcept
+{
+#ifndef _DEBUG
+   ++threadAllocationCount; // in debug builds, the allocation is counted by the CRT hook
+#endif
+   return std::malloc(size ? size : 1);
+}
+
+
+} // anonymous namespace
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+AllocationCounter::AllocationCounter()
+   : start_(threadAllocationCount)
+{
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+AllocationCounter::~AllocationCounter() = default;
+
+
+//**********************************************************************************************************************
+/// \return The number of heap allocations performed by the current thread since the creation of the counter
+//**********************************************************************************************************************
+qint64 AllocationCounter::count() const
+{
+   return threadAllocationCount - start_;
+}
+
+
+//**********************************************************************************************************************
+// Replacement of the global allocation functions
+//**********************************************************************************************************************
+void* operator new(std::size_t size)
+{
+   if (void* const result = allocate(size))
+      return result;
+   throw std::bad_alloc();
+}
+
+
+void* operator new[](std::size_t size)
+{
+   return operator new(size);
+}
+
+
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept
+{
+   return allocate(size);
+}
+
+
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept
+{
+   return allocate(size);
+}
+
+
+void operator delete(void* p) noexcept
+{
+   std::free(p);
+}
+
+
+void operator delete[](void* p) noexcept
+{
+   std::free(p);
+}
+
+
+void operator delete(void* p, std::size_t) noexcept
+{
+   std::free(p);
+}
+
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+   std::free(p);
+}
+
+
+void operator delete(void* p, std::nothrow_t const&) noexcept
+{
+   std::free(p);
+}
+
+
+void operator delete[](void* p, std::nothrow_t const&) noexcept
+{
+   std::free(p);
+}
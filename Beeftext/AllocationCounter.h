@@ -0,0 +1,39 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of a class counting heap allocations
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_ALLOCATION_COUNTER_H
+#define BEEFTEXT_ALLOCATION_COUNTER_H
+
+
+//**********************************************************************************************************************
+/// \brief A class counting the heap allocations performed by the current thread during its lifetime.
+///
+/// The global operator new is replaced in the executable, so the allocations performed by the code compiled into it
+/// are counted. The cost is an increment of a thread local counter per allocation. The counter is used by the
+/// benchmarks and by the tests, that link the object files of the application. In debug builds, a CRT allocation hook
+/// is used instead, so the allocations performed by the Qt libraries, such as the growth of a QString, are counted
+/// too.
+//**********************************************************************************************************************
+class AllocationCounter
+{
+public: // member functions
+   AllocationCounter(); ///< Default constructor
+   AllocationCounter(AllocationCounter const&) = delete; ///< Disabled copy constructor
+   AllocationCounter(AllocationCounter&&) = delete; ///< Disabled move constructor
+   ~AllocationCounter(); ///< Destructor
+   AllocationCounter& operator=(AllocationCounter const&) = delete; ///< Disabled assignment operator
+   AllocationCounter& operator=(AllocationCounter&&) = delete; ///< Disabled move assignment operator
+   qint64 count() const; ///< Return the number of allocations performed since the creation of the counter
+
+private: // data members
+   qint64 start_ { 0 }; ///< The number of allocations performed by the thread at the creation of the counter
+};
+
+
+#endif // #ifndef BEEFTEXT_ALLOCATION_COUNTER_H
@@ -14,7 +14,7 @@ using namespace xmilib;
 
 
 namespace {
-   QRegularExpression const kBackupFileRegExp(R"(^\d{8}_\d{9}_backup\.json$)");
+   QRegularExpression const kBackupFileRegExp(R"(^\d{8}_\d{9}_backup\.(json|cbor)$)");
    qint32 const kMaxBackupFileCount = 50;
 }
 
@@ -156,7 +156,8 @@ void BackupManager::archive(QString const& filePath) const
    QString const backupFolderPath = globals::backupFolderPath();
    QFileInfo const fileInfo(filePath);
    QString const dstPath = QDir(backupFolderPath)
-      .absoluteFilePath(QString("%1_backup.json").arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmsszzz")));
+      .absoluteFilePath(QString("%1_backup.%2").arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmsszzz"))
+      .arg(fileInfo.suffix()));
    if ((!fileInfo.exists()) || (!QFile(filePath).rename(dstPath)))
       log.addWarning(QString("Could not archive file %1").arg(QDir::toNativeSeparators(dstPath)));
    else
@@ -4,7 +4,7 @@
 
 TEMPLATE = app
 TARGET = Beeftext
-QT += core network gui multimedia widgets
+QT += concurrent core network gui multimedia widgets
 CONFIG += c++14 precompile_header
 PRECOMPILED_HEADER = stdafx.h
 include(Beeftext.pri)
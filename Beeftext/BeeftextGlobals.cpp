@@ -13,6 +13,22 @@
 #include "PreferencesManager.h"
 
 
+namespace {
+
+
+//**********************************************************************************************************************
+/// \return A reference to the path of the sandbox data folder
+//**********************************************************************************************************************
+QString& sandboxDataFolder()
+{
+   static QString path;
+   return path;
+}
+
+
+} // anonymous namespace
+
+
 namespace globals {
 
 
@@ -92,6 +108,9 @@ QString defaultBackupFolderPath()
 //**********************************************************************************************************************
 QString portableModeDataFolderPath()
 {
+   QString const sandboxPath = sandboxDataFolderPath();
+   if (!sandboxPath.isEmpty())
+      return sandboxPath;
    QDir const appDir(QCoreApplication::applicationDirPath());
    return usePortableAppsFolderLayout() ? appDir.absoluteFilePath("../../Data/settings") 
       : appDir.absoluteFilePath("Data");
@@ -123,6 +142,31 @@ QString emojiExcludedAppsFilePath()
    return QDir(appDataDir()).absoluteFilePath("emojiExcludedApps.json");
 }
 
+
+//**********************************************************************************************************************
+/// When a sandbox data folder is set, the application runs in portable mode and stores all its data and settings in
+/// this folder, leaving the user data untouched. This is used for benchmarks.
+///
+/// \return The path of the sandbox data folder
+/// \return A null string if no sandbox data folder is set
+//**********************************************************************************************************************
+QString sandboxDataFolderPath()
+{
+   return sandboxDataFolder();
+}
+
+
+//**********************************************************************************************************************
+/// \note The sandbox data folder must be set before any access to the preferences or data files, as the portable mode
+/// state is cached on first use (see isInPortableMode()).
+///
+/// \param[in] path The path of the sandbox data folder
+//**********************************************************************************************************************
+void setSandboxDataFolderPath(QString const& path)
+{
+   sandboxDataFolder() = path;
+}
+
 //**********************************************************************************************************************
 /// \return the blue color used for the Beeftext GUI.
 //**********************************************************************************************************************
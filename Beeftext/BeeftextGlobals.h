@@ -28,6 +28,8 @@ QString portableModeDataFolderPath(); ///< Returns the path of the user data fol
 QString portableModeSettingsFilePath(); ///< Returns the path of the settings file when the application is run in portable mode
 QString sensitiveApplicationsFilePath(); ///< Return the path of the JSON file containing the list of sensitive applications
 QString emojiExcludedAppsFilePath(); ///< Return the path of the JSON file containing the list of emoji exceptions
+QString sandboxDataFolderPath(); ///< Return the path of the sandbox data folder, or a null string if there is none
+void setSandboxDataFolderPath(QString const& path); ///< Set the path of the sandbox data folder
 
 QColor blueBeeftextColor(); ///< Return the blue color used for the GUI.
 QColor disabledTextColor(); ///< Return the color for disabled text.
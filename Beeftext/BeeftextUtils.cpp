@@ -10,14 +10,12 @@
 #include "stdafx.h"
 #include "BeeftextUtils.h"
 #include "Combo/ComboManager.h"
-#include "SensitiveApplicationManager.h"
-#include "InputManager.h"
 #include "PreferencesManager.h"
 #include "BeeftextGlobals.h"
-#include "Clipboard/ClipboardManagerDefault.h"
+#include "InputBackend/InputBackend.h"
+#include "SubstitutionLatencyMonitor.h"
 #include <Psapi.h>
 #include <XMiLib/SystemUtils.h>
-#include <XMiLib/Exception.h>
 
 
 using namespace xmilib;
@@ -28,8 +26,6 @@ namespace {
 
 QString const kPortableModeBeaconFileName = "Portable.bin"; ///< The name of the 'beacon' file used to detect if the application should run in portable mode
 QString const kPortableAppsModeBeaconFileName = "PortableApps.bin"; ///< The name of the 'beacon file used to detect if the app is in PortableApps mode
-QList<quint16> const modifierKeys = {  VK_LCONTROL, VK_RCONTROL, VK_LMENU, VK_RMENU, VK_LSHIFT, VK_RSHIFT, VK_LWIN,
-   VK_RWIN }; ///< The modifier keys
 QChar const kObjectReplacementChar = 0xfffc; ///< The unicode object replacement character.
 
 
@@ -66,57 +62,18 @@ void debugDisplayModifiersStates()
 //**********************************************************************************************************************
 /// \brief Test if the application is running in portable mode
 /// 
-/// \return true if and only if the application is running in portable mode
+/// \return true if and only if the application is running in portable mode, or uses a sandbox data folder
 //**********************************************************************************************************************
 bool isInPortableModeInternal()
 {
+   if (!globals::sandboxDataFolderPath().isEmpty())
+      return true;
    QDir const appDir(QCoreApplication::applicationDirPath());
    return QFileInfo(appDir.absoluteFilePath(kPortableModeBeaconFileName)).exists() ||
       QFileInfo(appDir.absoluteFilePath(kPortableAppsModeBeaconFileName)).exists();
 }
 
 
-//**********************************************************************************************************************
-/// \brief Retrieve the list of currently pressed modifier key and synthesize a key release event for each of them
-///
-/// \return The list of modifier keys that are pressed
-//**********************************************************************************************************************
-QList<quint16> backupAndReleaseModifierKeys()
-{
-   QList<quint16> result;
-   for (quint16 key: modifierKeys)
-      if (GetKeyState(key) < 0)
-      {
-         result.append(key);
-         synthesizeKeyUp(key);
-      }
-   return result;
-}
-
-
-//**********************************************************************************************************************
-/// \brief Restore the specified modifier keys state by generating a key press event for each of them
-///
-/// \param[in] keys The list of modifiers key to restore by generating a key press event
-//**********************************************************************************************************************
-void restoreModifierKeys(QList<quint16> const& keys)
-{
-   for (quint16 key: keys)
-      synthesizeKeyDown(key);
-}
-
-
-//**********************************************************************************************************************
-/// \brief Wait between keystroke, for an amount time defined in the preferences.
-//**********************************************************************************************************************
-void waitBetweenKeystrokes()
-{
-   qint32 const delayMs = PreferencesManager::instance().delayBetweenKeystrokesMs();
-   if (delayMs > 0)
-      qApp->thread()->msleep(static_cast<quint32>(delayMs));
-}
-
-
 }
 
 
@@ -193,77 +150,22 @@ QString htmlToPlainText(QString const& snippet)
 void performTextSubstitution(qint32 charCount, QString const& newText, qint32 cursorPos,
    ETriggerSource source)
 {
-   InputManager& inputManager = InputManager::instance();
+   LatencySpan const substitutionSpan(ESubstitutionPhase::TextSubstitution);
+   InputBackend& backend = InputBackend::instance();
    PreferencesManager const& prefs = PreferencesManager::instance();
-   bool const wasKeyboardHookEnabled = inputManager.setKeyboardHookEnabled(false);
-   // we disable the hook to prevent endless recursive substitution
-
-   try
-   {
-      // we erase the combo
-      bool const triggeredByPicker = (ETriggerSource::ComboPicker == source);
-      bool const triggersOnSpace = prefs.useAutomaticSubstitution() && prefs.comboTriggersOnSpace();
-      QString text = newText + (triggersOnSpace && prefs.keepFinalSpaceCharacter() && (!triggeredByPicker) 
-         ? " " : QString());
-      QList<quint16> pressedModifiers;
-      if (!triggeredByPicker)
-      {
-         pressedModifiers = backupAndReleaseModifierKeys();
-         synthesizeBackspaces(qMax<qint32>(charCount + (triggersOnSpace ? 1 : 0), 0));
-         restoreModifierKeys(pressedModifiers);
-      }
-      if (!SensitiveApplicationManager::instance().isSensitiveApplication(getActiveExecutableFileName()))
-      {
-         // we use the clipboard to and copy/paste the snippet
-         ClipboardManager& clipboardManager = ClipboardManager::instance();
-         clipboardManager.backupClipboard();
-         clipboardManager.setText(text);
-         pressedModifiers = backupAndReleaseModifierKeys(); ///< We artificially depress the current modifier keys
-         synthesizeKeyDown(VK_LCONTROL);
-         synthesizeKeyDownAndUp('V');
-         synthesizeKeyUp(VK_LCONTROL);
-         restoreModifierKeys(pressedModifiers);
-         QTimer::singleShot(1000, []() { ClipboardManager::instance().restoreClipboard(); });
-         ///< We need to delay clipboard restoration to avoid unexpected behaviours
-      }
-      else
-      {
-         // we simulate the typing of the snippet text
-         for (QChar c: text)
-         {
-            if (c == QChar::LineFeed)
-               // synthesizeUnicode key down does not handle line feed properly (the problem actually comes from Windows API's SendInput())
-            {
-               pressedModifiers = backupAndReleaseModifierKeys();
-               synthesizeKeyDownAndUp(VK_RETURN);
-               restoreModifierKeys(pressedModifiers);
-               waitBetweenKeystrokes();
-            }
-            else
-            {
-               pressedModifiers = backupAndReleaseModifierKeys();
-               synthesizeUnicodeKeyDownAndUp(c.unicode());
-               restoreModifierKeys(pressedModifiers);
-               waitBetweenKeystrokes();
-            }
-         }
-      }
-
-      // position the cursor if needed by typing the right amount of left key strokes
-      if (cursorPos >= 0)
-      {
-         QList<quint16> const pressedModifiers = backupAndReleaseModifierKeys(); ///< We artificially depress the current modifier keys
-         for (qint32 i = 0; i < qMax<qint32>(0, printableCharacterCount(text) - cursorPos); ++i)
-            synthesizeKeyDownAndUp(VK_LEFT);
-         restoreModifierKeys(pressedModifiers);
-      }
-   }
-   catch (Exception const&)
-   {
-      inputManager.setKeyboardHookEnabled(wasKeyboardHookEnabled);
-      throw;
-   }
-   inputManager.setKeyboardHookEnabled(wasKeyboardHookEnabled);
+   // The keyboard capture stays enabled: the events injected by the backend are tagged and ignored by the keyboard
+   // hook, which prevents endless recursive substitution without missing the keystrokes typed in the meantime.
+
+   // the keyword is erased, unless the substitution was triggered by the combo picker
+   bool const triggeredByPicker = (ETriggerSource::ComboPicker == source);
+   bool const triggersOnSpace = prefs.useAutomaticSubstitution() && prefs.comboTriggersOnSpace();
+   QString text = newText + (triggersOnSpace && prefs.keepFinalSpaceCharacter() && (!triggeredByPicker) 
+      ? " " : QString());
+   qint32 const eraseCount = triggeredByPicker ? 0 : charCount + (triggersOnSpace ? 1 : 0);
+
+   // the cursor is positioned if needed by typing the right amount of left key strokes
+   qint32 const cursorLeftCount = (cursorPos >= 0) ? qMax<qint32>(0, printableCharacterCount(text) - cursorPos) : 0;
+   backend.substituteText(eraseCount, text, cursorLeftCount);
    // debugDisplayModifiersStates();
 }
 
@@ -379,3 +281,14 @@ QString colorToHex(QColor const& color, bool includeAlpha)
       result += QString("%1").arg(color.alpha(), 2, 16, zero);
    return result;
 }
+
+
+//**********************************************************************************************************************
+/// \param[in] value The CBOR value.
+/// \return The date/time.
+/// \return A null date/time if the value is not an integer.
+//**********************************************************************************************************************
+QDateTime dateTimeFromCborValue(QCborValue const& value)
+{
+   return value.isInteger() ? QDateTime::fromMSecsSinceEpoch(value.toInteger()) : QDateTime();
+}
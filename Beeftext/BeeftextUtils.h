@@ -34,5 +34,6 @@ QMimeData* mimeDataFromText(QString const& text); ///< Create a MIME data instan
 QMimeData* mimeDataFromHtml(QString const& html);  ///< Create a MIME data instance for HTML content.
 bool warnAndConvertHtmlCombos(); ///< Warn the user about discontinued rich text combo support and convert them to plain text.
 QString colorToHex(QColor const& color, bool includeAlpha); ///< Get a hex representation of a color.
+QDateTime dateTimeFromCborValue(QCborValue const& value); ///< Get a date/time stored in a CBOR value as milliseconds since epoch.
 
 #endif // #ifndef BEEFTEXT_UTILS_H
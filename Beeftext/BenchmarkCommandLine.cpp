@@ -0,0 +1,151 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of functions for running benchmarks from the command line
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "BenchmarkCommandLine.h"
+#include "BeeftextGlobals.h"
+#include "Combo/ComboListBenchmark.h"
+#include "Combo/KeystrokeTraceBenchmark.h"
+#include "InputBackend/InputBackend.h"
+
+
+namespace {
+
+
+QString const kOptionBenchmark = "benchmark"; ///< The command line option for selecting the benchmark
+QString const kOptionOutput = "output"; ///< The command line option for the path of the report file
+QString const kOptionRealTime = "real-time"; ///< The command line option for replaying a keystroke trace in real time
+QString const kBenchmarkLoading = "loading"; ///< The name of the combo list loading benchmark
+QString const kBenchmarkFormats = "formats"; ///< The name of the combo list file format benchmark
+QString const kBenchmarkReplay = "replay"; ///< The name of the keystroke trace replay benchmark
+QString const kUsage = "Usage: Beeftext --benchmark <name> [--output <file>] <arguments>\n\n"
+   "Benchmarks:\n"
+   "   loading <comboListFile>      Compare the streaming and DOM based loading of a combo list file\n"
+   "   formats                      Compare the JSON and binary combo list file formats\n"
+   "   replay [--real-time] <traceFile> <comboListFile>\n"
+   "                                Replay a keystroke trace through the combo manager\n"; ///< The usage text
+
+
+//**********************************************************************************************************************
+/// \param[in] parser The command line parser
+//**********************************************************************************************************************
+void setupParser(QCommandLineParser& parser)
+{
+   parser.addOption(QCommandLineOption(kOptionBenchmark, "The benchmark to run.", "name"));
+   parser.addOption(QCommandLineOption(kOptionOutput, "The file the report is written to.", "file"));
+   parser.addOption(QCommandLineOption(kOptionRealTime, "Respect the delays between the events of the trace."));
+}
+
+
+//**********************************************************************************************************************
+/// Beeftext is a GUI application, so it has no console by default. If the standard output is not redirected, we attach
+/// to the console of the parent process, if any.
+///
+/// \param[in] text The text to print
+//**********************************************************************************************************************
+void printToConsole(QString const& text)
+{
+   if ((!GetStdHandle(STD_OUTPUT_HANDLE)) && AttachConsole(ATTACH_PARENT_PROCESS))
+   {
+      FILE* file = nullptr;
+      freopen_s(&file, "CONOUT$", "w", stdout);
+   }
+   QTextStream stream(stdout);
+   stream << text << endl;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] parser The command line parser
+/// \param[out] outReport The report of the benchmark
+/// \return true if and only if the benchmark name and its arguments are valid
+//**********************************************************************************************************************
+bool runBenchmark(QCommandLineParser const& parser, QString& outReport)
+{
+   QString const name = parser.value(kOptionBenchmark);
+   QStringList const arguments = parser.positionalArguments();
+   if ((kBenchmarkLoading == name) && (1 == arguments.size()))
+   {
+      outReport = benchmarkComboListLoading(arguments[0]);
+      return true;
+   }
+   if ((kBenchmarkFormats == name) && arguments.isEmpty())
+   {
+      outReport = benchmarkComboListFileFormats();
+      return true;
+   }
+   if ((kBenchmarkReplay == name) && (2 == arguments.size()))
+   {
+      outReport = benchmarkKeystrokeTraceReplay(arguments[0], arguments[1], parser.isSet(kOptionRealTime));
+      return true;
+   }
+   return false;
+}
+
+
+} // anonymous namespace
+
+
+//**********************************************************************************************************************
+/// \param[in] arguments The command line arguments, including the executable path
+/// \return true if and only if the command line contains the benchmark option
+//**********************************************************************************************************************
+bool isBenchmarkCommandLine(QStringList const& arguments)
+{
+   QCommandLineParser parser;
+   setupParser(parser);
+   return parser.parse(arguments) && parser.isSet(kOptionBenchmark);
+}
+
+
+//**********************************************************************************************************************
+/// Benchmarks are run in the release build the application is shipped as. The application runs with a temporary
+/// sandbox data folder, so benchmarks never read or modify the preferences and data of the user, and with the headless
+/// input backend, so no keyboard hook is installed and no input is injected into other applications. The report is
+/// printed on the standard output, and written to a file if the output option is set.
+///
+/// \param[in] arguments The command line arguments, including the executable path
+/// \return The exit code for the application
+//**********************************************************************************************************************
+qint32 runBenchmarkCommandLine(QStringList const& arguments)
+{
+   QCommandLineParser parser;
+   setupParser(parser);
+   if (!parser.parse(arguments))
+   {
+      printToConsole(parser.errorText() + "\n\n" + kUsage);
+      return 1;
+   }
+   QTemporaryDir const sandboxDir;
+   if (!sandboxDir.isValid())
+   {
+      printToConsole("Could not create the sandbox data folder for the benchmark.");
+      return 1;
+   }
+   globals::setSandboxDataFolderPath(sandboxDir.path());
+   InputBackend::setInputBackendType(InputBackend::EType::Headless); // must be done before the input manager is created
+   QString report;
+   if (!runBenchmark(parser, report))
+   {
+      printToConsole(kUsage);
+      return 1;
+   }
+   printToConsole(report);
+   QString const outputPath = parser.value(kOptionOutput);
+   if (outputPath.isEmpty())
+      return 0;
+   QFile file(outputPath);
+   if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+   {
+      printToConsole(QString("Could not write the report to '%1'.").arg(QDir::toNativeSeparators(outputPath)));
+      return 1;
+   }
+   QTextStream(&file) << report << endl;
+   return 0;
+}
@@ -0,0 +1,18 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of functions for running benchmarks from the command line
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_BENCHMARK_COMMAND_LINE_H
+#define BEEFTEXT_BENCHMARK_COMMAND_LINE_H
+
+
+bool isBenchmarkCommandLine(QStringList const& arguments); ///< Check whether the command line requests a benchmark
+qint32 runBenchmarkCommandLine(QStringList const& arguments); ///< Run the benchmark requested on the command line
+
+
+#endif // #ifndef BEEFTEXT_BENCHMARK_COMMAND_LINE_H
@@ -9,12 +9,14 @@
 
 #include "stdafx.h"
 #include "Combo.h"
-#include "ComboVariable.h"
 #include "ComboManager.h"
+#include "ComboVariable.h"
 #include "BeeftextUtils.h"
 #include "BeeftextGlobals.h"
 #include "BeeftextConstants.h"
+#include "SubstitutionLatencyMonitor.h"
 #include <utility>
+#include <atomic>
 
 
 using namespace xmilib;
@@ -34,6 +36,17 @@ QString const kPropCreationDateTime = "creationDateTime"; ///< The JSON property
 QString const kPropLastModified = "lastModified"; ///< The JSON property name for the modification date/time, deprecated in combo list file format v3, replaced by "modificationDateTime"
 QString const kPropModificationDateTime = "modificationDateTime"; ///< The JSON property name for the modification date/time, introduced in the combo list file format v3, replacing "lastModified"
 QString const kPropEnabled = "enabled"; ///< The JSON property name for the enabled/disabled state
+qint64 const kCborKeyUuid = 0; ///< The CBOR key for the UUID
+qint64 const kCborKeyName = 1; ///< The CBOR key for the name
+qint64 const kCborKeyKeyword = 2; ///< The CBOR key for the keyword
+qint64 const kCborKeySnippet = 3; ///< The CBOR key for the snippet
+qint64 const kCborKeyUseLooseMatching = 4; ///< The CBOR key for the 'use loose matching' option
+qint64 const kCborKeyCreationDateTime = 5; ///< The CBOR key for the creation date/time
+qint64 const kCborKeyModificationDateTime = 6; ///< The CBOR key for the modification date/time
+qint64 const kCborKeyEnabled = 7; ///< The CBOR key for the enabled/disabled state
+qint64 const kCborKeyGroup = 8; ///< The CBOR key for the UUID of the combo group
+std::atomic<quint64> lookupRevisionCounter { 0 }; ///< The global revision counter for keywords, matching modes and UUIDs
+std::atomic<quint64> revisionCounter { 0 }; ///< The global revision counter for the saved properties of combos
 
 
 } // anonymous namespace
@@ -60,6 +73,7 @@ Combo::Combo(QString name, QString keyword, QString snippet, bool const useLoose
 
 {
    modificationDateTime_ = creationDateTime_ = QDateTime::currentDateTime();
+   snippetTemplate_.compile(snippet_);
 }
 
 
@@ -83,6 +97,7 @@ Combo::Combo(QJsonObject const& object, qint32 formatVersion, GroupList const& g
 {
    if (object.contains(kPropUseHtml) && object[kPropUseHtml].toBool(false))
       snippet_ = htmlToPlainText(snippet_);
+   snippetTemplate_.compile(snippet_);
 
    if (object.contains(kPropGroup))
    {
@@ -101,6 +116,33 @@ Combo::Combo(QJsonObject const& object, qint32 formatVersion, GroupList const& g
 }
 
 
+//**********************************************************************************************************************
+/// \param[in] map The CBOR map
+/// \param[in] groups The list of groups
+//**********************************************************************************************************************
+Combo::Combo(QCborMap const& map, GroupList const& groups)
+   : uuid_(QUuid::fromRfc4122(map.value(kCborKeyUuid).toByteArray()))
+   , name_(map.value(kCborKeyName).toString())
+   , keyword_(map.value(kCborKeyKeyword).toString())
+   , snippet_(map.value(kCborKeySnippet).toString())
+   , useLooseMatching_(map.value(kCborKeyUseLooseMatching).toBool(false))
+   , creationDateTime_(dateTimeFromCborValue(map.value(kCborKeyCreationDateTime)))
+   , modificationDateTime_(dateTimeFromCborValue(map.value(kCborKeyModificationDateTime)))
+   , enabled_(map.value(kCborKeyEnabled).toBool(true))
+{
+   snippetTemplate_.compile(snippet_);
+   QCborValue const groupValue = map.value(kCborKeyGroup);
+   if (groupValue.isByteArray())
+   {
+      GroupList::const_iterator const it = groups.findByUuid(QUuid::fromRfc4122(groupValue.toByteArray()));
+      if (it != groups.end())
+         group_ = *it;
+      else
+         globals::debugLog().addWarning("While parsing combo file, a combo with an invalid group was found.");
+   }
+}
+
+
 //**********************************************************************************************************************
 /// \return true if and only if the combo is valid
 //**********************************************************************************************************************
@@ -158,8 +200,11 @@ void Combo::setKeyword(QString const& keyword)
 {
    if (keyword_ != keyword)
    {
+      QString const previousKeyword = keyword_;
       keyword_ = keyword;
+      ++lookupRevisionCounter;
       this->touch();
+      ComboList::onComboKeywordChanged(*this, previousKeyword);
    }
 }
 
@@ -173,6 +218,15 @@ QString Combo::snippet() const
 }
 
 
+//**********************************************************************************************************************
+/// \return The compiled snippet
+//**********************************************************************************************************************
+ComboSnippetTemplate const& Combo::snippetTemplate() const
+{
+   return snippetTemplate_;
+}
+
+
 //**********************************************************************************************************************
 /// \param[in] snippet The snippet
 //**********************************************************************************************************************
@@ -181,6 +235,7 @@ void Combo::setSnippet(QString const& snippet)
    if (snippet_ != snippet)
    {
       snippet_ = snippet;
+      snippetTemplate_.compile(snippet_);
       this->touch();
    }
 }
@@ -203,6 +258,7 @@ void Combo::setUseLooseMatching(bool useLooseMatching)
    if (useLooseMatching_ != useLooseMatching)
    {
       useLooseMatching_ = useLooseMatching;
+      ++lookupRevisionCounter;
       this->touch();
    }
 }
@@ -273,7 +329,11 @@ void Combo::setGroup(SpGroup const& group)
 void Combo::setEnabled(bool enabled)
 {
    // Note that enabling / disabling an item does not change its last modification date/time
-   enabled_ = enabled;
+   if (enabled_ != enabled)
+   {
+      enabled_ = enabled;
+      revision_ = ++revisionCounter;
+   }
 }
 
 
@@ -307,15 +367,26 @@ bool Combo::matchesForInput(QString const& input) const
 
 
 //**********************************************************************************************************************
+/// The input variables are requested before the evaluation span starts, so the time spent by the user in the input
+/// dialog is not measured.
+///
+/// \param[out] outUserWasPrompted If not null, receives true if and only if an input dialog was displayed
 /// \return true if the substitution was actually performed (it could a been cancelled, for instance by the user
 /// dismissing a variable input dialog.
 //*********************************************************************************************************************
-bool Combo::performSubstitution()
+bool Combo::performSubstitution(bool* outUserWasPrompted)
 {
    qint32 cursorLeftShift = -1;
    bool cancelled = false;
-   QMap<QString, QString> knownInputVariables;
-   QString const& newText = this->evaluatedSnippet(cancelled, QSet<QString>(), knownInputVariables, &cursorLeftShift);
+   ComboEvaluationContext context;
+   bool const inputsProvided = promptForInputVariables(snippetTemplate_, context);
+   if (outUserWasPrompted)
+      *outUserWasPrompted = context.userWasPrompted();
+   if (!inputsProvided)
+      return false;
+   LatencySpan evaluationSpan(ESubstitutionPhase::SnippetEvaluation);
+   QString const& newText = this->evaluatedSnippet(cancelled, context, &cursorLeftShift);
+   cancelled ? evaluationSpan.cancel() : evaluationSpan.finish();
    if (!cancelled)
    {
       performTextSubstitution(keyword_.size(), newText, cursorLeftShift, ETriggerSource::Keyword);
@@ -326,6 +397,9 @@ bool Combo::performSubstitution()
 
 
 //**********************************************************************************************************************
+/// The input variables are requested before the evaluation span starts, so the time spent by the user in the input
+/// dialog is not measured.
+///
 /// \return true if the the snippet was actually inserted(it could a been cancelled, for instance by the user
 /// dismissing a variable input dialog.
 //**********************************************************************************************************************
@@ -333,8 +407,12 @@ bool Combo::insertSnippet(ETriggerSource source)
 {
    qint32 cursorLeftShift = -1;
    bool cancelled = false;
-   QMap<QString, QString> knownInputVariables;
-   QString const& newText = this->evaluatedSnippet(cancelled, QSet<QString>(), knownInputVariables, &cursorLeftShift);
+   ComboEvaluationContext context;
+   if (!promptForInputVariables(snippetTemplate_, context))
+      return false;
+   LatencySpan evaluationSpan(ESubstitutionPhase::SnippetEvaluation);
+   QString const& newText = this->evaluatedSnippet(cancelled, context, &cursorLeftShift);
+   cancelled ? evaluationSpan.cancel() : evaluationSpan.finish();
    if (!cancelled)
    {
       performTextSubstitution(0, newText, cursorLeftShift, source);
@@ -349,18 +427,81 @@ bool Combo::insertSnippet(ETriggerSource source)
 /// \return A JSon object representing this Combo instance
 //**********************************************************************************************************************
 QJsonObject Combo::toJsonObject(bool includeGroup) const
+{
+   return this->record().toJsonObject(includeGroup);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] includeGroup Should the group be included in the map
+/// \return A CBOR map representing the combo
+//**********************************************************************************************************************
+QCborMap Combo::toCborMap(bool includeGroup) const
+{
+   return this->record().toCborMap(includeGroup);
+}
+
+
+//**********************************************************************************************************************
+/// \return A value copy of the saved properties of the combo
+//**********************************************************************************************************************
+ComboRecord Combo::record() const
+{
+   ComboRecord result;
+   result.uuid = uuid_;
+   result.name = name_;
+   result.keyword = keyword_;
+   result.snippet = snippet_;
+   result.useLooseMatching = useLooseMatching_;
+   result.creationDateTime = creationDateTime_;
+   result.modificationDateTime = modificationDateTime_;
+   result.enabled = enabled_;
+   if (group_)
+      result.groupUuid = group_->uuid();
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] includeGroup Should the group be included in the export
+/// \return A JSon object representing the combo
+//**********************************************************************************************************************
+QJsonObject ComboRecord::toJsonObject(bool includeGroup) const
 {
    QJsonObject result;
-   result.insert(kPropUuid, uuid_.toString());
-   result.insert(kPropName, name_);
-   result.insert(kPropKeyword, keyword_);
-   result.insert(kPropSnippet, snippet_);
-   result.insert(kPropUseLooseMatching, useLooseMatching_);
-   result.insert(kPropCreationDateTime, creationDateTime_.toString(constants::kJsonExportDateFormat));
-   result.insert(kPropModificationDateTime, modificationDateTime_.toString(constants::kJsonExportDateFormat));
-   result.insert(kPropEnabled, enabled_);
-   if (includeGroup && group_)
-      result.insert(kPropGroup, group_->uuid().toString());
+   result.insert(kPropUuid, uuid.toString());
+   result.insert(kPropName, name);
+   result.insert(kPropKeyword, keyword);
+   result.insert(kPropSnippet, snippet);
+   result.insert(kPropUseLooseMatching, useLooseMatching);
+   result.insert(kPropCreationDateTime, creationDateTime.toString(constants::kJsonExportDateFormat));
+   result.insert(kPropModificationDateTime, modificationDateTime.toString(constants::kJsonExportDateFormat));
+   result.insert(kPropEnabled, enabled);
+   if (includeGroup && (!groupUuid.isNull()))
+      result.insert(kPropGroup, groupUuid.toString());
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// UUIDs are stored as 16 raw bytes, and date/times as the number of milliseconds since epoch.
+///
+/// \param[in] includeGroup Should the group be included in the map
+/// \return A CBOR map representing the combo
+//**********************************************************************************************************************
+QCborMap ComboRecord::toCborMap(bool includeGroup) const
+{
+   QCborMap result;
+   result.insert(kCborKeyUuid, uuid.toRfc4122());
+   result.insert(kCborKeyName, name);
+   result.insert(kCborKeyKeyword, keyword);
+   result.insert(kCborKeySnippet, snippet);
+   result.insert(kCborKeyUseLooseMatching, useLooseMatching);
+   result.insert(kCborKeyCreationDateTime, creationDateTime.toMSecsSinceEpoch());
+   result.insert(kCborKeyModificationDateTime, modificationDateTime.toMSecsSinceEpoch());
+   result.insert(kCborKeyEnabled, enabled);
+   if (includeGroup && (!groupUuid.isNull()))
+      result.insert(kCborKeyGroup, groupUuid.toRfc4122());
    return result;
 }
 
@@ -370,7 +511,23 @@ QJsonObject Combo::toJsonObject(bool includeGroup) const
 //**********************************************************************************************************************
 void Combo::changeUuid()
 {
+   QUuid const previousUuid = uuid_;
    uuid_ = QUuid::createUuid();
+   ++lookupRevisionCounter;
+   revision_ = ++revisionCounter;
+   ComboList::onComboUuidChanged(*this, previousUuid);
+}
+
+
+//**********************************************************************************************************************
+/// The revision is a global counter value, so that two states of a combo that are saved differently never share the
+/// same revision.
+///
+/// \return The revision number of the saved properties of the combo
+//**********************************************************************************************************************
+quint64 Combo::revision() const
+{
+   return revision_;
 }
 
 
@@ -403,6 +560,19 @@ SpCombo Combo::create(QJsonObject const& object, qint32 formatVersion, GroupList
 }
 
 
+//**********************************************************************************************************************
+/// If the CBOR map is not a valid combo, the constructed combo will be invalid
+///
+/// \param[in] map The map to read from
+/// \param[in] groups The list of combo groups
+/// \return A shared pointer to the created Combo
+//**********************************************************************************************************************
+SpCombo Combo::create(QCborMap const& map, GroupList const& groups)
+{
+   return std::make_shared<Combo>(map, groups);
+}
+
+
 //**********************************************************************************************************************
 /// Note that we make a distinction between a copy that can be generated by a copy constructor or assignment operator
 /// and a duplicate: a duplicate has a different UUID and as such, even if all other field are strictly identical
@@ -422,84 +592,71 @@ SpCombo Combo::duplicate(Combo const& combo)
 }
 
 
+//**********************************************************************************************************************
+/// The value is shared by all combos and is incremented whenever the keyword, the matching mode or the UUID of any
+/// combo is modified. Structures that index combos by these properties compare it to the value they were built with to
+/// detect that they are stale.
+///
+/// \return The current lookup revision number
+//**********************************************************************************************************************
+quint64 Combo::lookupRevision()
+{
+   return lookupRevisionCounter;
+}
+
+
+//**********************************************************************************************************************
+/// The value is shared by all combos and is incremented whenever a saved property of any combo is modified (see 
+/// revision()).
+///
+/// \return The current global revision number
+//**********************************************************************************************************************
+quint64 Combo::globalRevision()
+{
+   return revisionCounter;
+}
+
+
 //**********************************************************************************************************************
 /// This function is named after the UNIX touch command.
 //**********************************************************************************************************************
 void Combo::touch()
 {
    modificationDateTime_ = QDateTime::currentDateTime();
+   revision_ = ++revisionCounter;
 }
 
 
 //**********************************************************************************************************************
-///  This function does not process the #{cursor} variable.
+///  This function does not process the #{cursor} variable. The snippet is evaluated from its compiled form, see
+/// ComboSnippetTemplate.
 ///
 /// \param[out] outCancelled Did the user cancel user input
-/// \param[in] forbiddenSubCombos The text of the combos that are not allowed to be substituted using #{combo:}, to 
-/// avoid endless recursion
-/// \param[in,out] knownInputVariables The list of know input variables.
+/// \param[in,out] context The evaluation context
 /// \return The snippet text once it has been evaluated
 //**********************************************************************************************************************
-QString Combo::evaluatedSnippet(bool& outCancelled, QSet<QString> const& forbiddenSubCombos, 
-   QMap<QString, QString>& knownInputVariables) const
+QString Combo::evaluatedSnippet(bool& outCancelled, ComboEvaluationContext& context) const
 {
-   outCancelled = false;
-   QString remainingText = snippet_;
-   QString result;
-   // The following regular expression detects the first variable #{}, ensuring the closing } is not preceded by a \.
-   // Lazy (a.k.a. non-greedy) operators are used to match the first variable with the smallest possible contents
-   // inside the #{}.
-   QRegularExpression const regexp(R"(#\{((.*?)(?<!\\))\})");
-
-   while (true)
-   {
-      QRegularExpressionMatch match = regexp.match(remainingText);
-      if (!match.hasMatch())
-         return result += remainingText;
-
-      QString variable = match.captured(1);
-      qint32 const pos = match.capturedStart(0);
-      if (pos > 0)
-         result += remainingText.left(pos);
-      remainingText = remainingText.right(remainingText.size() - pos - match.capturedLength(0));
-
-      variable.replace("\\}", "}");
-      result += evaluateVariable(variable, forbiddenSubCombos, knownInputVariables, outCancelled);
-
-      if (outCancelled)
-         return QString();
-   }   
+   return snippetTemplate_.evaluate(context, outCancelled);
 }
 
 
 //**********************************************************************************************************************
 /// \param[out] outCancelled Did the user cancel user input
+/// \param[in,out] context The evaluation context
 /// \param[in] outCursorPos The final position of the cursor, relative to the beginning of the snippet
-/// \param[in] forbiddenSubCombos The text of the combos that are not allowed to be substituted using #{combo:}, to 
-/// avoid endless recursion
-/// \param[in,out] knownInputVariables The list of know input variables.
 /// \return The snippet text once it has been evaluated
 //**********************************************************************************************************************
-QString Combo::evaluatedSnippet(bool& outCancelled, QSet<QString> const& forbiddenSubCombos, 
-   QMap<QString, QString>& knownInputVariables, qint32* outCursorPos) const
+QString Combo::evaluatedSnippet(bool& outCancelled, ComboEvaluationContext& context, qint32* outCursorPos) const
 {
-   QString result = evaluatedSnippet(outCancelled, forbiddenSubCombos, knownInputVariables);
+   outCancelled = !promptForInputVariables(snippetTemplate_, context); // no-op if the inputs are already in the context
    if (outCancelled)
       return QString();
-
-   QString const cursorVariable = "#{cursor}";
-   if (!outCursorPos)
-      return result.remove(cursorVariable);
-
-   qint32 const index = result.lastIndexOf(cursorVariable);
-   if (index < 0)
-   {
-      *outCursorPos = -1;
-      return result;
-   }
-
-   qint32 const lShift = result.length() - (index + cursorVariable.length());
-   result.remove(cursorVariable);
-   *outCursorPos = result.length() - lShift;
-   return result;
+   ComboSnippetBuilder builder(true); // the cursor position is tracked while the snippet is built
+   snippetTemplate_.evaluate(context, builder, outCancelled);
+   if (outCancelled)
+      return QString();
+   if (outCursorPos)
+      *outCursorPos = builder.cursorPosition();
+   return builder.toString();
 }
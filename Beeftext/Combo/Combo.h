@@ -11,6 +11,8 @@
 #define BEEFTEXT_COMBO_H
 
 
+#include "ComboSnippetTemplate.h"
+#include "ComboEvaluationContext.h"
 #include "Group/GroupList.h"
 #include "BeeftextUtils.h"
 #include <memory>
@@ -24,6 +26,29 @@ typedef std::shared_ptr<Combo> SpCombo; ///< Type definition for shared pointer
 typedef std::vector<SpCombo> VecSpCombo; ///< Type definition for vector of SpCombo
 
 
+//**********************************************************************************************************************
+/// \brief A value copy of the saved properties of a combo.
+///
+/// A record does not share any mutable data with the combo it was taken from, so it can be serialized in a worker
+/// thread while the combo is being edited.
+//**********************************************************************************************************************
+struct ComboRecord
+{
+   QUuid uuid; ///< The UUID of the combo
+   QString name; ///< The display name of the combo
+   QString keyword; ///< The keyword
+   QString snippet; ///< The snippet
+   bool useLooseMatching { false }; ///< Should the combo use loose matching
+   QDateTime creationDateTime; ///< The date/time of creation of the combo
+   QDateTime modificationDateTime; ///< The date/time of the last modification of the combo
+   bool enabled { true }; ///< Is the combo enabled
+   QUuid groupUuid; ///< The UUID of the group of the combo, null if the combo has no group
+
+   QJsonObject toJsonObject(bool includeGroup) const; ///< Serialize the record in a JSON object
+   QCborMap toCborMap(bool includeGroup) const; ///< Serialize the record in a CBOR map
+};
+
+
 //**********************************************************************************************************************
 /// \brief The combo class that link a combo keyword and a snippet
 //**********************************************************************************************************************
@@ -32,6 +57,7 @@ class Combo
 public: // member functions
    Combo(QString name, QString keyword, QString snippet, bool useLooseMatching, bool enabled); ///< Default constructor
    Combo(QJsonObject const& object, qint32 formatVersion, GroupList const& groups = GroupList()); ///< Constructor from JSon object
+   Combo(QCborMap const& map, GroupList const& groups); ///< Constructor from CBOR map
    Combo(Combo const&) = delete; ///< Disabled copy constructor
 	Combo(Combo&&) = delete; ///< Disabled move constructor
    ~Combo() = default; ///< Default destructor
@@ -44,6 +70,7 @@ public: // member functions
 	QString keyword() const; ///< retrieve the keyword
    void setKeyword(QString const& keyword); ///< Set the keyword
    QString snippet() const; ///< Retrieve the snippet
+   ComboSnippetTemplate const& snippetTemplate() const; ///< Retrieve the compiled snippet
    void setSnippet(QString const& snippet); ///< Set the snippet
    bool useLooseMatching() const; ///< Test if the combo use loose matching
    void setUseLooseMatching(bool useLooseMatching); ///< Set if the combo uses loose matching
@@ -53,25 +80,29 @@ public: // member functions
    QDateTime lastUseDateTime() const; ///< Retrieve the last use date/time of the combo.
    SpGroup group() const; ///< Get the combo group the combo belongs to
    void setGroup(SpGroup const& group); ///< Set the group this combo belongs to
-   QString evaluatedSnippet(bool& outCancelled, const QSet<QString>& forbiddenSubCombos, 
-      QMap<QString, QString>& knownInputVariables) const; ///< Retrieve the the snippet after having evaluated it, but leave the #{cursor} variable in place.
-   QString evaluatedSnippet(bool& outCancelled, const QSet<QString>& forbiddenSubCombos, 
-      QMap<QString, QString>& knownInputVariables, qint32* outCursorPos) const; ///< Retrieve the the snippet after having evaluated it
+   QString evaluatedSnippet(bool& outCancelled, ComboEvaluationContext& context) const; ///< Retrieve the the snippet after having evaluated it, but leave the #{cursor} variable in place.
+   QString evaluatedSnippet(bool& outCancelled, ComboEvaluationContext& context, qint32* outCursorPos) const; ///< Retrieve the the snippet after having evaluated it
    void setEnabled(bool enabled); ///< Set the combo as enabled or not
    bool isEnabled() const; ///< Check whether the combo is enabled
    bool isUsable() const; ///< Check if the combo is usable, i.e. if it is enabled and member of a group that is enabled.
    bool matchesForInput(QString const& input) const; ///< Check if the combo is a match for the given input
-   bool performSubstitution(); ///< Perform the combo substitution
+   bool performSubstitution(bool* outUserWasPrompted = nullptr); ///< Perform the combo substitution
    bool insertSnippet(ETriggerSource source); ///< Insert the snippet.
    QJsonObject toJsonObject(bool includeGroup) const; ///< Serialize the combo in a JSon object
+   QCborMap toCborMap(bool includeGroup) const; ///< Serialize the combo in a CBOR map
    void changeUuid(); ///< Get a new Uuid for the combo
+   ComboRecord record() const; ///< Return a value copy of the saved properties of the combo
+   quint64 revision() const; ///< Get a number that changes every time a saved property of the combo changes
 
 public: // static functions
    static SpCombo create(QString const& name = QString(), QString const& keyword = QString(),
       QString const& snippet = QString(), bool useLooseMatching = false, bool enabled = true);
    static SpCombo create(QJsonObject const& object, qint32 formatVersion, 
       GroupList const& groups = GroupList()); ///< create a Combo from a JSON object
+   static SpCombo create(QCborMap const& map, GroupList const& groups); ///< create a Combo from a CBOR map
    static SpCombo duplicate(Combo const& combo); ///< Duplicate
+   static quint64 lookupRevision(); ///< Get a number that changes every time a property used to look up combos changes
+   static quint64 globalRevision(); ///< Get a number that changes every time a saved property of any combo changes
 
 private: // member functions
    void touch(); ///< set the modification date/time to now
@@ -81,12 +112,14 @@ private: // data member
    QString name_; ///< The display name of the combo
    QString keyword_; ///< The keyword
    QString snippet_; ///< The snippet
+   ComboSnippetTemplate snippetTemplate_; ///< The compiled snippet
    bool useLooseMatching_ { false }; ///< Should the combo use loose matching
    SpGroup group_ { nullptr }; ///< The combo group this combo belongs to (may be null)
    QDateTime creationDateTime_; ///< The date/time of creation of the combo
    QDateTime modificationDateTime_; ///< The date/time of the last modification of the combo
    QDateTime lastUseDateTime_; ///< The last use date/time
    bool enabled_ { true }; ///< Is the combo enabled
+   quint64 revision_ { 0 }; ///< The revision number of the saved properties of the combo
 };
 
 
@@ -0,0 +1,291 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the dependency graph of combos referencing other combos
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "ComboDependencyGraph.h"
+#include "ComboList.h"
+#include "ComboVariable.h"
+#include "ComboVariableRegistry.h"
+
+
+namespace {
+
+
+//**********************************************************************************************************************
+/// \brief A node of the graph, i.e. a keyword.
+//**********************************************************************************************************************
+struct Node
+{
+   std::vector<qint32> edges; ///< The nodes for the keywords referenced by the combos using this keyword
+   qint32 comboCount { 0 }; ///< The number of combos using this keyword
+   bool hasNonDeterministicVariable { false }; ///< Does a combo using this keyword contain a non deterministic variable
+};
+
+
+//**********************************************************************************************************************
+/// \param[in] snippetTemplate The compiled snippet
+/// \param[out] outHasNonDeterministicVariable If not null, receives true if and only if the snippet contains a
+/// variable that is not deterministic and does not reference a combo
+/// \return The keywords referenced by the snippet
+//**********************************************************************************************************************
+QSet<QString> referencedKeywords(ComboSnippetTemplate const& snippetTemplate,
+   bool* outHasNonDeterministicVariable = nullptr)
+{
+   QSet<QString> result;
+   bool hasNonDeterministicVariable = false;
+   ComboVariableRegistry const& registry = ComboVariableRegistry::instance();
+   for (QString const& variable: snippetTemplate.variables())
+   {
+      QString keyword;
+      if (comboKeywordFromVariable(variable, &keyword))
+         result.insert(keyword);
+      else if (!registry.isDeterministic(variable))
+         hasNonDeterministicVariable = true;
+   }
+   if (outHasNonDeterministicVariable)
+      *outHasNonDeterministicVariable = hasNonDeterministicVariable;
+   return result;
+}
+
+
+} // anonymous namespace
+
+
+//**********************************************************************************************************************
+/// \param[in] comboList The combo list
+/// \param[in] editedCombo The combo being edited. It is ignored if it is part of the combo list
+/// \param[in] keyword The new keyword of the edited combo
+/// \param[in] snippet The new snippet of the edited combo
+/// \return The keywords forming the circular reference, starting and ending with keyword
+/// \return An empty list if the edited combo would not be part of a circular reference
+//**********************************************************************************************************************
+QStringList ComboDependencyGraph::findCycle(ComboList const& comboList, SpCombo const& editedCombo,
+   QString const& keyword, QString const& snippet)
+{
+   QHash<QString, QSet<QString>> dependencies;
+   for (SpCombo const& combo: comboList)
+      if (combo && (combo != editedCombo))
+         dependencies[combo->keyword()].unite(referencedKeywords(combo->snippetTemplate()));
+   dependencies[keyword].unite(referencedKeywords(ComboSnippetTemplate(snippet)));
+
+   // breadth-first search of the shortest path leading back to the keyword
+   QHash<QString, QString> parents;
+   QQueue<QString> queue;
+   queue.enqueue(keyword);
+   while (!queue.isEmpty())
+   {
+      QString const current = queue.dequeue();
+      for (QString const& dependency: dependencies.value(current))
+      {
+         if (dependency == keyword)
+         {
+            QStringList result = { keyword };
+            for (QString node = current; node != keyword; node = parents.value(node))
+               result.prepend(node);
+            result.prepend(keyword);
+            return result;
+         }
+         if (parents.contains(dependency))
+            continue;
+         parents.insert(dependency, current);
+         queue.enqueue(dependency);
+      }
+   }
+   return QStringList();
+}
+
+
+//**********************************************************************************************************************
+/// The strongly connected components of the graph are computed using Tarjan's algorithm. As components are found in
+/// reverse topological order, the determinism of a keyword can be computed as soon as its component is found.
+///
+/// \param[in] comboList The combo list
+//**********************************************************************************************************************
+void ComboDependencyGraph::build(ComboList const& comboList)
+{
+   cyclicKeywords_.clear();
+   deterministicKeywords_.clear();
+   expansionCache_.clear();
+
+   QHash<QString, qint32> nodeIndexes;
+   QStringList keywords;
+   std::vector<Node> nodes;
+   auto const nodeIndex = [&](QString const& keyword) -> qint32
+   {
+      QHash<QString, qint32>::const_iterator const it = nodeIndexes.constFind(keyword);
+      if (it != nodeIndexes.constEnd())
+         return it.value();
+      qint32 const result = static_cast<qint32>(nodes.size());
+      nodeIndexes.insert(keyword, result);
+      keywords.append(keyword);
+      nodes.emplace_back();
+      return result;
+   };
+   for (SpCombo const& combo: comboList)
+   {
+      if (!combo)
+         continue;
+      qint32 const index = nodeIndex(combo->keyword());
+      bool hasNonDeterministicVariable = false;
+      QSet<QString> const dependencies = referencedKeywords(combo->snippetTemplate(), &hasNonDeterministicVariable);
+      for (QString const& dependency: dependencies)
+      {
+         qint32 const dependencyIndex = nodeIndex(dependency); // may reallocate nodes
+         nodes[static_cast<quint32>(index)].edges.push_back(dependencyIndex);
+      }
+      Node& node = nodes[static_cast<quint32>(index)];
+      ++node.comboCount;
+      node.hasNonDeterministicVariable = node.hasNonDeterministicVariable || hasNonDeterministicVariable;
+   }
+
+   quint32 const nodeCount = static_cast<quint32>(nodes.size());
+   std::vector<qint32> order(nodeCount, -1); // the visiting order of each node, or -1 if not visited yet
+   std::vector<qint32> lowLink(nodeCount, 0);
+   std::vector<bool> onStack(nodeCount, false);
+   std::vector<bool> deterministic(nodeCount, false); // for missing keywords, this is the determinism of the fallback
+   std::vector<qint32> stack;
+   std::vector<std::pair<qint32, quint32>> callStack; // the nodes being visited, with their next edge to explore
+   qint32 counter = 0;
+   auto const visit = [&](qint32 v)
+   {
+      order[static_cast<quint32>(v)] = lowLink[static_cast<quint32>(v)] = counter++;
+      stack.push_back(v);
+      onStack[static_cast<quint32>(v)] = true;
+      callStack.emplace_back(v, 0);
+   };
+   for (qint32 root = 0; root < static_cast<qint32>(nodeCount); ++root)
+   {
+      if (order[static_cast<quint32>(root)] >= 0)
+         continue;
+      visit(root);
+      while (!callStack.empty())
+      {
+         qint32 const v = callStack.back().first;
+         quint32 const v32 = static_cast<quint32>(v);
+         quint32 const edgeIndex = callStack.back().second;
+         if (edgeIndex < nodes[v32].edges.size())
+         {
+            ++callStack.back().second;
+            qint32 const w = nodes[v32].edges[edgeIndex];
+            if (order[static_cast<quint32>(w)] < 0)
+               visit(w);
+            else if (onStack[static_cast<quint32>(w)])
+               lowLink[v32] = qMin(lowLink[v32], order[static_cast<quint32>(w)]);
+            continue;
+         }
+
+         callStack.pop_back();
+         if (!callStack.empty())
+         {
+            quint32 const parent = static_cast<quint32>(callStack.back().first);
+            lowLink[parent] = qMin(lowLink[parent], lowLink[v32]);
+         }
+         if (lowLink[v32] != order[v32])
+            continue;
+
+         // v is the root of a strongly connected component
+         std::vector<qint32> component;
+         qint32 w = -1;
+         do
+         {
+            w = stack.back();
+            stack.pop_back();
+            onStack[static_cast<quint32>(w)] = false;
+            component.push_back(w);
+         } while (w != v);
+         Node const& node = nodes[v32];
+         bool const isCyclic = (component.size() > 1)
+            || (node.edges.end() != std::find(node.edges.begin(), node.edges.end(), v));
+         if (isCyclic)
+         {
+            for (qint32 const c: component)
+               cyclicKeywords_.insert(keywords[c]);
+            continue;
+         }
+         bool isDeterministic = (0 == node.comboCount);
+         if (1 == node.comboCount)
+            isDeterministic = (!node.hasNonDeterministicVariable) && std::all_of(node.edges.begin(), node.edges.end(),
+               [&](qint32 e) -> bool { return deterministic[static_cast<quint32>(e)]; });
+         deterministic[v32] = isDeterministic;
+         if (isDeterministic && (1 == node.comboCount))
+            deterministicKeywords_.insert(keywords[v]);
+      }
+   }
+
+   listRevision_ = comboList.revision();
+   comboRevision_ = Combo::globalRevision();
+   built_ = true;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] comboList The combo list
+/// \return true if and only if the graph was built from the combo list, and no combo was modified since
+//**********************************************************************************************************************
+bool ComboDependencyGraph::isUpToDate(ComboList const& comboList) const
+{
+   return built_ && (listRevision_ == comboList.revision()) && (comboRevision_ == Combo::globalRevision());
+}
+
+
+//**********************************************************************************************************************
+/// \return The keywords that are part of a circular reference, sorted alphabetically
+//**********************************************************************************************************************
+QStringList ComboDependencyGraph::cyclicKeywords() const
+{
+   QStringList result = cyclicKeywords_.values();
+   result.sort();
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] keyword The keyword
+/// \return true if and only if the keyword is part of a circular reference
+//**********************************************************************************************************************
+bool ComboDependencyGraph::isCyclic(QString const& keyword) const
+{
+   return cyclicKeywords_.contains(keyword);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] keyword The keyword
+/// \return true if and only if the expansion of the keyword is deterministic, and can be cached
+//**********************************************************************************************************************
+bool ComboDependencyGraph::isDeterministic(QString const& keyword) const
+{
+   return deterministicKeywords_.contains(keyword);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] keyword The keyword
+/// \param[out] outExpansion If the function returns true, receives the cached expansion
+/// \return true if and only if the expansion of the keyword was found in the cache
+//**********************************************************************************************************************
+bool ComboDependencyGraph::cachedExpansion(QString const& keyword, QString& outExpansion) const
+{
+   QHash<QString, QString>::const_iterator const it = expansionCache_.constFind(keyword);
+   if (it == expansionCache_.constEnd())
+      return false;
+   outExpansion = it.value();
+   return true;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] keyword The keyword
+/// \param[in] expansion The expansion of the keyword
+//**********************************************************************************************************************
+void ComboDependencyGraph::cacheExpansion(QString const& keyword, QString const& expansion)
+{
+   if (this->isDeterministic(keyword))
+      expansionCache_.insert(keyword, expansion);
+}
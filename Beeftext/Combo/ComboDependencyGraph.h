@@ -0,0 +1,60 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of the dependency graph of combos referencing other combos
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_COMBO_DEPENDENCY_GRAPH_H
+#define BEEFTEXT_COMBO_DEPENDENCY_GRAPH_H
+
+
+#include "Combo.h"
+
+
+class ComboList;
+
+
+//**********************************************************************************************************************
+/// \brief The graph of the keywords referenced by the snippets of a combo list, through #{combo:}, #{upper:},
+/// #{lower:} and #{trim:} variables.
+///
+/// The graph identifies the keywords that are part of a circular reference, and the keywords whose expansion is
+/// deterministic: a single combo uses the keyword, and its snippet only contains deterministic variables (see
+/// ComboVariableRegistry) and references to deterministic keywords. The expansions of deterministic keywords are
+/// cached until the graph is rebuilt, which happens as soon as any combo of the list is modified.
+//**********************************************************************************************************************
+class ComboDependencyGraph
+{
+public: // static member functions
+   static QStringList findCycle(ComboList const& comboList, SpCombo const& editedCombo, QString const& keyword,
+      QString const& snippet); ///< Find a circular reference that an edited combo would be part of
+
+public: // member functions
+   ComboDependencyGraph() = default; ///< Default constructor
+   ComboDependencyGraph(ComboDependencyGraph const&) = delete; ///< Disabled copy constructor
+   ComboDependencyGraph(ComboDependencyGraph&&) = delete; ///< Disabled move constructor
+   ~ComboDependencyGraph() = default; ///< Default destructor
+   ComboDependencyGraph& operator=(ComboDependencyGraph const&) = delete; ///< Disabled assignment operator
+   ComboDependencyGraph& operator=(ComboDependencyGraph&&) = delete; ///< Disabled move assignment operator
+   void build(ComboList const& comboList); ///< Build the graph from a combo list
+   bool isUpToDate(ComboList const& comboList) const; ///< Check whether the graph reflects the current state of a combo list
+   QStringList cyclicKeywords() const; ///< Return the keywords that are part of a circular reference
+   bool isCyclic(QString const& keyword) const; ///< Check whether a keyword is part of a circular reference
+   bool isDeterministic(QString const& keyword) const; ///< Check whether the expansion of a keyword is deterministic
+   bool cachedExpansion(QString const& keyword, QString& outExpansion) const; ///< Retrieve the cached expansion of a keyword
+   void cacheExpansion(QString const& keyword, QString const& expansion); ///< Cache the expansion of a keyword if it is deterministic
+
+private: // data members
+   QSet<QString> cyclicKeywords_; ///< The keywords that are part of a circular reference
+   QSet<QString> deterministicKeywords_; ///< The keywords whose expansion is deterministic
+   QHash<QString, QString> expansionCache_; ///< The cached expansions of deterministic keywords
+   quint64 listRevision_ { 0 }; ///< The revision of the combo list the graph was built from
+   quint64 comboRevision_ { 0 }; ///< The global revision of combos when the graph was built
+   bool built_ { false }; ///< Has the graph been built
+};
+
+
+#endif // #ifndef BEEFTEXT_COMBO_DEPENDENCY_GRAPH_H
@@ -124,9 +124,18 @@ bool ComboDialog::checkAndReportInvalidCombo()
       return false;
    }
 
-   // we check that the keyword is not already in use
+   // we check that the combo is not part of a circular reference through #{combo:} variables
    QString const newKeyword = ui_.editKeyword->text();
    ComboList const& comboList = ComboManager::instance().comboListRef();
+   QStringList const cycle = ComboDependencyGraph::findCycle(comboList, combo_, newKeyword, 
+      ui_.comboEditor->plainText());
+   if ((!cycle.isEmpty()) && (QMessageBox::Yes != QMessageBox::question(this, tr("Circular Reference"),
+      tr("This combo is part of a circular reference: %1.\n\nCombos that are part of a circular reference are not "
+      "fully expanded. Do you want to continue anyway?").arg(cycle.join(" -> ")),
+      QMessageBox::Yes | QMessageBox::No, QMessageBox::No)))
+      return false;
+
+   // we check that the keyword is not already in use
    if ((!newKeyword.isEmpty()) && (comboList.end() != std::find_if(comboList.begin(), 
       comboList.end(), [&](SpCombo const& existing) -> bool      
       { return (existing != combo_) && (existing->keyword() == newKeyword);})))
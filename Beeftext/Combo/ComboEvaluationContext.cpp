@@ -0,0 +1,123 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the context of the evaluation of a snippet
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "ComboEvaluationContext.h"
+#include "Clipboard/ClipboardManager.h"
+
+
+//**********************************************************************************************************************
+/// \param[in] keyword The keyword
+/// \return true if and only if the keyword is being expanded, and cannot be expanded again
+//**********************************************************************************************************************
+bool ComboEvaluationContext::isForbiddenCombo(QString const& keyword) const
+{
+   return forbiddenCombos_.contains(keyword);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] keyword The keyword
+//**********************************************************************************************************************
+void ComboEvaluationContext::addForbiddenCombo(QString const& keyword)
+{
+   forbiddenCombos_.insert(keyword);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] keyword The keyword
+//**********************************************************************************************************************
+void ComboEvaluationContext::removeForbiddenCombo(QString const& keyword)
+{
+   forbiddenCombos_.remove(keyword);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] description The description of the input variable
+/// \param[out] outValue If the function returns true, receives the value entered by the user
+/// \return true if and only if the user already entered a value for the description
+//**********************************************************************************************************************
+bool ComboEvaluationContext::inputValue(QString const& description, QString& outValue) const
+{
+   QMap<QString, QString>::const_iterator const it = inputValues_.constFind(description);
+   if (it == inputValues_.constEnd())
+      return false;
+   outValue = it.value();
+   return true;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] description The description of the input variable
+/// \param[in] value The value entered by the user
+//**********************************************************************************************************************
+void ComboEvaluationContext::setInputValue(QString const& description, QString const& value)
+{
+   inputValues_.insert(description, value);
+}
+
+
+//**********************************************************************************************************************
+/// \return true if and only if an input dialog was displayed during the expansion
+//**********************************************************************************************************************
+bool ComboEvaluationContext::userWasPrompted() const
+{
+   return userWasPrompted_;
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void ComboEvaluationContext::setUserWasPrompted()
+{
+   userWasPrompted_ = true;
+}
+
+
+//**********************************************************************************************************************
+/// \return The text content of the clipboard when it was first requested during the expansion
+//**********************************************************************************************************************
+QString ComboEvaluationContext::clipboardText()
+{
+   if (!hasClipboardText_)
+   {
+      clipboardText_ = ClipboardManager::instance().text();
+      hasClipboardText_ = true;
+   }
+   return clipboardText_;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] name The name of the environment variable
+/// \return The value of the variable in the environment, as it was when first requested during the expansion
+//**********************************************************************************************************************
+QString ComboEvaluationContext::environmentVariable(QString const& name)
+{
+   if (!hasEnvironment_)
+   {
+      environment_ = QProcessEnvironment::systemEnvironment();
+      hasEnvironment_ = true;
+   }
+   return environment_.value(name);
+}
+
+
+//**********************************************************************************************************************
+/// \return The date/time when it was first requested during the expansion
+//**********************************************************************************************************************
+QDateTime ComboEvaluationContext::currentDateTime()
+{
+   if (!currentDateTime_.isValid())
+      currentDateTime_ = QDateTime::currentDateTime();
+   return currentDateTime_;
+}
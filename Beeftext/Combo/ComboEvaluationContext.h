@@ -0,0 +1,54 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of the context of the evaluation of a snippet
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_COMBO_EVALUATION_CONTEXT_H
+#define BEEFTEXT_COMBO_EVALUATION_CONTEXT_H
+
+
+//**********************************************************************************************************************
+/// \brief The state shared by all the variables evaluated during a single expansion, including the expansions of
+/// sub-combos.
+///
+/// The context keeps track of the combos being expanded, to avoid endless recursion, and of the values entered by
+/// the user for #{input:} variables. The external sources used by variables (clipboard, environment, current
+/// date/time) are fetched on first use, and the same snapshot is used for the rest of the expansion.
+//**********************************************************************************************************************
+class ComboEvaluationContext
+{
+public: // member functions
+   ComboEvaluationContext() = default; ///< Default constructor
+   ComboEvaluationContext(ComboEvaluationContext const&) = delete; ///< Disabled copy constructor
+   ComboEvaluationContext(ComboEvaluationContext&&) = delete; ///< Disabled move constructor
+   ~ComboEvaluationContext() = default; ///< Default destructor
+   ComboEvaluationContext& operator=(ComboEvaluationContext const&) = delete; ///< Disabled assignment operator
+   ComboEvaluationContext& operator=(ComboEvaluationContext&&) = delete; ///< Disabled move assignment operator
+   bool isForbiddenCombo(QString const& keyword) const; ///< Check whether a keyword cannot be expanded, to avoid endless recursion
+   void addForbiddenCombo(QString const& keyword); ///< Forbid the expansion of a keyword
+   void removeForbiddenCombo(QString const& keyword); ///< Allow again the expansion of a keyword
+   bool inputValue(QString const& description, QString& outValue) const; ///< Retrieve the value entered for an #{input:} variable
+   void setInputValue(QString const& description, QString const& value); ///< Set the value entered for an #{input:} variable
+   bool userWasPrompted() const; ///< Check whether an input dialog was displayed during the expansion
+   void setUserWasPrompted(); ///< Report that an input dialog was displayed during the expansion
+   QString clipboardText(); ///< Return the text content of the clipboard
+   QString environmentVariable(QString const& name); ///< Return the value of an environment variable
+   QDateTime currentDateTime(); ///< Return the current date/time
+
+private: // data members
+   QSet<QString> forbiddenCombos_; ///< The keywords that cannot be expanded
+   QMap<QString, QString> inputValues_; ///< The values entered for #{input:} variables, keyed by description
+   QString clipboardText_; ///< The text content of the clipboard
+   QProcessEnvironment environment_; ///< The environment
+   QDateTime currentDateTime_; ///< The current date/time
+   bool hasClipboardText_ { false }; ///< Has the clipboard content been fetched
+   bool hasEnvironment_ { false }; ///< Has the environment been fetched
+   bool userWasPrompted_ { false }; ///< Was an input dialog displayed during the expansion
+};
+
+
+#endif // #ifndef BEEFTEXT_COMBO_EVALUATION_CONTEXT_H
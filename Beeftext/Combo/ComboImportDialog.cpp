@@ -198,14 +198,14 @@ void ComboImportDialog::performFinalImport(qint32& outFailureCount)
 
    for (SpCombo const& combo : conflictingNewerCombos_)
    {
-      ComboList::iterator const it = comboList.findByKeyword(combo->keyword());
+      ComboList::const_iterator const it = comboList.findByKeyword(combo->keyword());
       if (it == comboList.end())
       {
          ++failureCount;
          continue;
       }
       combo->setGroup(group);
-      *it = combo;
+      comboList.replace(static_cast<qint32>(it - comboList.begin()), combo);
    }
 }
 
@@ -223,9 +223,7 @@ void ComboImportDialog::onActionImport()
       qint32 failureCount = 0;
       this->performFinalImport(failureCount);
 
-      QString errorMsg;
-      if ((!ComboManager::instance().saveComboListToFile(&errorMsg)))
-         QMessageBox::critical(this, tr("Error"), errorMsg);
+      ComboManager::instance().requestComboListSave();
 
       if (failureCount)
       {
@@ -0,0 +1,159 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the keyword automaton used to detect combo keywords as they are typed
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "ComboKeywordAutomaton.h"
+#include "ComboList.h"
+#include <numeric>
+
+
+//**********************************************************************************************************************
+/// \return The initial state of the automaton, corresponding to an empty input.
+//**********************************************************************************************************************
+ComboKeywordAutomaton::State ComboKeywordAutomaton::rootState()
+{
+   return 0;
+}
+
+
+//**********************************************************************************************************************
+/// All combos with a non-empty keyword are included, whether they are usable or not: usability depends on the groups
+/// and can change without the combo list being modified, so it is checked when retrieving matches.
+///
+/// \param[in] comboList The combo list.
+//**********************************************************************************************************************
+void ComboKeywordAutomaton::build(ComboList const& comboList)
+{
+   this->clear();
+   trie_.build(comboList, ComboKeywordTrie::EDirection::Forward);
+   links_.resize(static_cast<quint32>(trie_.nodeCount()));
+
+   // compute the failure and output links, processing the states by increasing depth
+   std::vector<State> order(links_.size());
+   std::iota(order.begin(), order.end(), 0);
+   std::stable_sort(order.begin(), order.end(), [&](State lhs, State rhs) -> bool
+      { return trie_.node(lhs).depth < trie_.node(rhs).depth; });
+   for (State const state: order)
+   {
+      ComboKeywordTrie::Node const& node = trie_.node(state);
+      if (node.depth <= 1)
+         continue; // the failure link of the root and of its children is the root, and they have no output link
+      State failure = links_[static_cast<quint32>(node.parent)].failure;
+      while (true)
+      {
+         State const next = this->transition(failure, node.character);
+         if (next >= 0)
+         {
+            failure = next;
+            break;
+         }
+         if (rootState() == failure)
+            break;
+         failure = links_[static_cast<quint32>(failure)].failure;
+      }
+      Links& links = links_[static_cast<quint32>(state)];
+      links.failure = failure;
+      links.output = trie_.node(failure).comboCount > 0 ? failure : links_[static_cast<quint32>(failure)].output;
+   }
+
+   revision_ = comboList.revision();
+   built_ = true;
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void ComboKeywordAutomaton::clear()
+{
+   trie_.clear();
+   links_.clear();
+   revision_ = 0;
+   built_ = false;
+}
+
+
+//**********************************************************************************************************************
+/// \return true if and only if the automaton has been built.
+//**********************************************************************************************************************
+bool ComboKeywordAutomaton::isBuilt() const
+{
+   return built_;
+}
+
+
+//**********************************************************************************************************************
+/// \return The revision of the combo list the automaton was built from (see ComboList::revision()).
+//**********************************************************************************************************************
+quint64 ComboKeywordAutomaton::revision() const
+{
+   return revision_;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] state The current state.
+/// \param[in] c The character that was read.
+/// \return The new state of the automaton.
+//**********************************************************************************************************************
+ComboKeywordAutomaton::State ComboKeywordAutomaton::nextState(State state, QChar c) const
+{
+   if (!built_)
+      return rootState();
+   while (true)
+   {
+      State const next = this->transition(state, c);
+      if (next >= 0)
+         return next;
+      if (rootState() == state)
+         return rootState();
+      state = links_[static_cast<quint32>(state)].failure;
+   }
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] state The state reached after reading the input.
+/// \param[in] inputLength The length of the input. Strict matching combos only match if their keyword is the whole
+/// input.
+/// \return The usable combos that match the input, in the order of the combo list for a given keyword.
+//**********************************************************************************************************************
+VecSpCombo ComboKeywordAutomaton::matches(State state, qint32 inputLength) const
+{
+   VecSpCombo result;
+   if ((!built_) || (state < 0) || (state >= trie_.nodeCount()))
+      return result;
+   if (0 == trie_.node(state).comboCount)
+      state = links_[static_cast<quint32>(state)].output;
+   while (state >= 0)
+   {
+      ComboKeywordTrie::Node const& node = trie_.node(state);
+      bool const isWholeInput = (node.depth == inputLength);
+      for (qint32 i = node.firstCombo; i < node.firstCombo + node.comboCount; ++i)
+      {
+         SpCombo const& combo = trie_.combo(i);
+         if (combo->isUsable() && (isWholeInput || combo->useLooseMatching()))
+            result.push_back(combo);
+      }
+      state = links_[static_cast<quint32>(state)].output;
+   }
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] state The state.
+/// \param[in] c The character.
+/// \return The state reached by the goto transition.
+/// \return -1 if there is no such transition.
+//**********************************************************************************************************************
+ComboKeywordAutomaton::State ComboKeywordAutomaton::transition(State state, QChar c) const
+{
+   return trie_.child(state, c);
+}
@@ -0,0 +1,67 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of the keyword automaton used to detect combo keywords as they are typed
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_COMBO_KEYWORD_AUTOMATON_H
+#define BEEFTEXT_COMBO_KEYWORD_AUTOMATON_H
+
+
+#include "ComboKeywordTrie.h"
+
+
+class ComboList;
+
+
+//**********************************************************************************************************************
+/// \brief An Aho-Corasick automaton recognizing the keywords of a combo list.
+///
+/// The automaton is fed one character at a time. The state reached after reading an input identifies all the keywords
+/// that are suffixes of this input, so detecting strict and loose matches costs an amortized constant time per
+/// character, whatever the number of combos.
+//**********************************************************************************************************************
+class ComboKeywordAutomaton
+{
+public: // data types
+   typedef qint32 State; ///< Type definition for automaton states
+
+public: // static member functions
+   static State rootState(); ///< Return the initial state of the automaton
+
+public: // member functions
+   ComboKeywordAutomaton() = default; ///< Default constructor
+   ComboKeywordAutomaton(ComboKeywordAutomaton const&) = delete; ///< Disabled copy constructor
+   ComboKeywordAutomaton(ComboKeywordAutomaton&&) = delete; ///< Disabled move constructor
+   ~ComboKeywordAutomaton() = default; ///< Default destructor
+   ComboKeywordAutomaton& operator=(ComboKeywordAutomaton const&) = delete; ///< Disabled assignment operator
+   ComboKeywordAutomaton& operator=(ComboKeywordAutomaton&&) = delete; ///< Disabled move assignment operator
+   void build(ComboList const& comboList); ///< Build the automaton from the keywords of a combo list
+   void clear(); ///< Clear the automaton
+   bool isBuilt() const; ///< Check whether the automaton has been built
+   quint64 revision() const; ///< Return the revision of the combo list the automaton was built from
+   State nextState(State state, QChar c) const; ///< Compute the state reached after reading a character
+   VecSpCombo matches(State state, qint32 inputLength) const; ///< Return the usable combos matching an input
+
+private: // data types
+   struct Links
+   {
+      State failure { 0 }; ///< The state for the longest proper suffix of this state that is in the automaton
+      State output { -1 }; ///< The nearest state in the failure chain that terminates a keyword, or -1
+   }; ///< The failure and output links of a state of the automaton
+
+private: // member functions
+   State transition(State state, QChar c) const; ///< Return the goto transition for a state and a character, or -1
+
+private: // data members
+   ComboKeywordTrie trie_; ///< The trie of keywords, whose nodes are the states of the automaton (goto function)
+   std::vector<Links> links_; ///< The failure and output links of each state
+   quint64 revision_ { 0 }; ///< The revision of the combo list the automaton was built from
+   bool built_ { false }; ///< Has the automaton been built
+};
+
+
+#endif // #ifndef BEEFTEXT_COMBO_KEYWORD_AUTOMATON_H
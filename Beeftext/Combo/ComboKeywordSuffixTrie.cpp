@@ -0,0 +1,117 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the suffix trie used to look up the combos matching an input
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "ComboKeywordSuffixTrie.h"
+#include "ComboList.h"
+
+
+//**********************************************************************************************************************
+/// As for the keyword automaton, all combos with a non-empty keyword are included, and usability is checked when
+/// retrieving matches.
+///
+/// \param[in] comboList The combo list.
+//**********************************************************************************************************************
+void ComboKeywordSuffixTrie::build(ComboList const& comboList)
+{
+   this->clear();
+   trie_.build(comboList, ComboKeywordTrie::EDirection::Backward);
+   revision_ = comboList.revision();
+   built_ = true;
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void ComboKeywordSuffixTrie::clear()
+{
+   trie_.clear();
+   revision_ = 0;
+   built_ = false;
+}
+
+
+//**********************************************************************************************************************
+/// \return true if and only if the trie has been built.
+//**********************************************************************************************************************
+bool ComboKeywordSuffixTrie::isBuilt() const
+{
+   return built_;
+}
+
+
+//**********************************************************************************************************************
+/// \return The revision of the combo list the trie was built from (see ComboList::revision()).
+//**********************************************************************************************************************
+quint64 ComboKeywordSuffixTrie::revision() const
+{
+   return revision_;
+}
+
+
+//**********************************************************************************************************************
+/// The input is walked backwards once. Strict matching combos only match if their keyword is the whole input, loose
+/// matching combos match if their keyword is a suffix of the input.
+///
+/// \param[in] input The input.
+/// \return The usable combos that match the input, sorted by decreasing keyword length, then in combo list order.
+//**********************************************************************************************************************
+VecSpCombo ComboKeywordSuffixTrie::matches(QString const& input) const
+{
+   VecSpCombo result;
+   if (!built_)
+      return result;
+   QVarLengthArray<qint32, 32> terminalNodes; // the nodes holding combos met during the walk, by increasing depth
+   qint32 node = 0;
+   for (qint32 i = input.size() - 1; i >= 0; --i)
+   {
+      node = trie_.child(node, input[i]);
+      if (node < 0)
+         break;
+      if (trie_.node(node).comboCount > 0)
+         terminalNodes.push_back(node);
+   }
+   for (qint32 i = terminalNodes.size() - 1; i >= 0; --i)
+   {
+      ComboKeywordTrie::Node const& terminal = trie_.node(terminalNodes[i]);
+      bool const isWholeInput = (terminal.depth == input.size());
+      for (qint32 j = terminal.firstCombo; j < terminal.firstCombo + terminal.comboCount; ++j)
+      {
+         SpCombo const& combo = trie_.combo(j);
+         if (combo->isUsable() && (isWholeInput || combo->useLooseMatching()))
+            result.push_back(combo);
+      }
+   }
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] keyword The keyword.
+/// \return All the combos with the given keyword, whether they are usable or not, in combo list order.
+//**********************************************************************************************************************
+VecSpCombo ComboKeywordSuffixTrie::combosWithKeyword(QString const& keyword) const
+{
+   if ((!built_) || keyword.isEmpty())
+      return VecSpCombo();
+   qint32 node = 0;
+   for (qint32 i = keyword.size() - 1; i >= 0; --i)
+   {
+      node = trie_.child(node, keyword[i]);
+      if (node < 0)
+         return VecSpCombo();
+   }
+   ComboKeywordTrie::Node const& terminal = trie_.node(node);
+   VecSpCombo result;
+   result.reserve(static_cast<quint32>(terminal.comboCount));
+   for (qint32 i = terminal.firstCombo; i < terminal.firstCombo + terminal.comboCount; ++i)
+      result.push_back(trie_.combo(i));
+   return result;
+}
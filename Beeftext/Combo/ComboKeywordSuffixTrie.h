@@ -0,0 +1,49 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of the suffix trie used to look up the combos matching an input
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_COMBO_KEYWORD_SUFFIX_TRIE_H
+#define BEEFTEXT_COMBO_KEYWORD_SUFFIX_TRIE_H
+
+
+#include "ComboKeywordTrie.h"
+
+
+class ComboList;
+
+
+//**********************************************************************************************************************
+/// \brief A trie of reversed combo keywords.
+///
+/// Looking up the combos matching an input is done by walking the input backwards from its last character, so the
+/// cost of a query depends on the length of the longest keyword, not on the number of combos.
+//**********************************************************************************************************************
+class ComboKeywordSuffixTrie
+{
+public: // member functions
+   ComboKeywordSuffixTrie() = default; ///< Default constructor
+   ComboKeywordSuffixTrie(ComboKeywordSuffixTrie const&) = delete; ///< Disabled copy constructor
+   ComboKeywordSuffixTrie(ComboKeywordSuffixTrie&&) = delete; ///< Disabled move constructor
+   ~ComboKeywordSuffixTrie() = default; ///< Default destructor
+   ComboKeywordSuffixTrie& operator=(ComboKeywordSuffixTrie const&) = delete; ///< Disabled assignment operator
+   ComboKeywordSuffixTrie& operator=(ComboKeywordSuffixTrie&&) = delete; ///< Disabled move assignment operator
+   void build(ComboList const& comboList); ///< Build the trie from the keywords of a combo list
+   void clear(); ///< Clear the trie
+   bool isBuilt() const; ///< Check whether the trie has been built
+   quint64 revision() const; ///< Return the revision of the combo list the trie was built from
+   VecSpCombo matches(QString const& input) const; ///< Return the usable combos matching an input
+   VecSpCombo combosWithKeyword(QString const& keyword) const; ///< Return the combos with a given keyword
+
+private: // data members
+   ComboKeywordTrie trie_; ///< The trie of reversed keywords
+   quint64 revision_ { 0 }; ///< The revision of the combo list the trie was built from
+   bool built_ { false }; ///< Has the trie been built
+};
+
+
+#endif // #ifndef BEEFTEXT_COMBO_KEYWORD_SUFFIX_TRIE_H
@@ -0,0 +1,137 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the keyword trie shared by the keyword automaton and the keyword suffix trie
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "ComboKeywordTrie.h"
+#include "ComboList.h"
+
+
+namespace {
+
+
+//**********************************************************************************************************************
+/// \param[in] node The parent node.
+/// \param[in] c The character.
+/// \return The key for the edge in the edge table.
+//**********************************************************************************************************************
+quint64 edgeKey(qint32 node, QChar c)
+{
+   return (static_cast<quint64>(node) << 16) | c.unicode();
+}
+
+
+} // anonymous namespace
+
+
+//**********************************************************************************************************************
+/// All combos with a non-empty keyword are included, whether they are usable or not: usability depends on the groups
+/// and can change without the combo list being modified, so it is checked by users of the trie.
+///
+/// \param[in] comboList The combo list.
+/// \param[in] direction The direction the keywords are inserted in.
+//**********************************************************************************************************************
+void ComboKeywordTrie::build(ComboList const& comboList, EDirection direction)
+{
+   this->clear();
+   nodes_.emplace_back(); // the root
+   std::vector<std::pair<qint32, SpCombo>> terminals; // the node each keyword ends at, with its combo.
+   bool const backward = (EDirection::Backward == direction);
+   for (SpCombo const& combo: comboList)
+   {
+      if ((!combo) || combo->keyword().isEmpty())
+         continue;
+      QString const keyword = combo->keyword();
+      qint32 const size = keyword.size();
+      qint32 node = 0;
+      for (qint32 i = 0; i < size; ++i)
+      {
+         QChar const c = keyword[backward ? size - 1 - i : i];
+         qint32 next = this->child(node, c);
+         if (next < 0)
+         {
+            next = static_cast<qint32>(nodes_.size());
+            Node newNode;
+            newNode.parent = node;
+            newNode.character = c;
+            newNode.depth = nodes_[static_cast<quint32>(node)].depth + 1;
+            nodes_.push_back(newNode);
+            children_.insert(edgeKey(node, c), next);
+         }
+         node = next;
+      }
+      terminals.emplace_back(node, combo);
+   }
+
+   // group the combos by terminal node, preserving the list order for combos ending at the same node
+   std::stable_sort(terminals.begin(), terminals.end(),
+      [](std::pair<qint32, SpCombo> const& lhs, std::pair<qint32, SpCombo> const& rhs) -> bool
+   { return lhs.first < rhs.first; });
+   combos_.reserve(terminals.size());
+   for (std::pair<qint32, SpCombo> const& terminal: terminals)
+   {
+      Node& node = nodes_[static_cast<quint32>(terminal.first)];
+      if (0 == node.comboCount)
+         node.firstCombo = static_cast<qint32>(combos_.size());
+      ++node.comboCount;
+      combos_.push_back(terminal.second);
+   }
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void ComboKeywordTrie::clear()
+{
+   nodes_.clear();
+   children_.clear();
+   combos_.clear();
+}
+
+
+//**********************************************************************************************************************
+/// \return The number of nodes in the trie, including the root.
+//**********************************************************************************************************************
+qint32 ComboKeywordTrie::nodeCount() const
+{
+   return static_cast<qint32>(nodes_.size());
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] index The index of the node.
+/// \return The node.
+//**********************************************************************************************************************
+ComboKeywordTrie::Node const& ComboKeywordTrie::node(qint32 index) const
+{
+   return nodes_[static_cast<quint32>(index)];
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] node The parent node.
+/// \param[in] c The character.
+/// \return The child node.
+/// \return -1 if there is no such child.
+//**********************************************************************************************************************
+qint32 ComboKeywordTrie::child(qint32 node, QChar c) const
+{
+   return children_.value(edgeKey(node, c), -1);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] index The index of the combo, in the range [node.firstCombo, node.firstCombo + node.comboCount) of the
+/// node its keyword ends at.
+/// \return The combo.
+//**********************************************************************************************************************
+SpCombo const& ComboKeywordTrie::combo(qint32 index) const
+{
+   return combos_[static_cast<quint32>(index)];
+}
@@ -0,0 +1,65 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of the keyword trie shared by the keyword automaton and the keyword suffix trie
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_COMBO_KEYWORD_TRIE_H
+#define BEEFTEXT_COMBO_KEYWORD_TRIE_H
+
+
+#include "Combo.h"
+
+
+class ComboList;
+
+
+//**********************************************************************************************************************
+/// \brief A trie of combo keywords, with the combos grouped by the node their keyword ends at.
+///
+/// Keywords can be inserted in reading order or reversed. Node 0 is the root. Nodes are created in insertion order, so
+/// the parent of a node always has a lower index than the node itself.
+//**********************************************************************************************************************
+class ComboKeywordTrie
+{
+public: // data types
+   enum class EDirection
+   {
+      Forward, ///< Keywords are inserted in reading order
+      Backward, ///< Keywords are inserted reversed
+   }; ///< Enumeration for the direction keywords are inserted in
+
+   struct Node
+   {
+      qint32 parent { -1 }; ///< The parent node, or -1 for the root
+      QChar character; ///< The character on the edge leading to this node
+      qint32 depth { 0 }; ///< The length of the string leading to this node
+      qint32 firstCombo { 0 }; ///< The index of the first combo whose keyword ends at this node
+      qint32 comboCount { 0 }; ///< The number of combos whose keyword ends at this node
+   }; ///< Node of the trie
+
+public: // member functions
+   ComboKeywordTrie() = default; ///< Default constructor
+   ComboKeywordTrie(ComboKeywordTrie const&) = delete; ///< Disabled copy constructor
+   ComboKeywordTrie(ComboKeywordTrie&&) = delete; ///< Disabled move constructor
+   ~ComboKeywordTrie() = default; ///< Default destructor
+   ComboKeywordTrie& operator=(ComboKeywordTrie const&) = delete; ///< Disabled assignment operator
+   ComboKeywordTrie& operator=(ComboKeywordTrie&&) = delete; ///< Disabled move assignment operator
+   void build(ComboList const& comboList, EDirection direction); ///< Build the trie from the keywords of a combo list
+   void clear(); ///< Clear the trie
+   qint32 nodeCount() const; ///< Return the number of nodes in the trie
+   Node const& node(qint32 index) const; ///< Return a node of the trie
+   qint32 child(qint32 node, QChar c) const; ///< Return the child of a node for a character, or -1
+   SpCombo const& combo(qint32 index) const; ///< Return a combo of the trie
+
+private: // data members
+   std::vector<Node> nodes_; ///< The nodes of the trie
+   QHash<quint64, qint32> children_; ///< The edges of the trie, keyed by parent node and character
+   VecSpCombo combos_; ///< The combos, grouped by the node their keyword ends at
+};
+
+
+#endif // #ifndef BEEFTEXT_COMBO_KEYWORD_TRIE_H
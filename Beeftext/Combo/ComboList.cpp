@@ -9,6 +9,7 @@
 
 #include "stdafx.h"
 #include "ComboList.h"
+#include "ComboListStreamReader.h"
 #include "MimeDataUtils.h"
 #include "BeeftextGlobals.h"
 #include <XMiLib/File/CsvIO.h>
@@ -23,12 +24,165 @@ namespace {
 QString const kKeyFileFormatVersion = "fileFormatVersion"; ///< The JSon key for the file format version
 QString const kKeyCombos = "combos"; ///< The JSon key for combos
 QString const kKeyGroups = "groups"; ///< The JSon key for groups
+qint32 const kMinComboCountForParallelParsing = 1000; ///< Below this number of combos, parsing is done serially
+qint32 const kStreamingBatchSize = 8192; ///< The number of combos parsed at once when streaming a combo list file
+QByteArray const kCborSignature("\xd9\xd9\xf7", 3); ///< The self-describe CBOR tag that starts binary combo list files
+qint64 const kCborKeyFileFormatVersion = 0; ///< The CBOR key for the file format version
+qint64 const kCborKeyGroupCount = 1; ///< The CBOR key for the number of groups
+qint64 const kCborKeyComboCount = 2; ///< The CBOR key for the number of combos
+qint64 const kCborKeyGroups = 3; ///< The CBOR key for groups
+qint64 const kCborKeyCombos = 4; ///< The CBOR key for combos
+
+
+//**********************************************************************************************************************
+/// \brief The result of the parsing of a range of combos in a JSON array
+//**********************************************************************************************************************
+struct ComboParsingResult
+{
+   VecSpCombo combos; ///< The parsed combos
+   QString errorMsg; ///< The error message. Empty if the parsing was successful
+};
+
+
+//**********************************************************************************************************************
+/// \note This function is called from worker threads. It only performs read access on the array and group list.
+///
+/// \param[in] array The JSON array of combos
+/// \param[in] first The index of the first combo to parse
+/// \param[in] last The index following the last combo to parse
+/// \param[in] version The combo list file format version number
+/// \param[in] groups The group list
+/// \return The result of the parsing. Parsing stops on the first error.
+//**********************************************************************************************************************
+ComboParsingResult parseComboRange(QJsonArray const& array, qint32 first, qint32 last, qint32 version,
+   GroupList const& groups)
+{
+   ComboParsingResult result;
+   result.combos.reserve(static_cast<quint32>(last - first));
+   for (qint32 i = first; i < last; ++i)
+   {
+      QJsonValue const comboValue = array.at(i);
+      if (!comboValue.isObject())
+      {
+         result.errorMsg = "The combo list array contains an invalid combo.";
+         break;
+      }
+      SpCombo const combo = Combo::create(comboValue.toObject(), version, groups);
+      if ((!combo) || (!combo->isValid()))
+      {
+         result.errorMsg = "One of the combo in the list is invalid";
+         break;
+      }
+      result.combos.push_back(combo);
+   }
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// Large arrays are partitioned in chunks that are parsed by the global thread pool. The chunks are then merged in
+/// file order.
+///
+/// \param[in] array The JSON array of combos
+/// \param[in] version The combo list file format version number
+/// \param[in] groups The group list
+/// \return The parsed combos, in file order
+//**********************************************************************************************************************
+VecSpCombo parseComboArray(QJsonArray const& array, qint32 version, GroupList const& groups)
+{
+   qint32 const count = array.size();
+   qint32 const chunkCount = (count < kMinComboCountForParallelParsing) ? 1 : qMax(1, QThread::idealThreadCount());
+   if (chunkCount <= 1)
+   {
+      ComboParsingResult result = parseComboRange(array, 0, count, version, groups);
+      if (!result.errorMsg.isEmpty())
+         throw Exception(result.errorMsg);
+      return std::move(result.combos);
+   }
+
+   qint32 const chunkSize = (count + chunkCount - 1) / chunkCount;
+   QVector<QFuture<ComboParsingResult>> futures;
+   for (qint32 first = 0; first < count; first += chunkSize)
+   {
+      qint32 const last = qMin(first + chunkSize, count);
+      futures.push_back(QtConcurrent::run([&array, first, last, version, &groups]() -> ComboParsingResult
+         { return parseComboRange(array, first, last, version, groups); }));
+   }
+   VecSpCombo result;
+   result.reserve(static_cast<quint32>(count));
+   QString errorMsg;
+   for (QFuture<ComboParsingResult>& future: futures) // we wait for all workers, as they reference the array
+   {
+      ComboParsingResult const chunk = future.result();
+      if (!errorMsg.isEmpty())
+         continue;
+      if (!chunk.errorMsg.isEmpty())
+         errorMsg = chunk.errorMsg; // we report the first error in file order
+      else
+         result.insert(result.end(), chunk.combos.begin(), chunk.combos.end());
+   }
+   if (!errorMsg.isEmpty())
+      throw Exception(errorMsg);
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \note Combo lists are only created and modified in the main thread, so the registry is not protected by a mutex.
+///
+/// \return The registry of all existing combo lists, notified when the keyword or UUID of a combo changes
+//**********************************************************************************************************************
+QSet<ComboList*>& comboListRegistry()
+{
+   static QSet<ComboList*> registry;
+   return registry;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] rows The sorted list of rows
+/// \param[in] row The row to insert
+//**********************************************************************************************************************
+void insertRow(QVector<qint32>& rows, qint32 row)
+{
+   rows.insert(std::lower_bound(rows.begin(), rows.end(), row), row);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] index The index
+/// \param[in] key The key of the entry to remove the row from
+/// \param[in] row The row to remove
+//**********************************************************************************************************************
+template <typename Key> void removeRow(QHash<Key, QVector<qint32>>& index, Key const& key, qint32 row)
+{
+   typename QHash<Key, QVector<qint32>>::iterator const it = index.find(key);
+   if (it == index.end())
+      return;
+   it->removeOne(row);
+   if (it->isEmpty())
+      index.erase(it);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] index The index
+/// \param[in] row The row that was erased from the list. Rows that follow it are shifted up by one
+//**********************************************************************************************************************
+template <typename Key> void shiftRowsAfterErase(QHash<Key, QVector<qint32>>& index, qint32 row)
+{
+   for (QVector<qint32>& rows: index)
+      for (qint32& r: rows)
+         if (r > row)
+            --r;
+}
 
 
 } // anonymous namespace
 
 
 QString const ComboList::defaultFileName = "comboList.json";
+QString const ComboList::defaultBinaryFileName = "comboList.cbor";
 qint32 const ComboList::fileFormatVersionNumber = 8;
 
 
@@ -58,6 +212,39 @@ bool comboFileContainsRichTextCombos(QString const& path)
 }
 
 
+//**********************************************************************************************************************
+/// \param[in] folderPath The path of the combo list folder
+/// \param[in] binary Is the file in the binary file format
+/// \return The path of the combo list file in the folder
+//**********************************************************************************************************************
+QString ComboList::filePathInFolder(QString const& folderPath, bool binary)
+{
+   return QDir(folderPath).absoluteFilePath(binary ? defaultBinaryFileName : defaultFileName);
+}
+
+
+//**********************************************************************************************************************
+/// Only one of the JSON and binary combo list files should exist in a folder, as the file in the other format is
+/// removed when the combo list is saved. If both exist, for instance because the application was interrupted during a
+/// save, the most recently modified one is selected.
+///
+/// \param[in] folderPath The path of the combo list folder
+/// \return The path of the existing combo list file in the folder
+/// \return The path of the JSON combo list file in the folder if there is no combo list file
+//**********************************************************************************************************************
+QString ComboList::existingFilePathInFolder(QString const& folderPath)
+{
+   QFileInfo const jsonInfo(filePathInFolder(folderPath, false));
+   QFileInfo const binaryInfo(filePathInFolder(folderPath, true));
+   if (!binaryInfo.exists())
+      return jsonInfo.absoluteFilePath();
+   if (!jsonInfo.exists())
+      return binaryInfo.absoluteFilePath();
+   return (binaryInfo.lastModified() > jsonInfo.lastModified()) ? binaryInfo.absoluteFilePath() :
+      jsonInfo.absoluteFilePath();
+}
+
+
 //**********************************************************************************************************************
 /// \param[in] first The first combo
 /// \param[in] second The second combo
@@ -66,6 +253,11 @@ void swap(ComboList& first, ComboList& second) noexcept
 {
    first.combos_.swap(second.combos_);
    swap(first.groups_, second.groups_);
+   first.keywordIndex_.swap(second.keywordIndex_);
+   first.uuidIndex_.swap(second.uuidIndex_);
+   std::swap(first.indexesBuilt_, second.indexesBuilt_);
+   ++first.revision_;
+   ++second.revision_;
 }
 
 
@@ -75,6 +267,7 @@ void swap(ComboList& first, ComboList& second) noexcept
 ComboList::ComboList(QObject* parent)
    : QAbstractTableModel(parent)
 {
+   comboListRegistry().insert(this);
 }
 
 
@@ -84,8 +277,12 @@ ComboList::ComboList(QObject* parent)
 ComboList::ComboList(ComboList const& ref)
    : QAbstractTableModel(ref.parent()),
      combos_(ref.combos_),
-     groups_(ref.groups_)
+     groups_(ref.groups_),
+     keywordIndex_(ref.keywordIndex_),
+     uuidIndex_(ref.uuidIndex_),
+     indexesBuilt_(ref.indexesBuilt_)
 {
+   comboListRegistry().insert(this);
 }
 
 
@@ -95,8 +292,22 @@ ComboList::ComboList(ComboList const& ref)
 ComboList::ComboList(ComboList&& ref) noexcept
    : QAbstractTableModel(ref.parent()),
      combos_(std::move(ref.combos_)),
-     groups_(std::move(ref.groups_))
+     groups_(std::move(ref.groups_)),
+     keywordIndex_(std::move(ref.keywordIndex_)),
+     uuidIndex_(std::move(ref.uuidIndex_)),
+     indexesBuilt_(ref.indexesBuilt_)
 {
+   ref.invalidateIndexes();
+   comboListRegistry().insert(this);
+}
+
+
+//**********************************************************************************************************************
+// 
+//**********************************************************************************************************************
+ComboList::~ComboList()
+{
+   comboListRegistry().remove(this);
 }
 
 
@@ -109,6 +320,10 @@ ComboList& ComboList::operator=(ComboList const& ref)
    {
       combos_ = ref.combos_;
       groups_ = ref.groups_;
+      keywordIndex_ = ref.keywordIndex_;
+      uuidIndex_ = ref.uuidIndex_;
+      indexesBuilt_ = ref.indexesBuilt_;
+      ++revision_;
    }
    return *this;
 }
@@ -123,6 +338,11 @@ ComboList& ComboList::operator=(ComboList&& ref) noexcept
    {
       combos_ = std::move(ref.combos_);
       groups_ = std::move(ref.groups_);
+      keywordIndex_ = std::move(ref.keywordIndex_);
+      uuidIndex_ = std::move(ref.uuidIndex_);
+      indexesBuilt_ = ref.indexesBuilt_;
+      ref.invalidateIndexes();
+      ++revision_;
    }
    return *this;
 }
@@ -172,6 +392,9 @@ void ComboList::clear()
    this->beginResetModel();
    combos_.clear();
    groups_.clear();
+   keywordIndex_.clear();
+   uuidIndex_.clear();
+   ++revision_;
    this->endResetModel();
 }
 
@@ -219,6 +442,8 @@ bool ComboList::append(SpCombo const& combo)
    }
    this->beginInsertRows(QModelIndex(), static_cast<qint32>(combos_.size()), static_cast<qint32>(combos_.size()));
    combos_.push_back(combo);
+   ++revision_;
+   this->addToIndexes(static_cast<qint32>(combos_.size()) - 1);
    this->endInsertRows();
    return true;
 }
@@ -234,21 +459,91 @@ void ComboList::push_back(SpCombo const& combo)
 {
    this->beginInsertRows(QModelIndex(), static_cast<qint32>(combos_.size()), static_cast<qint32>(combos_.size()));
    combos_.push_back(combo);
+   ++revision_;
+   this->addToIndexes(static_cast<qint32>(combos_.size()) - 1);
    this->endInsertRows();
 }
 
 
+//**********************************************************************************************************************
+/// Combos are checked as with ComboList::append(), but the UUID index is used to detect duplicates and the views are
+/// notified with a single model reset, so the cost is linear in the number of combos.
+///
+/// \param[in] combos The combos to append
+/// \return The number of combos that were actually appended
+//**********************************************************************************************************************
+qint32 ComboList::bulkAppend(VecSpCombo const& combos)
+{
+   this->ensureIndexesAreBuilt();
+   this->beginResetModel();
+   combos_.reserve(combos_.size() + combos.size());
+   uuidIndex_.reserve(static_cast<qint32>(combos_.size() + combos.size()));
+   qint32 result = 0;
+   for (SpCombo const& combo: combos)
+   {
+      if ((!combo) || uuidIndex_.contains(combo->uuid()))
+      {
+         globals::debugLog().addError("Cannot add combo (duplicate or keyword conflict).");
+         continue;
+      }
+      combos_.push_back(combo);
+      this->addToIndexes(static_cast<qint32>(combos_.size()) - 1);
+      ++result;
+   }
+   ++revision_;
+   this->endResetModel();
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \note Unlike ComboList::bulkAppend(), this function does not perform any check on the combos.
+///
+/// \param[in] combos The new combos
+//**********************************************************************************************************************
+void ComboList::resetCombos(VecSpCombo const& combos)
+{
+   this->beginResetModel();
+   combos_ = combos;
+   this->invalidateIndexes();
+   ++revision_;
+   this->endResetModel();
+}
+
+
 //**********************************************************************************************************************
 // 
 //**********************************************************************************************************************
 void ComboList::erase(qint32 index)
 {
    this->beginRemoveRows(QModelIndex(), index, index);
+   if (indexesBuilt_)
+   {
+      this->removeFromIndexes(index);
+      shiftRowsAfterErase(keywordIndex_, index);
+      shiftRowsAfterErase(uuidIndex_, index);
+   }
    combos_.erase(combos_.begin() + index);
+   ++revision_;
    this->endRemoveRows();
 }
 
 
+//**********************************************************************************************************************
+/// \param[in] index The index of the combo to replace
+/// \param[in] combo The new combo
+//**********************************************************************************************************************
+void ComboList::replace(qint32 index, SpCombo const& combo)
+{
+   Q_ASSERT((index >= 0) && (index < qint32(combos_.size())));
+   this->removeFromIndexes(index);
+   combos_[static_cast<quint32>(index)] = combo;
+   this->addToIndexes(index);
+   ++revision_;
+   emit dataChanged(this->index(index, 0), this->index(index, this->columnCount(QModelIndex()) - 1));
+}
+
+
 //**********************************************************************************************************************
 /// \param[in] group The group
 //**********************************************************************************************************************
@@ -276,54 +571,47 @@ void ComboList::eraseCombosOfGroup(SpGroup const& group)
 //**********************************************************************************************************************
 ComboList::const_iterator ComboList::findByKeyword(QString const& keyword) const
 {
-   return std::find_if(this->begin(), this->end(),
-      [&](SpCombo const& combo) -> bool { return combo->keyword() == keyword; });
-}
-
-
-//**********************************************************************************************************************
-/// \param[in] keyword The keyword
-/// \return An iterator to to the combo with the specified keyword
-/// \return A null shared pointer if the combo list contains no combo with the specified keyword
-//**********************************************************************************************************************
-ComboList::iterator ComboList::findByKeyword(QString const& keyword)
-{
-   return std::find_if(this->begin(), this->end(),
-      [&](SpCombo const& combo) -> bool { return combo->keyword() == keyword; });
+   qint32 const row = this->rowOfKeyword(keyword);
+   return row < 0 ? this->end() : this->begin() + row;
 }
 
 
 //**********************************************************************************************************************
 /// \param[in] uuid The UUID
-/// \return An iterator to to the combo with the specified UUID
+/// \return A constant iterator to to the combo with the specified UUID
 /// \return A null shared pointer if the combo list contains no combo with the specified UUID
 //**********************************************************************************************************************
-ComboList::iterator ComboList::findByUuid(QUuid const& uuid)
+ComboList::const_iterator ComboList::findByUuid(QUuid const& uuid) const
 {
-   return std::find_if(this->begin(), this->end(),
-      [&](SpCombo const& combo) -> bool { return combo->uuid() == uuid; });
+   qint32 const row = this->rowOfUuid(uuid);
+   return row < 0 ? this->end() : this->begin() + row;
 }
 
 
 //**********************************************************************************************************************
-/// \param[in] uuid The UUID
-/// \return A constant iterator to to the combo with the specified UUID
-/// \return A null shared pointer if the combo list contains no combo with the specified UUID
+/// \param[in] keyword The keyword
+/// \return All the combos with the specified keyword, in list order, whether they are usable or not
 //**********************************************************************************************************************
-ComboList::const_iterator ComboList::findByUuid(QUuid const& uuid) const
+VecSpCombo ComboList::findAllByKeyword(QString const& keyword) const
 {
-   return std::find_if(this->begin(), this->end(),
-      [&](SpCombo const& combo) -> bool { return combo->uuid() == uuid; });
+   this->ensureIndexesAreBuilt();
+   VecSpCombo result;
+   for (qint32 const row: keywordIndex_.value(keyword))
+      result.push_back(combos_[static_cast<quint32>(row)]);
+   return result;
 }
 
 
 //**********************************************************************************************************************
-/// \param[in] index The index of the combo to retrieve
-/// \return A reference to the combo at the given index
+/// The order of combos sharing a keyword is not a priority: when several combos share the longest matching keyword,
+/// the combo manager picks one of them randomly.
+///
+/// \param[in] input The input, typically the text typed since the last combo breaker
+/// \return The usable combos matching the input, sorted by decreasing keyword length, then in list order
 //**********************************************************************************************************************
-SpCombo& ComboList::operator[](qint32 index)
+VecSpCombo ComboList::findMatches(QString const& input) const
 {
-   return combos_[static_cast<quint32>(index)];
+   return this->suffixTrie().matches(input);
 }
 
 
@@ -337,15 +625,6 @@ SpCombo const& ComboList::operator[](qint32 index) const
 }
 
 
-//**********************************************************************************************************************
-/// \return An iterator to the beginning of the combo list
-//**********************************************************************************************************************
-ComboList::iterator ComboList::begin()
-{
-   return combos_.begin();
-}
-
-
 //**********************************************************************************************************************
 /// \return A constant iterator to the beginning of the combo list
 //**********************************************************************************************************************
@@ -356,76 +635,115 @@ ComboList::const_iterator ComboList::begin() const
 
 
 //**********************************************************************************************************************
-/// \return An iterator to the end of the combo list
+/// \return A constant iterator to the end of the combo list
 //**********************************************************************************************************************
-ComboList::iterator ComboList::end()
+ComboList::const_iterator ComboList::end() const
 {
    return combos_.end();
 }
 
 
 //**********************************************************************************************************************
-/// \return A constant iterator to the end of the combo list
+/// \return A constant reverse iterator to the beginning of the list
 //**********************************************************************************************************************
-ComboList::const_iterator ComboList::end() const
+ComboList::const_reverse_iterator ComboList::rbegin() const
 {
-   return combos_.end();
+   return combos_.rbegin();
 }
 
 
 //**********************************************************************************************************************
-/// \return A reverse iterator to the beginning of the list
+/// \return A constant reverse iterator to the end of the list
 //**********************************************************************************************************************
-ComboList::reverse_iterator ComboList::rbegin()
+ComboList::const_reverse_iterator ComboList::rend() const
 {
-   return combos_.rbegin();
+   return combos_.rend();
 }
 
 
 //**********************************************************************************************************************
-/// \return A constant reverse iterator to the beginning of the list
+/// \param[in] includeGroups Should the groups be saved 
+/// Return a JSon document containing the combo list
 //**********************************************************************************************************************
-ComboList::const_reverse_iterator ComboList::rbegin() const
+QJsonDocument ComboList::toJsonDocument(bool includeGroups) const
 {
-   return combos_.rbegin();
+   return this->record().toJsonDocument(includeGroups);
 }
 
 
 //**********************************************************************************************************************
-/// \return A reverse iterator to the end of the list
+/// \return A CBOR value containing the combo list and its groups
 //**********************************************************************************************************************
-ComboList::reverse_iterator ComboList::rend()
+QCborValue ComboList::toCborValue() const
 {
-   return combos_.rend();
+   return this->record().toCborValue();
 }
 
 
 //**********************************************************************************************************************
-/// \return A constant reverse iterator to the end of the list
+/// Taking a record only copies implicitly shared values, so it is much cheaper than serializing the list.
+///
+/// \return A value copy of the saved content of the list
 //**********************************************************************************************************************
-ComboList::const_reverse_iterator ComboList::rend() const
+ComboListRecord ComboList::record() const
 {
-   return combos_.rend();
+   ComboListRecord result;
+   result.combos.reserve(combos_.size());
+   for (SpCombo const& combo: combos_)
+      result.combos.push_back(combo->record());
+   result.groups.reserve(static_cast<quint32>(groups_.size()));
+   for (SpGroup const& group: groups_)
+      result.groups.push_back(Group::create(group->uuid(), group->name(), group->description(), group->enabled(),
+         group->creationDateTime(), group->modificationDateTime()));
+   return result;
 }
 
 
 //**********************************************************************************************************************
-/// \param[in] includeGroups Should the groups be saved 
-/// Return a JSon document containing the combo list
+/// \param[in] includeGroups Should the groups be included in the document
+/// \return A JSON document containing the combos, and optionally their groups
 //**********************************************************************************************************************
-QJsonDocument ComboList::toJsonDocument(bool includeGroups) const
+QJsonDocument ComboListRecord::toJsonDocument(bool includeGroups) const
 {
    QJsonObject rootObject;
-   rootObject.insert(kKeyFileFormatVersion, fileFormatVersionNumber);
+   rootObject.insert(kKeyFileFormatVersion, ComboList::fileFormatVersionNumber);
    QJsonArray comboArray;
-   for (SpCombo const& combo: combos_)
-      comboArray.append(combo->toJsonObject(includeGroups));
+   for (ComboRecord const& combo: combos)
+      comboArray.append(combo.toJsonObject(includeGroups));
    rootObject.insert(kKeyCombos, comboArray);
-   rootObject.insert(kKeyGroups, includeGroups ? groups_.toJsonArray() : QJsonArray());
+   QJsonArray groupArray;
+   if (includeGroups)
+      for (SpGroup const& group: groups)
+         groupArray.append(group->toJsonObject());
+   rootObject.insert(kKeyGroups, groupArray);
    return QJsonDocument(rootObject);
 }
 
 
+//**********************************************************************************************************************
+/// The value is a map tagged with the CBOR self-describe tag. The version and the item counts are stored before the
+/// groups and the combos, so that a reader can allocate memory before parsing the lists.
+///
+/// \return A CBOR value containing the combos and their groups
+//**********************************************************************************************************************
+QCborValue ComboListRecord::toCborValue() const
+{
+   QCborMap rootMap;
+   rootMap.insert(kCborKeyFileFormatVersion, ComboList::fileFormatVersionNumber);
+   rootMap.insert(kCborKeyGroupCount, static_cast<qint64>(groups.size()));
+   rootMap.insert(kCborKeyComboCount, static_cast<qint64>(combos.size()));
+   QCborArray groupArray;
+   for (SpGroup const& group: groups)
+      groupArray.append(group->toCborMap());
+   rootMap.insert(kCborKeyGroups, groupArray);
+   QCborArray comboArray;
+   for (ComboRecord const& combo: combos)
+      comboArray.append(combo.toCborMap(true));
+   rootMap.insert(kCborKeyCombos, comboArray);
+   return QCborValue(QCborKnownTags::Signature, rootMap);
+}
+
+
 //**********************************************************************************************************************
 /// If this function returns false, the content of the instance the class is undetermined on exit
 ///
@@ -446,39 +764,13 @@ bool ComboList::readFromJsonDocument(QJsonDocument const& doc, bool* outInOlderF
       if (!doc.isObject())
          throw Exception("The combo list file is invalid.");
       QJsonObject const rootObject = doc.object();
-
-      // check the file format version number
-      QJsonValue const versionValue = rootObject[kKeyFileFormatVersion];
-      if (!versionValue.isDouble()) // the JSon format consider all numbers as double
-         throw Exception("The combo list file does not specify its version number.");
-      qint32 const version = versionValue.toInt();
-      if (version > fileFormatVersionNumber)
-         throw Exception("The combo list file was created by a newer version of the application.");
-
-      // parse the groups
-      if (version >= 3)
-      {
-         QJsonValue const groupListValue = rootObject[kKeyGroups];
-         if (!groupListValue.isArray())
-            throw Exception("The list of groups is not a valid array");
-         QString errorMsg;
-         if (!groups_.readFromJsonArray(groupListValue.toArray(), version, &errorMsg))
-            throw Exception(errorMsg);
-      }
+      qint32 const version = this->readVersionAndGroups(rootObject);
 
       // parse the combos
       QJsonValue const combosListValue = rootObject[kKeyCombos];
       if (!combosListValue.isArray())
          throw Exception("The list of combos is not a valid array");
-      for (QJsonValueRef const comboValue: combosListValue.toArray())
-      {
-         if (!comboValue.isObject())
-            throw Exception("The combo list array contains an invalid combo.");
-         SpCombo const combo = Combo::create(comboValue.toObject(), version, groups_);
-         if ((!combo) || (!combo->isValid()))
-            throw Exception("One of the combo in the list is invalid");
-         this->append(combo);
-      }
+      this->bulkAppend(parseComboArray(combosListValue.toArray(), version, groups_)); // duplicates are discarded
       if (outInOlderFileFormat)
          *outInOlderFileFormat = (version < fileFormatVersionNumber);
       return true;
@@ -493,6 +785,9 @@ bool ComboList::readFromJsonDocument(QJsonDocument const& doc, bool* outInOlderF
 
 
 //**********************************************************************************************************************
+/// The file is read with a streaming reader, so the raw file content and its full DOM are never held in memory. The
+/// combos are parsed in batches as they are read.
+///
 /// \param[in] path The path of the file to read from
 /// \param[out] outInOlderFileFormat If the function return true and this parameter is not null, this variable is
 /// true on exit if the loaded file is in a file format that is not the latest one
@@ -508,7 +803,41 @@ bool ComboList::load(QString const& path, bool* outInOlderFileFormat, QString* o
       QFile file(path);
       if ((!file.exists()) || (!file.open(QIODevice::ReadOnly)))
          throw Exception(QString("Could not open file for reading: '%1'").arg(QDir::toNativeSeparators(path)));
-      return this->readFromJsonDocument(QJsonDocument::fromJson(file.readAll()), outInOlderFileFormat, outErrorMessage);
+      try
+      {
+         qint32 version = 0;
+         if (file.peek(kCborSignature.size()) == kCborSignature)
+            version = this->readFromCborDevice(file);
+         else
+         {
+            ComboListStreamReader reader(file, kKeyCombos);
+            version = this->readVersionAndGroups(reader.readHeader());
+            VecSpCombo combos;
+            QJsonArray batch;
+            auto const parseBatch = [&]()
+            {
+               VecSpCombo const parsed = parseComboArray(batch, version, groups_);
+               combos.insert(combos.end(), parsed.begin(), parsed.end());
+               batch = QJsonArray();
+            };
+            reader.readCombos([&](QJsonValue const& value)
+            {
+               batch.append(value);
+               if (batch.size() >= kStreamingBatchSize)
+                  parseBatch();
+            });
+            parseBatch();
+            this->bulkAppend(combos); // duplicates are discarded
+         }
+         if (outInOlderFileFormat)
+            *outInOlderFileFormat = (version < fileFormatVersionNumber);
+         return true;
+      }
+      catch (Exception const& e)
+      {
+         this->clear();
+         throw Exception(QString("An error occurred while parsing the combo list file: %1").arg(e.qwhat()));
+      }
    }
    catch (Exception const& e)
    {
@@ -519,6 +848,122 @@ bool ComboList::load(QString const& path, bool* outInOlderFileFormat, QString* o
 }
 
 
+//**********************************************************************************************************************
+/// \note This function throws an xmilib::Exception on error.
+///
+/// \param[in] rootObject The root object of the combo list file. The combo array is not accessed.
+/// \return The file format version number
+//**********************************************************************************************************************
+qint32 ComboList::readVersionAndGroups(QJsonObject const& rootObject)
+{
+   // check the file format version number
+   QJsonValue const versionValue = rootObject[kKeyFileFormatVersion];
+   if (!versionValue.isDouble()) // the JSon format consider all numbers as double
+      throw Exception("The combo list file does not specify its version number.");
+   qint32 const version = versionValue.toInt();
+   if (version > fileFormatVersionNumber)
+      throw Exception("The combo list file was created by a newer version of the application.");
+
+   // parse the groups
+   if (version >= 3)
+   {
+      QJsonValue const groupListValue = rootObject[kKeyGroups];
+      if (!groupListValue.isArray())
+         throw Exception("The list of groups is not a valid array");
+      QString errorMsg;
+      if (!groups_.readFromJsonArray(groupListValue.toArray(), version, &errorMsg))
+         throw Exception(errorMsg);
+   }
+   return version;
+}
+
+
+//**********************************************************************************************************************
+/// The root map is read with a streaming reader, and each group and combo is decoded individually, so the file content
+/// is never held in memory. Unknown keys are skipped.
+///
+/// \note This function throws an xmilib::Exception on error.
+///
+/// \param[in] device The device, positioned at the beginning of the CBOR combo list file
+/// \return The file format version number
+//**********************************************************************************************************************
+qint32 ComboList::readFromCborDevice(QIODevice& device)
+{
+   QCborStreamReader reader(&device);
+   auto const checkError = [&reader]()
+   {
+      if (QCborError::NoError != reader.lastError())
+         throw Exception(QString("Invalid binary combo list file: %1").arg(reader.lastError().toString()));
+   };
+   if ((!reader.isTag()) || (QCborKnownTags::Signature != reader.toTag()) || (!reader.next()) || (!reader.isMap())
+      || (!reader.enterContainer()))
+      throw Exception("Invalid binary combo list file.");
+   qint32 version = -1;
+   qint64 comboCount = 0;
+   VecSpCombo combos;
+   while (reader.hasNext())
+   {
+      if (!reader.isInteger())
+         throw Exception("Invalid binary combo list file.");
+      qint64 const key = reader.toInteger();
+      reader.next();
+      checkError();
+      if (kCborKeyFileFormatVersion == key)
+      {
+         if (!reader.isInteger())
+            throw Exception("The combo list file does not specify its version number.");
+         version = static_cast<qint32>(reader.toInteger());
+         reader.next();
+         if (version > fileFormatVersionNumber)
+            throw Exception("The combo list file was created by a newer version of the application.");
+      }
+      else if (kCborKeyComboCount == key)
+      {
+         comboCount = reader.isInteger() ? reader.toInteger() : 0;
+         reader.next();
+      }
+      else if (kCborKeyGroups == key)
+      {
+         QCborValue const groupsValue = QCborValue::fromCbor(reader);
+         checkError();
+         if (!groupsValue.isArray())
+            throw Exception("The list of groups is not a valid array");
+         QString errorMsg;
+         if (!groups_.readFromCborArray(groupsValue.toArray(), &errorMsg))
+            throw Exception(errorMsg);
+      }
+      else if (kCborKeyCombos == key)
+      {
+         if (!reader.isArray() || (!reader.enterContainer()))
+            throw Exception("The list of combos is not a valid array");
+         // the count is bounded by the file size, so that a corrupt file cannot trigger a huge allocation
+         combos.reserve(static_cast<quint32>(qBound<qint64>(0, comboCount, device.size())));
+         while (reader.hasNext())
+         {
+            QCborValue const comboValue = QCborValue::fromCbor(reader);
+            checkError();
+            if (!comboValue.isMap())
+               throw Exception("The combo list array contains an invalid combo.");
+            SpCombo const combo = Combo::create(comboValue.toMap(), groups_);
+            if ((!combo) || (!combo->isValid()))
+               throw Exception("One of the combo in the list is invalid");
+            combos.push_back(combo);
+         }
+         reader.leaveContainer();
+      }
+      else
+         reader.next(); // skip the whole value
+      checkError();
+   }
+   reader.leaveContainer();
+   checkError();
+   if (version < 0)
+      throw Exception("The combo list file does not specify its version number.");
+   this->bulkAppend(combos); // duplicates are discarded
+   return version;
+}
+
+
 //**********************************************************************************************************************
 /// \param[in] path The path of the file to save to
 /// \param[in] saveGroups Should the groups be saved
@@ -547,6 +992,33 @@ bool ComboList::save(QString const& path, bool saveGroups, QString* outErrorMess
 }
 
 
+//**********************************************************************************************************************
+/// \param[in] path The path of the file to save to
+/// \param[out] outErrorMessage If the function return false and this parameter is not null, the string pointed to 
+/// contains a description of the error
+/// \return true if and only if the combo list was successfully saved to file
+//**********************************************************************************************************************
+bool ComboList::saveToCborFile(QString const& path, QString* outErrorMessage) const
+{
+   try
+   {
+      QFile file(path);
+      if (!file.open(QIODevice::WriteOnly))
+         throw Exception(QString("Could not open file for writing: '%1'").arg(QDir::toNativeSeparators(path)));
+      QByteArray const data = this->toCborValue().toCbor();
+      if (data.size() != file.write(data))
+         throw Exception(QString("Error writing to file: %1").arg(QDir::toNativeSeparators(path)));
+      return true;
+   }
+   catch (Exception const& e)
+   {
+      if (outErrorMessage)
+         *outErrorMessage = e.qwhat();
+      return false;
+   }
+}
+
+
 //**********************************************************************************************************************
 /// \param[in] path The path of the file to save to
 /// \param[out] outErrorMessage If the function return false and this parameter is not null, the string pointed to 
@@ -638,6 +1110,206 @@ void ComboList::ensureCorrectGrouping(bool* outWasInvalid)
 }
 
 
+//**********************************************************************************************************************
+/// \note combos are shared and can be edited in place, so the revision also accounts for the global lookup revision
+/// of combos (see Combo::lookupRevision()). Both counters only increase, so their sum changes whenever either does.
+///
+/// \return The revision number of the list
+//**********************************************************************************************************************
+quint64 ComboList::revision() const
+{
+   return revision_ + Combo::lookupRevision();
+}
+
+
+//**********************************************************************************************************************
+/// \return The suffix trie of the keywords in the list
+//**********************************************************************************************************************
+ComboKeywordSuffixTrie const& ComboList::suffixTrie() const
+{
+   if ((!suffixTrie_.isBuilt()) || (suffixTrie_.revision() != this->revision()))
+      suffixTrie_.build(*this);
+   return suffixTrie_;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] combo The combo
+/// \param[in] previousKeyword The keyword of the combo before the change
+//**********************************************************************************************************************
+void ComboList::onComboKeywordChanged(Combo const& combo, QString const& previousKeyword)
+{
+   for (ComboList* list: comboListRegistry())
+   {
+      if (!list->indexesBuilt_)
+         continue;
+      QVector<qint32> const rows = list->keywordIndex_.value(previousKeyword);
+      for (qint32 const row: rows)
+      {
+         if (list->combos_[static_cast<quint32>(row)].get() != &combo)
+            continue;
+         removeRow(list->keywordIndex_, previousKeyword, row);
+         insertRow(list->keywordIndex_[combo.keyword()], row);
+      }
+   }
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] combo The combo
+/// \param[in] previousUuid The UUID of the combo before the change
+//**********************************************************************************************************************
+void ComboList::onComboUuidChanged(Combo const& combo, QUuid const& previousUuid)
+{
+   for (ComboList* list: comboListRegistry())
+   {
+      if (!list->indexesBuilt_)
+         continue;
+      for (qint32 const row: list->rowsOfCombo(combo))
+      {
+         removeRow(list->uuidIndex_, previousUuid, row);
+         insertRow(list->uuidIndex_[combo.uuid()], row);
+      }
+   }
+}
+
+
+//**********************************************************************************************************************
+/// Once built, the indexes are kept up to date by every function that modifies the list, and by the combos themselves
+/// when their keyword or UUID changes (see onComboKeywordChanged() and onComboUuidChanged()).
+//**********************************************************************************************************************
+void ComboList::ensureIndexesAreBuilt() const
+{
+   if (indexesBuilt_)
+      return;
+   keywordIndex_.clear();
+   uuidIndex_.clear();
+   keywordIndex_.reserve(this->size());
+   uuidIndex_.reserve(this->size());
+   indexesBuilt_ = true;
+   for (qint32 row = 0; row < this->size(); ++row)
+      this->addToIndexes(row);
+}
+
+
+//**********************************************************************************************************************
+// 
+//**********************************************************************************************************************
+void ComboList::invalidateIndexes()
+{
+   keywordIndex_.clear();
+   uuidIndex_.clear();
+   indexesBuilt_ = false;
+}
+
+
+//**********************************************************************************************************************
+/// \note This function does nothing if the indexes have not been built.
+///
+/// \param[in] row The row of the combo
+//**********************************************************************************************************************
+void ComboList::addToIndexes(qint32 row) const
+{
+   SpCombo const& combo = combos_[static_cast<quint32>(row)];
+   if ((!indexesBuilt_) || (!combo))
+      return;
+   insertRow(keywordIndex_[combo->keyword()], row);
+   insertRow(uuidIndex_[combo->uuid()], row);
+}
+
+
+//**********************************************************************************************************************
+/// \note This function does nothing if the indexes have not been built.
+///
+/// \param[in] row The row of the combo
+//**********************************************************************************************************************
+void ComboList::removeFromIndexes(qint32 row) const
+{
+   SpCombo const& combo = combos_[static_cast<quint32>(row)];
+   if ((!indexesBuilt_) || (!combo))
+      return;
+   removeRow(keywordIndex_, combo->keyword(), row);
+   removeRow(uuidIndex_, combo->uuid(), row);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] combo The combo
+/// \return The rows holding the combo, found using the keyword index, which must be built
+//**********************************************************************************************************************
+QVector<qint32> ComboList::rowsOfCombo(Combo const& combo) const
+{
+   QVector<qint32> result;
+   for (qint32 const row: keywordIndex_.value(combo.keyword()))
+      if (combos_[static_cast<quint32>(row)].get() == &combo)
+         result.push_back(row);
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] keyword The keyword
+/// \return The row of the first combo with the given keyword
+/// \return -1 if no combo in the list has this keyword
+//**********************************************************************************************************************
+qint32 ComboList::rowOfKeyword(QString const& keyword) const
+{
+   this->ensureIndexesAreBuilt();
+   QHash<QString, QVector<qint32>>::const_iterator const it = keywordIndex_.constFind(keyword);
+   return (it == keywordIndex_.constEnd()) ? -1 : it->front();
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] uuid The UUID
+/// \return The row of the first combo with the given UUID
+/// \return -1 if no combo in the list has this UUID
+//**********************************************************************************************************************
+qint32 ComboList::rowOfUuid(QUuid const& uuid) const
+{
+   this->ensureIndexesAreBuilt();
+   QHash<QUuid, QVector<qint32>>::const_iterator const it = uuidIndex_.constFind(uuid);
+   qint32 const row = (it == uuidIndex_.constEnd()) ? -1 : it->front();
+   Q_ASSERT((row < 0) || (combos_[static_cast<quint32>(row)]->uuid() == uuid));
+   return row;
+}
+
+
+#ifndef NDEBUG
+//**********************************************************************************************************************
+/// The check compares the current indexes to indexes computed from the content of the list, so it is slow and only
+/// meant for debugging purposes. The indexes are not built or modified by the check. If they have not been built yet,
+/// there is nothing to check and the function returns true.
+///
+/// \param[out] outErrorMsg If not null and the function returns false, receive a description of the inconsistency
+/// \return true if and only if the keyword and UUID indexes are consistent with the content of the list
+//**********************************************************************************************************************
+bool ComboList::checkIndexConsistency(QString* outErrorMsg) const
+{
+   if (!indexesBuilt_)
+      return true;
+   QHash<QString, QVector<qint32>> expectedKeywordIndex;
+   QHash<QUuid, QVector<qint32>> expectedUuidIndex;
+   for (qint32 row = 0; row < this->size(); ++row)
+   {
+      SpCombo const& combo = combos_[static_cast<quint32>(row)];
+      if (!combo)
+         continue;
+      expectedKeywordIndex[combo->keyword()].push_back(row);
+      expectedUuidIndex[combo->uuid()].push_back(row);
+   }
+   QString errorMsg;
+   if (expectedKeywordIndex != keywordIndex_)
+      errorMsg = "The keyword index is invalid.";
+   else if (expectedUuidIndex != uuidIndex_)
+      errorMsg = "The UUID index is invalid.";
+   if (outErrorMsg)
+      *outErrorMsg = errorMsg;
+   return errorMsg.isEmpty();
+}
+#endif // #ifndef NDEBUG
+
+
 //**********************************************************************************************************************
 /// \return The number of rows in the table model
 //**********************************************************************************************************************
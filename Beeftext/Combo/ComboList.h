@@ -12,23 +12,41 @@
 
 
 #include "Combo.h"
+#include "ComboKeywordSuffixTrie.h"
 #include "Group/GroupList.h"
 
 
 bool comboFileContainsRichTextCombos(QString const& path); ///< Check if a file contains rich text combos
 
 
+//**********************************************************************************************************************
+/// \brief A value copy of the saved content of a combo list.
+///
+/// A record does not share any mutable data with the combo list it was taken from, so it can be serialized in a worker
+/// thread while the list is being edited.
+//**********************************************************************************************************************
+struct ComboListRecord
+{
+   std::vector<ComboRecord> combos; ///< The combos
+   VecSpGroup groups; ///< Copies of the groups
+
+   QJsonDocument toJsonDocument(bool includeGroups) const; ///< Export the record to a JSON document
+   QCborValue toCborValue() const; ///< Export the record to a CBOR value
+};
+
+
 //**********************************************************************************************************************
 /// \brief A class for combo lists
+///
+/// The list maintains keyword and UUID indexes, so it only provides constant iterators and accessors. The combos are
+/// added, replaced and removed through member functions that keep the indexes up to date.
 //**********************************************************************************************************************
 class ComboList: public QAbstractTableModel
 {
    Q_OBJECT
 public: // type definitions
    // ReSharper disable CppInconsistentNaming
-   typedef VecSpCombo::iterator iterator; ///< Type definition for iterator
    typedef VecSpCombo::const_iterator const_iterator; ///< Type definition for const_iterator
-   typedef VecSpCombo::reverse_iterator reverse_iterator; ///< Type definition for iterator
    typedef VecSpCombo::const_reverse_iterator const_reverse_iterator; ///< Type definition for const_iterator
    typedef SpCombo value_type;
    // ReSharper restore CppInconsistentNaming
@@ -45,16 +63,22 @@ public: // type definitions
 
 public: // static data members
    static QString const defaultFileName; ///< The default name for combo list files
+   static QString const defaultBinaryFileName; ///< The default name for binary combo list files
    static qint32 const fileFormatVersionNumber; ///< The version number for the combo list file format
 
+public: // static member functions
+   static QString filePathInFolder(QString const& folderPath, bool binary); ///< Return the path of the combo list file in a folder
+   static QString existingFilePathInFolder(QString const& folderPath); ///< Return the path of the existing combo list file in a folder
+
 public: // friends
    friend void swap(ComboList& first, ComboList& second) noexcept; ///< Swap two combo lists
+   friend class Combo;
 
 public: // member functions
    explicit ComboList(QObject* parent = nullptr); ///< Default constructor
    ComboList(ComboList const& ref); ///< Copy constructor
    ComboList(ComboList&& ref) noexcept; ///< Move constructor
-   ~ComboList() override = default; ///< Default destructor
+   ~ComboList() override; ///< Destructor
    ComboList& operator=(ComboList const& ref); ///< Assignment operator
    ComboList& operator=(ComboList&& ref) noexcept; ///< Move assignment operator
    GroupList& groupListRef(); ///< Return a mutable reference to the group list
@@ -68,32 +92,37 @@ public: // member functions
    bool append(SpCombo const& combo); ///< Append a combo at the end of the list
    // ReSharper disable once CppInconsistentNaming
    void push_back(SpCombo const& combo); ///< Append a combo at the end of the list
+   qint32 bulkAppend(VecSpCombo const& combos); ///< Append several combos at the end of the list at once
+   void resetCombos(VecSpCombo const& combos); ///< Replace all the combos in the list, keeping the groups
    void erase(qint32 index); ///< Erase a combo from the list
+   void replace(qint32 index, SpCombo const& combo); ///< Replace the combo at a given index
    void eraseCombosOfGroup(SpGroup const& group); ///< Erase all the combos of a given group
    const_iterator findByKeyword(QString const& keyword) const; ///< Find a combo by its keyword
-   iterator findByKeyword(QString const& keyword); ///< Find a combo by its keyword
    const_iterator findByUuid(QUuid const& uuid) const; ///< Find a combo by its UUID
-   iterator findByUuid(QUuid const& uuid); ///< Find a combo by its UUID
-   SpCombo& operator[](qint32 index); ///< Get a mutable reference to the combo at a given position in the list
-   SpCombo const& operator[](qint32 index) const; ///< Get a mutable reference to the combo at a given position in the list
-   iterator begin(); ///< Returns an iterator to the beginning of the list
+   VecSpCombo findAllByKeyword(QString const& keyword) const; ///< Find all the combos with a given keyword
+   VecSpCombo findMatches(QString const& input) const; ///< Find the usable combos matching an input
+   SpCombo const& operator[](qint32 index) const; ///< Get a constant reference to the combo at a given position in the list
    const_iterator begin() const; ///< Returns a constant iterator to the beginning of the list
-   iterator end(); ///< Returns an iterator to the end of the list
    const_iterator end() const; ///< Returns a constant iterator to the end of the list
-   reverse_iterator rbegin(); ///< Returns a reverse iterator to the beginning of the list
    const_reverse_iterator rbegin() const; ///< Returns a constant reverse iterator to the beginning of the list
-   reverse_iterator rend(); ///< Returns a reverse iterator to the end of the list
    const_reverse_iterator rend() const; ///< Returns a constant reverse iterator to the end of the list
+   ComboListRecord record() const; ///< Return a value copy of the saved content of the list
    QJsonDocument toJsonDocument(bool includeGroups) const; ///< Export the Combo list to a JSon document
+   QCborValue toCborValue() const; ///< Export the combo list and its groups to a CBOR value
    bool readFromJsonDocument(QJsonDocument const& doc, bool* outInOlderFileFormat = nullptr, 
       QString* outErrorMsg = nullptr); ///< Read a combo list from a JSON document
    bool save(QString const& path, bool saveGroups, QString* outErrorMessage = nullptr) const; ///< Save a combo list to a JSON file
+   bool saveToCborFile(QString const& path, QString* outErrorMessage = nullptr) const; ///< Save a combo list and its groups to a binary CBOR file
    bool exportToCsvFile(QString const& path, QString* outErrorMessage = nullptr) const; ///< Export a combo list to CSV file
    bool exportCheatSheet(QString const& path, QString* outErrorMessage = nullptr) const; ///< Export the combo list as a cheat sheet in CSV format
    bool load(QString const& path, bool* outInOlderFileFormat = nullptr, QString* outErrorMessage = nullptr); /// Load a combo list from a JSON file
    void markComboAsEdited(qint32 index); ///< Mark a combo as edited
    void ensureCorrectGrouping(bool *outWasInvalid = nullptr); ///< make sure every combo is affected to a group (and that there is at least one group
-   
+#ifndef NDEBUG
+   bool checkIndexConsistency(QString* outErrorMsg = nullptr) const; ///< Check that the lookup indexes match the list content
+#endif // #ifndef NDEBUG
+   quint64 revision() const; ///< Get a number that changes every time the list or the lookup properties of its combos change
+
    /// \name Table model member functions
    ///\{
    int rowCount(QModelIndex const&) const override; ///< Retrieve the number of row in the table model
@@ -107,9 +136,30 @@ public: // member functions
    //bool dropMimeData(const QMimeData *data, Qt::DropAction action, int row, int column, const QModelIndex &parent); ///< process the dropping of MIME data
                                                                                                                     ///\}
 
+private: // static member functions
+   static void onComboKeywordChanged(Combo const& combo, QString const& previousKeyword); ///< Update the indexes of all lists after a keyword change
+   static void onComboUuidChanged(Combo const& combo, QUuid const& previousUuid); ///< Update the indexes of all lists after a UUID change
+
+private: // member functions
+   qint32 readVersionAndGroups(QJsonObject const& rootObject); ///< Check the file format version and read the groups
+   qint32 readFromCborDevice(QIODevice& device); ///< Read a combo list from a device containing a CBOR combo list file
+   ComboKeywordSuffixTrie const& suffixTrie() const; ///< Return the keyword suffix trie, rebuilding it if needed
+   void ensureIndexesAreBuilt() const; ///< Build the keyword and UUID indexes if they have not been built yet
+   void invalidateIndexes(); ///< Discard the keyword and UUID indexes
+   void addToIndexes(qint32 row) const; ///< Add the combo at a given row to the keyword and UUID indexes
+   void removeFromIndexes(qint32 row) const; ///< Remove the combo at a given row from the keyword and UUID indexes
+   QVector<qint32> rowsOfCombo(Combo const& combo) const; ///< Return the rows holding a given combo
+   qint32 rowOfKeyword(QString const& keyword) const; ///< Return the row of the first combo with a given keyword, or -1
+   qint32 rowOfUuid(QUuid const& uuid) const; ///< Return the row of the first combo with a given UUID, or -1
+
 private: // data members
    VecSpCombo combos_; ///< The list of combos
    GroupList groups_; ///< The list of groups
+   quint64 revision_ { 0 }; ///< The structural revision number of the list
+   mutable ComboKeywordSuffixTrie suffixTrie_; ///< The keyword suffix trie, built lazily
+   mutable QHash<QString, QVector<qint32>> keywordIndex_; ///< The sorted rows of the combos sharing each keyword, built lazily
+   mutable QHash<QUuid, QVector<qint32>> uuidIndex_; ///< The sorted rows of the combos sharing each UUID, built lazily
+   mutable bool indexesBuilt_ { false }; ///< Have the indexes been built
 };
 
 
@@ -0,0 +1,244 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of benchmark functions for combo lists
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "ComboListBenchmark.h"
+#include "ComboList.h"
+#include <Psapi.h>
+#include <functional>
+#include <atomic>
+
+
+namespace {
+
+
+qint32 const kIterationCount = 5; ///< The number of iterations for each benchmark
+QList<qint32> const kFileFormatComboCounts = { 1000, 10000, 100000 }; ///< The list sizes for the file format benchmark
+
+
+typedef std::function<bool(ComboList&, QString*)> ComboListLoader; ///< Type definition for combo list loading functions
+typedef std::function<bool(QString*)> BenchmarkedOperation; ///< Type definition for benchmarked operations
+
+
+//**********************************************************************************************************************
+/// \brief The result of a loading benchmark
+//**********************************************************************************************************************
+struct LoadingBenchmarkResult
+{
+   bool success { false }; ///< Did all the iterations succeed
+   QString errorMsg; ///< The error message if the benchmark failed
+   qint32 comboCount { 0 }; ///< The number of combos loaded
+   double averageMs { 0.0 }; ///< The average wall time of a load, in milliseconds
+   qint64 peakIncrease { 0 }; ///< The largest increase of the working set during a load, in bytes
+};
+
+
+//**********************************************************************************************************************
+/// \return The current working set size of the process, in bytes
+//**********************************************************************************************************************
+qint64 currentWorkingSetSize()
+{
+   PROCESS_MEMORY_COUNTERS counters;
+   ZeroMemory(&counters, sizeof(counters));
+   GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+   return static_cast<qint64>(counters.WorkingSetSize);
+}
+
+
+//**********************************************************************************************************************
+/// \brief Sample the working set of the process until a flag is raised.
+///
+/// The peak working set reported by the system covers the whole lifetime of the process and cannot be reset, so we
+/// poll the current working set instead. The sampler yields between samples rather than sleeping, as the resolution of
+/// sleep on Windows is too coarse to catch short-lived allocations.
+///
+/// \param[in] stopFlag The flag that stops the sampling
+/// \return The largest working set size observed, in bytes
+//**********************************************************************************************************************
+qint64 sampleWorkingSetPeak(std::atomic<bool> const* stopFlag)
+{
+   qint64 result = currentWorkingSetSize();
+   while (!*stopFlag)
+   {
+      result = qMax(result, currentWorkingSetSize());
+      QThread::yieldCurrentThread();
+   }
+   return qMax(result, currentWorkingSetSize());
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] loader The loading function
+/// \return The result of the benchmark
+//**********************************************************************************************************************
+LoadingBenchmarkResult runLoadingBenchmark(ComboListLoader const& loader)
+{
+   LoadingBenchmarkResult result;
+   qint64 totalNs = 0;
+   for (qint32 i = 0; i < kIterationCount; ++i)
+   {
+      ComboList comboList;
+      SetProcessWorkingSetSize(GetCurrentProcess(), static_cast<SIZE_T>(-1), static_cast<SIZE_T>(-1)); // trim
+      qint64 const baseline = currentWorkingSetSize();
+      std::atomic<bool> loadFinished { false };
+      QFuture<qint64> const sampler = QtConcurrent::run(sampleWorkingSetPeak, &loadFinished);
+      QElapsedTimer timer;
+      timer.start();
+      bool const success = loader(comboList, &result.errorMsg);
+      totalNs += timer.nsecsElapsed();
+      loadFinished = true;
+      qint64 const peak = sampler.result();
+      if (!success)
+         return result;
+      result.comboCount = comboList.size();
+      result.peakIncrease = qMax(result.peakIncrease, peak - baseline);
+   }
+   result.averageMs = static_cast<double>(totalNs) / (1000000.0 * kIterationCount);
+   result.success = true;
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] name The name of the benchmark
+/// \param[in] result The result of the benchmark
+/// \return A human readable report for the benchmark
+//**********************************************************************************************************************
+QString loadingBenchmarkReport(QString const& name, LoadingBenchmarkResult const& result)
+{
+   if (!result.success)
+      return QString("%1: failed (%2)").arg(name).arg(result.errorMsg);
+   return QString("%1: %2 combos, %3 ms per load, peak working set +%4 MB").arg(name).arg(result.comboCount)
+      .arg(result.averageMs, 0, 'f', 2).arg(static_cast<double>(result.peakIncrease) / (1024.0 * 1024.0), 0, 'f', 1);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] comboCount The number of combos
+/// \return A combo list containing generated combos in a single group
+//**********************************************************************************************************************
+ComboList syntheticComboList(qint32 comboCount)
+{
+   ComboList result;
+   result.ensureCorrectGrouping();
+   SpGroup const group = result.groupListRef()[0];
+   VecSpCombo combos;
+   combos.reserve(static_cast<quint32>(comboCount));
+   for (qint32 i = 0; i < comboCount; ++i)
+   {
+      SpCombo const combo = Combo::create(QString("Combo %1").arg(i), QString("::kw%1").arg(i),
+         QString("This is the snippet for combo number %1, with #{clipboard} and #{date}.").arg(i));
+      combo->setGroup(group);
+      combos.push_back(combo);
+   }
+   result.bulkAppend(combos);
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] operation The operation
+/// \param[out] outErrorMsg If the function returns a negative value and this parameter is not null, receive a
+/// description of the error
+/// \return The average wall time of the operation in milliseconds, or a negative value if the operation failed
+//**********************************************************************************************************************
+double averageMs(BenchmarkedOperation const& operation, QString* outErrorMsg)
+{
+   qint64 totalNs = 0;
+   for (qint32 i = 0; i < kIterationCount; ++i)
+   {
+      QElapsedTimer timer;
+      timer.start();
+      if (!operation(outErrorMsg))
+         return -1.0;
+      totalNs += timer.nsecsElapsed();
+   }
+   return static_cast<double>(totalNs) / (1000000.0 * kIterationCount);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] comboList The combo list
+/// \param[in] path The path of the file used for the benchmark
+/// \param[in] binary Should the binary file format be used
+/// \return A human readable report for the benchmark
+//**********************************************************************************************************************
+QString fileFormatBenchmarkReport(ComboList const& comboList, QString const& path, bool binary)
+{
+   QString const name = binary ? "CBOR" : "JSON";
+   QString errorMsg;
+   double const saveMs = averageMs([&](QString* outErrorMsg) -> bool
+   {
+      return binary ? comboList.saveToCborFile(path, outErrorMsg) : comboList.save(path, true, outErrorMsg);
+   }, &errorMsg);
+   if (saveMs < 0.0)
+      return QString("   %1: save failed (%2)").arg(name).arg(errorMsg);
+   qint64 const fileSize = QFileInfo(path).size();
+   double const loadMs = averageMs([&](QString* outErrorMsg) -> bool
+   {
+      ComboList loaded;
+      return loaded.load(path, nullptr, outErrorMsg) && (loaded.size() == comboList.size());
+   }, &errorMsg);
+   if (loadMs < 0.0)
+      return QString("   %1: load failed (%2)").arg(name).arg(errorMsg);
+   return QString("   %1: save %2 ms, load %3 ms, %4 KB").arg(name).arg(saveMs, 0, 'f', 2).arg(loadMs, 0, 'f', 2)
+      .arg(static_cast<double>(fileSize) / 1024.0, 0, 'f', 1);
+}
+
+
+} // anonymous namespace
+
+
+//**********************************************************************************************************************
+/// The working set is sampled during each load, relative to its size right before the load, so the memory reported for
+/// each reader does not depend on the order the readers are benchmarked in.
+///
+/// \param[in] path The path of the combo list file
+/// \return A human readable report of the benchmark
+//**********************************************************************************************************************
+QString benchmarkComboListLoading(QString const& path)
+{
+   LoadingBenchmarkResult const streaming = runLoadingBenchmark([&](ComboList& comboList, QString* outErrorMsg)
+      -> bool { return comboList.load(path, nullptr, outErrorMsg); });
+   LoadingBenchmarkResult const dom = runLoadingBenchmark([&](ComboList& comboList, QString* outErrorMsg) -> bool
+   {
+      QFile file(path);
+      if (!file.open(QIODevice::ReadOnly))
+      {
+         if (outErrorMsg)
+            *outErrorMsg = QString("Could not open file for reading: '%1'").arg(QDir::toNativeSeparators(path));
+         return false;
+      }
+      return comboList.readFromJsonDocument(QJsonDocument::fromJson(file.readAll()), nullptr, outErrorMsg);
+   });
+   return QString("Combo list loading benchmark (%1 iterations)\n\n%2\n%3").arg(kIterationCount)
+      .arg(loadingBenchmarkReport("Streaming reader", streaming)).arg(loadingBenchmarkReport("DOM", dom));
+}
+
+
+//**********************************************************************************************************************
+/// Generated combo lists of increasing sizes are saved and loaded in a temporary folder, using both file formats.
+///
+/// \return A human readable report of the benchmark
+//**********************************************************************************************************************
+QString benchmarkComboListFileFormats()
+{
+   QTemporaryDir const dir;
+   if (!dir.isValid())
+      return "Could not create a temporary folder for the benchmark.";
+   QStringList lines = { QString("Combo list file format benchmark (%1 iterations)").arg(kIterationCount) };
+   for (qint32 const comboCount: kFileFormatComboCounts)
+   {
+      ComboList const comboList = syntheticComboList(comboCount);
+      lines.append(QString("\n%1 combos").arg(comboCount));
+      lines.append(fileFormatBenchmarkReport(comboList, dir.filePath(ComboList::defaultFileName), false));
+      lines.append(fileFormatBenchmarkReport(comboList, dir.filePath(ComboList::defaultBinaryFileName), true));
+   }
+   return lines.join("\n");
+}
@@ -0,0 +1,18 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of benchmark functions for combo lists
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_COMBO_LIST_BENCHMARK_H
+#define BEEFTEXT_COMBO_LIST_BENCHMARK_H
+
+
+QString benchmarkComboListLoading(QString const& path); ///< Compare the streaming and DOM based loading of a combo list file
+QString benchmarkComboListFileFormats(); ///< Compare the JSON and binary combo list file formats
+
+
+#endif // #ifndef BEEFTEXT_COMBO_LIST_BENCHMARK_H
@@ -0,0 +1,355 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the change journal for combo list files
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "ComboListJournal.h"
+#include "ComboList.h"
+#include "BeeftextGlobals.h"
+#include <XMiLib/Exception.h>
+
+
+using namespace xmilib;
+
+
+namespace {
+
+
+QString const kJournalFileSuffix = "journal"; ///< The suffix of journal files
+QString const kCompactingJournalFileSuffix = "compacting.journal"; ///< The suffix of journal files being compacted
+QString const kKeyFileFormatVersion = "fileFormatVersion"; ///< The JSON key for the file format version in records
+QString const kKeyUpserts = "upserts"; ///< The JSON key for the upserted combos in records, keyed by UUID
+QString const kKeyDeletes = "deletes"; ///< The JSON key for the UUIDs of the deleted combos in records
+
+
+//**********************************************************************************************************************
+/// \param[in] comboListPath The path of the combo list file
+/// \param[in] suffix The suffix of the journal file
+/// \return The path of the journal file
+//**********************************************************************************************************************
+QString journalPathWithSuffix(QString const& comboListPath, QString const& suffix)
+{
+   QFileInfo const info(comboListPath);
+   return info.dir().absoluteFilePath(QString("%1.%2").arg(info.completeBaseName()).arg(suffix));
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] object The JSON object of the combo
+/// \param[in] groups The group list
+/// \return The combo
+//**********************************************************************************************************************
+SpCombo createComboFromRecord(QJsonObject const& object, GroupList const& groups)
+{
+   SpCombo const combo = Combo::create(object, ComboList::fileFormatVersionNumber, groups);
+   if ((!combo) || (!combo->isValid()))
+      throw Exception("The combo list journal contains an invalid combo.");
+   return combo;
+}
+
+
+} // anonymous namespace
+
+
+//**********************************************************************************************************************
+/// \param[in] comboListPath The path of the combo list file
+/// \return The path of the journal file
+//**********************************************************************************************************************
+QString ComboListJournal::journalFilePath(QString const& comboListPath)
+{
+   return journalPathWithSuffix(comboListPath, kJournalFileSuffix);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] comboListPath The path of the combo list file
+/// \return The path of the journal file being compacted
+//**********************************************************************************************************************
+QString ComboListJournal::compactingJournalFilePath(QString const& comboListPath)
+{
+   return journalPathWithSuffix(comboListPath, kCompactingJournalFileSuffix);
+}
+
+
+//**********************************************************************************************************************
+/// The journal being compacted, if any, is replayed first. Records are merged by UUID before being applied, so the
+/// list is only rebuilt once, whatever the number of records. An incomplete last record, that can result from a crash
+/// while writing, is ignored.
+///
+/// \param[in] comboListPath The path of the combo list file
+/// \param[in,out] comboList The combo list, loaded from the combo list file
+/// \param[out] outErrorMsg If the function returns false and this parameter is not null, receive a description of
+/// the error
+/// \return true if and only if the journals were replayed successfully
+//**********************************************************************************************************************
+bool ComboListJournal::replay(QString const& comboListPath, ComboList& comboList, QString* outErrorMsg)
+{
+   try
+   {
+      QHash<QUuid, QJsonObject> upserts; // the last upserted state of each combo
+      QSet<QUuid> deletes;
+      QVector<QUuid> upsertOrder; // the UUIDs of upserted combos, in the order they were first upserted
+      qint32 recordCount = 0;
+      for (QString const& path: { compactingJournalFilePath(comboListPath), journalFilePath(comboListPath) })
+      {
+         QFile file(path);
+         if (!file.exists())
+            continue;
+         if (!file.open(QIODevice::ReadOnly))
+            throw Exception(QString("Could not open journal file '%1'.").arg(QDir::toNativeSeparators(path)));
+         qint32 lineNumber = 0;
+         while (!file.atEnd())
+         {
+            QByteArray const line = file.readLine().trimmed();
+            ++lineNumber;
+            if (line.isEmpty())
+               continue;
+            QJsonParseError error {};
+            QJsonDocument const doc = QJsonDocument::fromJson(line, &error);
+            if ((QJsonParseError::NoError != error.error) || (!doc.isObject()))
+            {
+               if (!file.atEnd())
+                  throw Exception(QString("The journal file '%1' is corrupted at line %2.")
+                     .arg(QDir::toNativeSeparators(path)).arg(lineNumber));
+               globals::debugLog().addWarning(QString("The last record of the journal file '%1' is incomplete and "
+                  "was ignored.").arg(QDir::toNativeSeparators(path)));
+               break;
+            }
+            QJsonObject const record = doc.object();
+            if (record[kKeyFileFormatVersion].toInt() > ComboList::fileFormatVersionNumber)
+               throw Exception("The combo list journal was created by a newer version of the application.");
+            QJsonObject const upsertObject = record[kKeyUpserts].toObject();
+            for (QJsonObject::const_iterator it = upsertObject.begin(); it != upsertObject.end(); ++it)
+            {
+               QUuid const uuid(it.key());
+               deletes.remove(uuid);
+               if (!upserts.contains(uuid))
+                  upsertOrder.push_back(uuid);
+               upserts.insert(uuid, it.value().toObject());
+            }
+            for (QJsonValue const& value: record[kKeyDeletes].toArray())
+            {
+               QUuid const uuid(value.toString());
+               upserts.remove(uuid);
+               deletes.insert(uuid);
+            }
+            ++recordCount;
+         }
+      }
+      if (0 == recordCount)
+         return true;
+
+      GroupList const& groups = comboList.groupListRef();
+      VecSpCombo combos;
+      combos.reserve(static_cast<quint32>(comboList.size() + upserts.size()));
+      QSet<QUuid> handled;
+      for (SpCombo const& combo: comboList)
+      {
+         QUuid const uuid = combo->uuid();
+         if (deletes.contains(uuid))
+            continue;
+         QHash<QUuid, QJsonObject>::const_iterator const it = upserts.constFind(uuid);
+         if (it == upserts.constEnd())
+            combos.push_back(combo);
+         else
+         {
+            combos.push_back(createComboFromRecord(it.value(), groups));
+            handled.insert(uuid);
+         }
+      }
+      for (QUuid const& uuid: upsertOrder)
+      {
+         QHash<QUuid, QJsonObject>::const_iterator const it = upserts.constFind(uuid);
+         if ((it == upserts.constEnd()) || handled.contains(uuid))
+            continue;
+         combos.push_back(createComboFromRecord(it.value(), groups));
+         handled.insert(uuid);
+      }
+      comboList.resetCombos(combos);
+      globals::debugLog().addInfo(QString("Replayed %1 record(s) from the combo list journal.").arg(recordCount));
+      return true;
+   }
+   catch (Exception const& e)
+   {
+      if (outErrorMsg)
+         *outErrorMsg = e.qwhat();
+      return false;
+   }
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] comboListPath The path of the combo list file
+/// \return true if and only if no journal file exists for the combo list file on exit
+//**********************************************************************************************************************
+bool ComboListJournal::removeFiles(QString const& comboListPath)
+{
+   bool result = true;
+   for (QString const& path: { compactingJournalFilePath(comboListPath), journalFilePath(comboListPath) })
+      if (QFileInfo::exists(path) && (!QFile::remove(path)))
+      {
+         globals::debugLog().addWarning(QString("Could not remove journal file '%1'.")
+            .arg(QDir::toNativeSeparators(path)));
+         result = false;
+      }
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// This function must be called every time the combo list file has been fully written or loaded.
+///
+/// \param[in] comboList The combo list
+/// \param[in] comboListPath The path of the combo list file
+//**********************************************************************************************************************
+void ComboListJournal::reset(ComboList const& comboList, QString const& comboListPath)
+{
+   comboListPath_ = comboListPath;
+   persistedRevisions_.clear();
+   persistedRevisions_.reserve(comboList.size());
+   for (SpCombo const& combo: comboList)
+      if (combo)
+         persistedRevisions_.insert(combo->uuid(), combo->revision());
+   persistedGroups_ = comboList.groupListRef().toJsonArray();
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void ComboListJournal::invalidate()
+{
+   comboListPath_.clear();
+   persistedRevisions_.clear();
+   persistedGroups_ = QJsonArray();
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] comboList The combo list
+/// \param[in] comboListPath The path of the combo list file
+/// \return true if and only if the journal is valid for this file and the groups did not change since the list was
+/// last persisted
+//**********************************************************************************************************************
+bool ComboListJournal::canAppend(ComboList const& comboList, QString const& comboListPath) const
+{
+   return (!comboListPath_.isEmpty()) && (comboListPath == comboListPath_)
+      && (comboList.groupListRef().toJsonArray() == persistedGroups_);
+}
+
+
+//**********************************************************************************************************************
+/// Computing the record only requires comparing revision numbers, combos that did not change are not serialized.
+///
+/// \param[in] comboList The combo list
+/// \param[out] outErrorMsg If the function returns false and this parameter is not null, receive a description of
+/// the error
+/// \return true if and only if the changes were successfully appended to the journal
+//**********************************************************************************************************************
+bool ComboListJournal::append(ComboList const& comboList, QString* outErrorMsg)
+{
+   try
+   {
+      if (comboListPath_.isEmpty())
+         throw Exception("The combo list journal is not valid.");
+      QJsonObject upserts;
+      QJsonArray deletes;
+      QHash<QUuid, quint64> revisions;
+      revisions.reserve(comboList.size());
+      for (SpCombo const& combo: comboList)
+      {
+         if (!combo)
+            continue;
+         QUuid const uuid = combo->uuid();
+         quint64 const revision = combo->revision();
+         revisions.insert(uuid, revision);
+         QHash<QUuid, quint64>::const_iterator const it = persistedRevisions_.constFind(uuid);
+         if ((it == persistedRevisions_.constEnd()) || (it.value() != revision))
+            upserts.insert(uuid.toString(), combo->toJsonObject(true));
+      }
+      for (QHash<QUuid, quint64>::const_iterator it = persistedRevisions_.begin(); it != persistedRevisions_.end(); ++it)
+         if (!revisions.contains(it.key()))
+            deletes.append(it.key().toString());
+      if (upserts.isEmpty() && deletes.isEmpty())
+         return true;
+
+      QJsonObject record;
+      record.insert(kKeyFileFormatVersion, ComboList::fileFormatVersionNumber);
+      record.insert(kKeyUpserts, upserts);
+      record.insert(kKeyDeletes, deletes);
+      QString const path = journalFilePath(comboListPath_);
+      QFile file(path);
+      if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+         throw Exception(QString("Could not open journal file '%1'.").arg(QDir::toNativeSeparators(path)));
+      QByteArray const data = QJsonDocument(record).toJson(QJsonDocument::Compact) + '\n';
+      if ((data.size() != file.write(data)) || (!file.flush()))
+         throw Exception(QString("Error writing to journal file '%1'.").arg(QDir::toNativeSeparators(path)));
+      persistedRevisions_.swap(revisions);
+      return true;
+   }
+   catch (Exception const& e)
+   {
+      if (outErrorMsg)
+         *outErrorMsg = e.qwhat();
+      return false;
+   }
+}
+
+
+//**********************************************************************************************************************
+/// \return The size in bytes of the journal file
+/// \return 0 if the journal is not valid or the journal file does not exist
+//**********************************************************************************************************************
+qint64 ComboListJournal::fileSize() const
+{
+   if (comboListPath_.isEmpty())
+      return 0;
+   QFileInfo const info(journalFilePath(comboListPath_));
+   return info.exists() ? info.size() : 0;
+}
+
+
+//**********************************************************************************************************************
+/// \param[out] outErrorMsg If the function returns false and this parameter is not null, receive a description of
+/// the error
+/// \return true if and only if the journal file was renamed
+//**********************************************************************************************************************
+bool ComboListJournal::beginCompaction(QString* outErrorMsg)
+{
+   try
+   {
+      if (comboListPath_.isEmpty())
+         throw Exception("The combo list journal is not valid.");
+      QString const compactingPath = compactingJournalFilePath(comboListPath_);
+      if (QFileInfo::exists(compactingPath))
+         throw Exception("A previous compaction of the combo list journal did not complete.");
+      if (!QFile::rename(journalFilePath(comboListPath_), compactingPath))
+         throw Exception("Could not rename the combo list journal file.");
+      return true;
+   }
+   catch (Exception const& e)
+   {
+      if (outErrorMsg)
+         *outErrorMsg = e.qwhat();
+      return false;
+   }
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void ComboListJournal::endCompaction()
+{
+   if (comboListPath_.isEmpty())
+      return;
+   QString const compactingPath = compactingJournalFilePath(comboListPath_);
+   if (QFileInfo::exists(compactingPath) && (!QFile::remove(compactingPath)))
+      globals::debugLog().addWarning(QString("Could not remove journal file '%1'.")
+         .arg(QDir::toNativeSeparators(compactingPath)));
+}
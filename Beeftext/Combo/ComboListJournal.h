@@ -0,0 +1,59 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of the change journal for combo list files
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_COMBO_LIST_JOURNAL_H
+#define BEEFTEXT_COMBO_LIST_JOURNAL_H
+
+
+class ComboList;
+
+
+//**********************************************************************************************************************
+/// \brief An append-only journal of the changes made to a combo list since its file was last written.
+///
+/// The journal file sits next to the combo list file. Each line is a compact JSON record containing the combos that
+/// were added or modified (upserts), and the UUIDs of the combos that were deleted. To compute a record, the journal
+/// keeps the revision of every combo at the time the list was last persisted (see Combo::revision()).
+///
+/// Changes to groups are not journaled: they require a full save of the combo list file.
+///
+/// During compaction, the journal file is renamed, so that new records go to a fresh journal while the combo list
+/// file is rewritten. Both files are replayed when loading, in order.
+//**********************************************************************************************************************
+class ComboListJournal
+{
+public: // static member functions
+   static QString journalFilePath(QString const& comboListPath); ///< Return the path of the journal for a combo list file
+   static QString compactingJournalFilePath(QString const& comboListPath); ///< Return the path of the journal being compacted
+   static bool replay(QString const& comboListPath, ComboList& comboList, QString* outErrorMsg = nullptr); ///< Replay the journals of a combo list file
+   static bool removeFiles(QString const& comboListPath); ///< Remove the journal files of a combo list file
+
+public: // member functions
+   ComboListJournal() = default; ///< Default constructor
+   ComboListJournal(ComboListJournal const&) = delete; ///< Disabled copy constructor
+   ComboListJournal(ComboListJournal&&) = delete; ///< Disabled move constructor
+   ~ComboListJournal() = default; ///< Default destructor
+   ComboListJournal& operator=(ComboListJournal const&) = delete; ///< Disabled assignment operator
+   ComboListJournal& operator=(ComboListJournal&&) = delete; ///< Disabled move assignment operator
+   void reset(ComboList const& comboList, QString const& comboListPath); ///< Record the current state of a combo list as persisted
+   void invalidate(); ///< Invalidate the journal, forcing the next save to be a full save
+   bool canAppend(ComboList const& comboList, QString const& comboListPath) const; ///< Check whether the changes to a combo list can be journaled
+   bool append(ComboList const& comboList, QString* outErrorMsg = nullptr); ///< Append a record with the changes since the last persisted state
+   qint64 fileSize() const; ///< Return the size of the journal file
+   bool beginCompaction(QString* outErrorMsg = nullptr); ///< Rename the journal file before a compaction
+   void endCompaction(); ///< Remove the renamed journal file after a successful compaction
+
+private: // data members
+   QString comboListPath_; ///< The path of the combo list file. Empty if the journal is not valid
+   QHash<QUuid, quint64> persistedRevisions_; ///< The revision of each combo, as persisted
+   QJsonArray persistedGroups_; ///< The groups, as persisted
+};
+
+
+#endif // #ifndef BEEFTEXT_COMBO_LIST_JOURNAL_H
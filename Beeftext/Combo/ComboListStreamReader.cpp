@@ -0,0 +1,472 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the streaming reader for combo list files
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "ComboListStreamReader.h"
+#include <XMiLib/Exception.h>
+
+
+using namespace xmilib;
+
+
+namespace {
+
+
+qint64 const kBlockSize = 64 * 1024; ///< The size of the blocks read from the device
+qint32 const kMaxDepth = 256; ///< The maximum nesting depth of JSON values
+
+
+} // anonymous namespace
+
+
+//**********************************************************************************************************************
+/// \param[in] device The device to read from. It must be open for reading and support seeking.
+/// \param[in] comboArrayKey The key of the combo array in the root object
+//**********************************************************************************************************************
+ComboListStreamReader::ComboListStreamReader(QIODevice& device, QString comboArrayKey)
+   : device_(device)
+   , comboArrayKey_(std::move(comboArrayKey))
+{
+}
+
+
+//**********************************************************************************************************************
+/// \return The members of the root object, except the combo array
+//**********************************************************************************************************************
+QJsonObject ComboListStreamReader::readHeader()
+{
+   this->seek(0);
+   combosPos_ = -1;
+   if (0xef == this->peek()) // we skip the UTF-8 byte order mark, if any
+   {
+      this->get();
+      if ((0xbb != this->get()) || (0xbf != this->get()))
+         this->throwError("Invalid byte order mark.");
+   }
+   QJsonObject result;
+   this->skipWhitespaces();
+   this->expect('{');
+   this->skipWhitespaces();
+   if ('}' == this->peek())
+      this->get();
+   else
+      while (true)
+      {
+         this->skipWhitespaces();
+         this->expect('"');
+         QString const key = this->readString();
+         this->skipWhitespaces();
+         this->expect(':');
+         this->skipWhitespaces();
+         if (key == comboArrayKey_)
+         {
+            combosPos_ = this->position();
+            this->skipValue(1);
+         }
+         else
+            result.insert(key, this->readValue(1));
+         this->skipWhitespaces();
+         qint32 const c = this->get();
+         if ('}' == c)
+            break;
+         if (',' != c)
+            this->throwError("Expected ',' or '}' in the root object.");
+      }
+   this->skipWhitespaces();
+   if (this->peek() >= 0)
+      this->throwError("Unexpected data after the root object.");
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] handler The function called for each element of the combo array, in file order.
+//**********************************************************************************************************************
+void ComboListStreamReader::readCombos(ComboValueHandler const& handler)
+{
+   if (combosPos_ < 0)
+      throw Exception("The list of combos is not a valid array");
+   this->seek(combosPos_);
+   if ('[' != this->peek())
+      throw Exception("The list of combos is not a valid array");
+   this->get();
+   this->skipWhitespaces();
+   if (']' == this->peek())
+   {
+      this->get();
+      return;
+   }
+   while (true)
+   {
+      handler(this->readValue(2));
+      this->skipWhitespaces();
+      qint32 const c = this->get();
+      if (']' == c)
+         break;
+      if (',' != c)
+         this->throwError("Expected ',' or ']' in the list of combos.");
+   }
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] message The error message
+//**********************************************************************************************************************
+void ComboListStreamReader::throwError(QString const& message) const
+{
+   throw Exception(QString("%1 (offset %2)").arg(message).arg(this->position()));
+}
+
+
+//**********************************************************************************************************************
+/// \return The position of the next byte in the device
+//**********************************************************************************************************************
+qint64 ComboListStreamReader::position() const
+{
+   return bufferStart_ + bufferPos_;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] pos The position
+//**********************************************************************************************************************
+void ComboListStreamReader::seek(qint64 pos)
+{
+   if ((pos >= bufferStart_) && (pos <= bufferStart_ + buffer_.size()))
+   {
+      bufferPos_ = static_cast<qint32>(pos - bufferStart_);
+      return;
+   }
+   if (!device_.seek(pos))
+      throw Exception("Could not seek in the combo list file.");
+   buffer_.clear();
+   bufferStart_ = pos;
+   bufferPos_ = 0;
+}
+
+
+//**********************************************************************************************************************
+/// \return The next byte
+/// \return -1 at the end of the device
+//**********************************************************************************************************************
+qint32 ComboListStreamReader::peek()
+{
+   if (bufferPos_ >= buffer_.size())
+   {
+      qint64 const nextStart = bufferStart_ + buffer_.size();
+      if ((device_.pos() != nextStart) && (!device_.seek(nextStart)))
+         throw Exception("Could not seek in the combo list file.");
+      buffer_ = device_.read(kBlockSize);
+      bufferStart_ = nextStart;
+      bufferPos_ = 0;
+      if (buffer_.isEmpty())
+         return -1;
+   }
+   return static_cast<quint8>(buffer_[bufferPos_]);
+}
+
+
+//**********************************************************************************************************************
+/// \return The next byte
+/// \return -1 at the end of the device
+//**********************************************************************************************************************
+qint32 ComboListStreamReader::get()
+{
+   qint32 const result = this->peek();
+   if (result >= 0)
+      ++bufferPos_;
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] c The expected character
+//**********************************************************************************************************************
+void ComboListStreamReader::expect(char c)
+{
+   if (this->get() != c)
+      this->throwError(QString("Expected '%1'.").arg(c));
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void ComboListStreamReader::skipWhitespaces()
+{
+   while (true)
+   {
+      qint32 const c = this->peek();
+      if ((' ' != c) && ('\t' != c) && ('\n' != c) && ('\r' != c))
+         return;
+      ++bufferPos_;
+   }
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] depth The nesting depth of the value
+/// \return The value
+//**********************************************************************************************************************
+QJsonValue ComboListStreamReader::readValue(qint32 depth)
+{
+   if (depth > kMaxDepth)
+      this->throwError("The JSON data is too deeply nested.");
+   this->skipWhitespaces();
+   switch (this->peek())
+   {
+   case '{':
+   {
+      this->get();
+      QJsonObject object;
+      this->skipWhitespaces();
+      if ('}' == this->peek())
+      {
+         this->get();
+         return object;
+      }
+      while (true)
+      {
+         this->skipWhitespaces();
+         this->expect('"');
+         QString const key = this->readString();
+         this->skipWhitespaces();
+         this->expect(':');
+         object.insert(key, this->readValue(depth + 1));
+         this->skipWhitespaces();
+         qint32 const c = this->get();
+         if ('}' == c)
+            return object;
+         if (',' != c)
+            this->throwError("Expected ',' or '}' in object.");
+      }
+   }
+   case '[':
+   {
+      this->get();
+      QJsonArray array;
+      this->skipWhitespaces();
+      if (']' == this->peek())
+      {
+         this->get();
+         return array;
+      }
+      while (true)
+      {
+         array.append(this->readValue(depth + 1));
+         this->skipWhitespaces();
+         qint32 const c = this->get();
+         if (']' == c)
+            return array;
+         if (',' != c)
+            this->throwError("Expected ',' or ']' in array.");
+      }
+   }
+   case '"':
+      this->get();
+      return this->readString();
+   case 't':
+   case 'f':
+   case 'n':
+      return this->readLiteral();
+   default:
+      return this->readNumber();
+   }
+}
+
+
+//**********************************************************************************************************************
+/// The value is validated with the same rules as readValue(), but no JSON value is built.
+///
+/// \param[in] depth The nesting depth of the value
+//**********************************************************************************************************************
+void ComboListStreamReader::skipValue(qint32 depth)
+{
+   if (depth > kMaxDepth)
+      this->throwError("The JSON data is too deeply nested.");
+   this->skipWhitespaces();
+   qint32 const first = this->peek();
+   if (('{' != first) && ('[' != first))
+   {
+      if ('"' == first)
+      {
+         this->get();
+         this->skipString();
+      }
+      else
+         this->readValue(depth); // scalars are small, we simply parse them
+      return;
+   }
+   this->get();
+   char const closing = ('{' == first) ? '}' : ']';
+   this->skipWhitespaces();
+   if (closing == this->peek())
+   {
+      this->get();
+      return;
+   }
+   while (true)
+   {
+      if ('}' == closing)
+      {
+         this->skipWhitespaces();
+         this->expect('"');
+         this->skipString();
+         this->skipWhitespaces();
+         this->expect(':');
+      }
+      this->skipValue(depth + 1);
+      this->skipWhitespaces();
+      qint32 const c = this->get();
+      if (closing == c)
+         return;
+      if (',' != c)
+         this->throwError(QString("Expected ',' or '%1'.").arg(closing));
+   }
+}
+
+
+//**********************************************************************************************************************
+/// \return The string
+//**********************************************************************************************************************
+QString ComboListStreamReader::readString()
+{
+   QByteArray utf8;
+   while (true)
+   {
+      qint32 const c = this->get();
+      if (c < 0)
+         this->throwError("Unterminated string.");
+      if ('"' == c)
+         return QString::fromUtf8(utf8);
+      if (c < 0x20)
+         this->throwError("Invalid control character in string.");
+      if ('\\' != c)
+      {
+         utf8.append(static_cast<char>(c));
+         continue;
+      }
+      qint32 const escaped = this->get();
+      switch (escaped)
+      {
+      case '"': utf8.append('"'); break;
+      case '\\': utf8.append('\\'); break;
+      case '/': utf8.append('/'); break;
+      case 'b': utf8.append('\b'); break;
+      case 'f': utf8.append('\f'); break;
+      case 'n': utf8.append('\n'); break;
+      case 'r': utf8.append('\r'); break;
+      case 't': utf8.append('\t'); break;
+      case 'u':
+      {
+         QString str(QChar(this->readHexCodeUnit()));
+         if (str[0].isHighSurrogate() && ('\\' == this->peek()))
+         {
+            qint64 const pos = this->position();
+            this->get();
+            if ('u' == this->get())
+            {
+               QChar const low(this->readHexCodeUnit());
+               if (low.isLowSurrogate())
+                  str.append(low);
+               else
+                  this->seek(pos);
+            }
+            else
+               this->seek(pos);
+         }
+         utf8.append(str.toUtf8());
+         break;
+      }
+      default:
+         this->throwError("Invalid escape sequence in string.");
+      }
+   }
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void ComboListStreamReader::skipString()
+{
+   while (true)
+   {
+      qint32 const c = this->get();
+      if (c < 0)
+         this->throwError("Unterminated string.");
+      if ('"' == c)
+         return;
+      if ('\\' == c)
+         this->get(); // the escaped character cannot be a quote that closes the string
+   }
+}
+
+
+//**********************************************************************************************************************
+/// \return The code unit
+//**********************************************************************************************************************
+quint16 ComboListStreamReader::readHexCodeUnit()
+{
+   quint16 result = 0;
+   for (qint32 i = 0; i < 4; ++i)
+   {
+      qint32 const c = this->get();
+      qint32 digit = 0;
+      if ((c >= '0') && (c <= '9'))
+         digit = c - '0';
+      else if ((c >= 'a') && (c <= 'f'))
+         digit = c - 'a' + 10;
+      else if ((c >= 'A') && (c <= 'F'))
+         digit = c - 'A' + 10;
+      else
+         this->throwError("Invalid unicode escape sequence in string.");
+      result = static_cast<quint16>((result << 4) | digit);
+   }
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \return The number
+//**********************************************************************************************************************
+QJsonValue ComboListStreamReader::readNumber()
+{
+   QByteArray token;
+   while (true)
+   {
+      qint32 const c = this->peek();
+      if (((c < '0') || (c > '9')) && ('-' != c) && ('+' != c) && ('.' != c) && ('e' != c) && ('E' != c))
+         break;
+      token.append(static_cast<char>(this->get()));
+   }
+   bool ok = false;
+   double const result = token.toDouble(&ok);
+   if (token.isEmpty() || !ok)
+      this->throwError("Invalid value.");
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \return The literal value
+//**********************************************************************************************************************
+QJsonValue ComboListStreamReader::readLiteral()
+{
+   QByteArray token;
+   while ((this->peek() >= 'a') && (this->peek() <= 'z'))
+      token.append(static_cast<char>(this->get()));
+   if ("true" == token)
+      return true;
+   if ("false" == token)
+      return false;
+   if ("null" == token)
+      return QJsonValue();
+   this->throwError("Invalid value.");
+}
@@ -0,0 +1,69 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of the streaming reader for combo list files
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_COMBO_LIST_STREAM_READER_H
+#define BEEFTEXT_COMBO_LIST_STREAM_READER_H
+
+
+#include <functional>
+
+
+//**********************************************************************************************************************
+/// \brief A streaming reader for combo list files.
+///
+/// Unlike QJsonDocument, the reader never holds the whole file or its whole DOM in memory: it tokenizes the file
+/// block by block, and only builds JSON values for the members of the root object other than the combo array, and for
+/// one combo at a time. Because JSON objects are saved with sorted keys, the combo array comes before the version
+/// number and the groups in the file. The reader thus performs two passes: readHeader() skips the combo array and
+/// records its position, and readCombos() seeks back to it.
+///
+/// Errors are reported by throwing xmilib::Exception.
+//**********************************************************************************************************************
+class ComboListStreamReader
+{
+public: // type definitions
+   typedef std::function<void(QJsonValue const&)> ComboValueHandler; ///< Type definition for combo value callbacks
+
+public: // member functions
+   ComboListStreamReader(QIODevice& device, QString comboArrayKey); ///< Default constructor
+   ComboListStreamReader(ComboListStreamReader const&) = delete; ///< Disabled copy constructor
+   ComboListStreamReader(ComboListStreamReader&&) = delete; ///< Disabled move constructor
+   ~ComboListStreamReader() = default; ///< Default destructor
+   ComboListStreamReader& operator=(ComboListStreamReader const&) = delete; ///< Disabled assignment operator
+   ComboListStreamReader& operator=(ComboListStreamReader&&) = delete; ///< Disabled move assignment operator
+   QJsonObject readHeader(); ///< Read the root object except the combo array, and locate the combo array
+   void readCombos(ComboValueHandler const& handler); ///< Read the combo array, calling a handler for each combo
+
+private: // member functions
+   [[noreturn]] void throwError(QString const& message) const; ///< Throw an exception for a parsing error
+   qint64 position() const; ///< Return the current position in the device
+   void seek(qint64 pos); ///< Move to a position in the device
+   qint32 peek(); ///< Return the next byte without consuming it, or -1 at the end of the device
+   qint32 get(); ///< Consume and return the next byte, or -1 at the end of the device
+   void expect(char c); ///< Consume the next byte, which must be a given character
+   void skipWhitespaces(); ///< Skip whitespaces
+   QJsonValue readValue(qint32 depth); ///< Read a JSON value
+   void skipValue(qint32 depth); ///< Skip a JSON value
+   QString readString(); ///< Read a JSON string, whose opening quote has been consumed
+   void skipString(); ///< Skip a JSON string, whose opening quote has been consumed
+   quint16 readHexCodeUnit(); ///< Read the four hexadecimal digits of a \\u escape sequence
+   QJsonValue readNumber(); ///< Read a JSON number
+   QJsonValue readLiteral(); ///< Read one of the true, false or null literals
+
+private: // data members
+   QIODevice& device_; ///< The device
+   QString comboArrayKey_; ///< The key of the combo array in the root object
+   QByteArray buffer_; ///< The current block of data
+   qint32 bufferPos_ { 0 }; ///< The position of the next byte in the buffer
+   qint64 bufferStart_ { 0 }; ///< The position of the buffer in the device
+   qint64 combosPos_ { -1 }; ///< The position of the combos value in the device, or -1 if none was found
+};
+
+
+#endif // #ifndef BEEFTEXT_COMBO_LIST_STREAM_READER_H
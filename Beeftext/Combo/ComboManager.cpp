@@ -11,6 +11,8 @@
 #include "ComboManager.h"
 #include "LastUseFile.h"
 #include "InputManager.h"
+#include "KeystrokeTrace.h"
+#include "SubstitutionLatencyMonitor.h"
 #include "PreferencesManager.h"
 #include "BeeftextUtils.h"
 #include "BeeftextGlobals.h"
@@ -23,17 +25,26 @@ using namespace xmilib;
 
 namespace {
 
+qint64 const kJournalCompactionThreshold = 1024 * 1024; ///< The journal size that triggers a compaction, in bytes
+qint32 const kSaveDelayMs = 500; ///< The delay used to coalesce save requests, in milliseconds
+
+
 bool isBeeftextTheForegroundApplication(); ///< Check whether Beeftext is the foreground application
 
 
 //**********************************************************************************************************************
-/// \return true if and only if Beeftext is the application currently in the foreground
+/// \return true if and only if Beeftext is the application currently in the foreground. Always false on platforms
+/// other than Windows, where substitutions are performed by a backend that does not target a foreground window.
 //**********************************************************************************************************************
 bool isBeeftextTheForegroundApplication()
 {
+#ifdef Q_OS_WIN
    DWORD processId = 0;
    GetWindowThreadProcessId(GetForegroundWindow(), &processId);
    return QCoreApplication::applicationPid() == processId;
+#else
+   return false;
+#endif // #ifdef Q_OS_WIN
 }
 
 
@@ -73,30 +84,40 @@ ComboList const& ComboManager::comboListRef() const
 //**********************************************************************************************************************
 ComboManager::ComboManager()
 {
-   // We used queued connections to minimize the time spent in the keyboard hook
+   // The key events are produced in the keyboard hook thread, we drain them from the GUI thread.
    InputManager& inputManager = InputManager::instance();
-   connect(&inputManager, &InputManager::comboBreakerTyped, this, &ComboManager::onComboBreakerTyped,
-      Qt::QueuedConnection);
-   connect(&inputManager, &InputManager::characterTyped, this, &ComboManager::onCharacterTyped,
-      Qt::QueuedConnection);
-   connect(&inputManager, &InputManager::backspaceTyped, this, &ComboManager::onBackspaceTyped,
+   connect(&inputManager, &InputManager::keyEventsAvailable, this, &ComboManager::onKeyEventsAvailable,
       Qt::QueuedConnection);
+   QTimer::singleShot(0, this, &ComboManager::onKeyEventsAvailable); // events may have been queued before we connected
    connect(&inputManager, &InputManager::substitutionShortcutTriggered, this,
       &ComboManager::onSubstitutionTriggerShortcut, Qt::QueuedConnection);
+   connect(&writeWatcher_, &QFutureWatcher<bool>::finished, this, &ComboManager::onBackgroundWriteFinished);
+   saveTimer_.setSingleShot(true);
+   saveTimer_.setInterval(kSaveDelayMs);
+   connect(&saveTimer_, &QTimer::timeout, this, &ComboManager::onSaveTimerTimeout);
    QString errMsg;
 
-   if (!QFileInfo(QDir(PreferencesManager::instance().comboListFolderPath())
-      .absoluteFilePath(ComboList::defaultFileName)).exists()) // we avoid displaying an error on first launch
+   if (!QFileInfo(this->existingComboListFilePath()).exists()) // we avoid displaying an error on first launch
    {
       comboList_.ensureCorrectGrouping();
       return;
    }
    if (!this->loadComboListFromFile(&errMsg))
       QMessageBox::critical(nullptr, tr("Error"), errMsg);
+   this->ensureAutomatonIsUpToDate(); // we build the automaton now rather than on the first keystroke
    this->loadSoundFromPreferences();
 }
 
 
+//**********************************************************************************************************************
+// 
+//**********************************************************************************************************************
+ComboManager::~ComboManager()
+{
+   writeWatcher_.waitForFinished();
+}
+
+
 //**********************************************************************************************************************
 /// \return A reference to the combo group attached to the combo list
 //**********************************************************************************************************************
@@ -116,6 +137,21 @@ GroupList const& ComboManager::groupListRef() const
 
 
 //**********************************************************************************************************************
+/// \return A reference to the dependency graph of the combo list
+//**********************************************************************************************************************
+ComboDependencyGraph& ComboManager::dependencyGraph()
+{
+   if (!dependencyGraph_.isUpToDate(comboList_))
+      dependencyGraph_.build(comboList_);
+   return dependencyGraph_;
+}
+
+
+//**********************************************************************************************************************
+/// The whole combo list is parsed and every combo is created before the function returns, because the combo table and
+/// group views bind to the live combo list as soon as the main window is created. The binary combo list file is the
+/// fastest format to load.
+///
 /// \param[out] outErrorMsg If not null the function returns false, this variable will contain a description 
 /// of the error.
 //**********************************************************************************************************************
@@ -123,15 +159,31 @@ bool ComboManager::loadComboListFromFile(QString* outErrorMsg)
 {
    BackupManager::instance().cleanup();
    bool inOlderFormat = false;
-   QString const& path = QDir(PreferencesManager::instance().comboListFolderPath())
-      .absoluteFilePath(ComboList::defaultFileName);
+   QString const path = this->existingComboListFilePath();
    if (!comboList_.load(path, &inOlderFormat, outErrorMsg))
       return false;
+   QString journalErrorMsg;
+   if (ComboListJournal::replay(path, comboList_, &journalErrorMsg))
+      journal_.reset(comboList_, path);
+   else
+   {
+      globals::debugLog().addError(QString("Could not replay the combo list journal: %1").arg(journalErrorMsg));
+      journal_.invalidate(); // the next save will be a full save, discarding the journal
+   }
    bool wasInvalid = false;
    comboList_.ensureCorrectGrouping(&wasInvalid);
+   QStringList const cyclicKeywords = this->dependencyGraph().cyclicKeywords();
+   if (!cyclicKeywords.isEmpty())
+      globals::debugLog().addWarning(QString("The following combo keywords are part of circular references, and will "
+         "not be fully expanded: %1").arg(cyclicKeywords.join(", ")));
+   if (QFileInfo::exists(ComboListJournal::compactingJournalFilePath(path)) && (!inOlderFormat) && (!wasInvalid))
+   {
+      if (!this->writeComboListFile()) // a compaction was interrupted, we complete it
+         globals::debugLog().addWarning("Could not compact the combo list journal.");
+   }
    if (inOlderFormat || wasInvalid)
    {
-      if (!this->saveComboListToFile(outErrorMsg))
+      if (!this->writeComboListFile(outErrorMsg))
          globals::debugLog().addWarning(inOlderFormat ?
             "Could not upgrade the combo list file to the newest format version." :
             "Could not save the combo list file after fixing the grouping of combos.");
@@ -145,24 +197,173 @@ bool ComboManager::loadComboListFromFile(QString* outErrorMsg)
 }
 
 
+//**********************************************************************************************************************
+/// When possible, the changes made since the last save are appended to the journal instead of rewriting the whole
+/// combo list file. The journal is compacted in the background when it grows too large. Changes to groups and changes
+/// of the combo list folder trigger a full save.
+///
+/// Any pending background save is performed by this call, and the function waits for the background write in
+/// progress, if any.
+///
+/// \param[out] outErrorMsg If not null the function returns false, this variable will contain a description 
+/// of the error.
+/// \return true if and only if the operation completed successfully
+//**********************************************************************************************************************
+bool ComboManager::saveComboListToFile(QString* outErrorMsg)
+{
+   saveTimer_.stop();
+   this->waitForBackgroundWrite();
+   if (this->appendToJournal())
+      return true;
+   return this->writeComboListFile(outErrorMsg);
+}
+
+
+//**********************************************************************************************************************
+/// Requests made within a short delay are coalesced into a single save, performed on the GUI thread for journal
+/// records, and on a worker thread for full saves. The result is reported through the comboListWasSaved() signal.
+//**********************************************************************************************************************
+void ComboManager::requestComboListSave()
+{
+   saveTimer_.start();
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void ComboManager::flushComboListSave()
+{
+   if (saveTimer_.isActive())
+   {
+      QString errorMsg;
+      if (!this->saveComboListToFile(&errorMsg))
+         globals::debugLog().addError(QString("Could not save the combo list: %1").arg(errorMsg));
+   }
+   this->waitForBackgroundWrite();
+}
+
+
+//**********************************************************************************************************************
+/// \return true if and only if the changes were appended to the journal, and the combo list was saved
+//**********************************************************************************************************************
+bool ComboManager::appendToJournal()
+{
+   QString const filePath = this->comboListFilePath();
+   if (!journal_.canAppend(comboList_, filePath))
+      return false;
+   QString errorMsg;
+   if (!journal_.append(comboList_, &errorMsg))
+   {
+      globals::debugLog().addWarning(QString("Could not append to the combo list journal, performing a full save: "
+         "%1").arg(errorMsg));
+      return false;
+   }
+   emit comboListWasSaved(true, QString());
+   if (journal_.fileSize() >= kJournalCompactionThreshold)
+      this->startJournalCompaction();
+   return true;
+}
+
+
 //**********************************************************************************************************************
 /// \param[out] outErrorMsg If not null the function returns false, this variable will contain a description 
 /// of the error.
 /// \return true if and only if the operation completed successfully
 //**********************************************************************************************************************
-bool ComboManager::saveComboListToFile(QString* outErrorMsg) const
+bool ComboManager::writeComboListFile(QString* outErrorMsg)
 {
+   this->waitForBackgroundWrite();
    PreferencesManager& prefs = PreferencesManager::instance();
-   QString const filePath = QDir(prefs.comboListFolderPath()).absoluteFilePath(ComboList::defaultFileName);
+   QString const filePath = this->comboListFilePath();
    if (prefs.autoBackup())
-      BackupManager::instance().archive(filePath);
-   bool const result = comboList_.save(filePath, true, outErrorMsg);
+      BackupManager::instance().archive(this->existingComboListFilePath());
+   bool const result = prefs.useBinaryComboListFile() ? comboList_.saveToCborFile(filePath, outErrorMsg) :
+      comboList_.save(filePath, true, outErrorMsg);
    if (result)
-   emit comboListWasSaved();
+   {
+      this->removeComboListFileInOtherFormat();
+      ComboListJournal::removeFiles(filePath);
+      journal_.reset(comboList_, filePath);
+      emit comboListWasSaved(true, QString());
+   }
    return result;
 }
 
 
+//**********************************************************************************************************************
+/// The journal is renamed, so that changes made while the combo list file is rewritten in the background go to a
+/// new journal.
+//**********************************************************************************************************************
+void ComboManager::startJournalCompaction()
+{
+   if (writeInProgress_)
+      return;
+   QString errorMsg;
+   if (!journal_.beginCompaction(&errorMsg))
+   {
+      globals::debugLog().addWarning(QString("Could not start the compaction of the combo list journal: %1")
+         .arg(errorMsg));
+      return;
+   }
+   this->startBackgroundWrite(true);
+}
+
+
+//**********************************************************************************************************************
+/// The previous file is backed up and a record of the combo list is taken on the GUI thread. Moving the previous file
+/// and copying the values are cheap compared to serializing them, so the serialization of the record and the write are
+/// performed by a worker thread, that does not log or access any singleton. The result is reported on the GUI thread
+/// (see onBackgroundWriteFinished()).
+///
+/// \param[in] isCompaction Is the write a compaction of the journal. If not, the write is a full save, and the
+/// journal is discarded when it completes.
+//**********************************************************************************************************************
+void ComboManager::startBackgroundWrite(bool isCompaction)
+{
+   PreferencesManager& prefs = PreferencesManager::instance();
+   QString const filePath = this->comboListFilePath();
+   if (prefs.autoBackup())
+   {
+      try
+      {
+         BackupManager::instance().archive(this->existingComboListFilePath());
+      }
+      catch (Exception const& e)
+      {
+         globals::debugLog().addWarning(QString("Could not back up the combo list file: %1").arg(e.qwhat()));
+      }
+   }
+   bool const binary = prefs.useBinaryComboListFile();
+   ComboListRecord record = comboList_.record();
+   if (!isCompaction)
+      journal_.reset(comboList_, filePath);
+   writeInProgress_ = true;
+   writeIsCompaction_ = isCompaction;
+   writePath_ = filePath;
+   writeWatcher_.setFuture(QtConcurrent::run([record = std::move(record), binary, filePath]() -> bool
+   {
+      QSaveFile file(filePath);
+      if (!file.open(QIODevice::WriteOnly))
+         return false;
+      QByteArray const data = binary ? record.toCborValue().toCbor() : record.toJsonDocument(true).toJson();
+      return (data.size() == file.write(data)) && file.commit();
+   }));
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void ComboManager::waitForBackgroundWrite()
+{
+   if (!writeInProgress_)
+      return;
+   writeWatcher_.waitForFinished();
+   this->onBackgroundWriteFinished(); // the finished signal will be ignored, as no write is in progress anymore
+}
+
+
 //**********************************************************************************************************************
 /// \param[in] backupFilePath The path of the backup file
 /// \return true if the backup was correctly restored
@@ -175,7 +376,7 @@ bool ComboManager::restoreBackup(QString const& backupFilePath)
       return false;
    comboList_.ensureCorrectGrouping();
    emit backupWasRestored();
-   return this->saveComboListToFile();
+   return this->writeComboListFile();
 }
 
 
@@ -220,8 +421,12 @@ void ComboManager::playSound() const
 //**********************************************************************************************************************
 void ComboManager::checkAndPerformSubstitution()
 {
+   if (substitutionInProgress_)
+      return;
+   substitutionInProgress_ = true;
    if (!this->checkAndPerformComboSubstitution())
       this->checkAndPerformEmojiSubstitution();
+   substitutionInProgress_ = false;
 }
 
 
@@ -231,6 +436,7 @@ void ComboManager::checkAndPerformSubstitution()
 //**********************************************************************************************************************
 bool ComboManager::checkAndPerformComboSubstitution()
 {
+   LatencySpan matchingSpan(ESubstitutionPhase::Matching);
    PreferencesManager const& prefs = PreferencesManager::instance();
    bool const triggersOnSpace = (prefs.useAutomaticSubstitution() && prefs.comboTriggersOnSpace());
    
@@ -241,12 +447,20 @@ bool ComboManager::checkAndPerformComboSubstitution()
       if (!cond) 
          return false;
       currentText_.chop(1); // the last character is a space, and we want to remove it before matching keywords
+      if (!automatonStates_.isEmpty())
+         automatonStates_.pop_back();
    }
 
+   // In automatic mode, the keyword automaton is fed at every keystroke. Otherwise, the suffix trie is queried on
+   // demand. In both cases, the matches are sorted by decreasing keyword length.
    VecSpCombo result;
-   for (SpCombo const& combo: comboList_)
-      if (combo && combo->isUsable() && combo->matchesForInput(currentText_))
-         result.push_back(combo);
+   if (prefs.useAutomaticSubstitution())
+   {
+      this->ensureAutomatonIsUpToDate();
+      result = automaton_.matches(this->currentAutomatonState(), currentText_.size());
+   }
+   else
+      result = comboList_.findMatches(currentText_);
 
    if (result.empty())
    {
@@ -255,10 +469,21 @@ bool ComboManager::checkAndPerformComboSubstitution()
       return false;
    }
 
-   SpCombo const combo = result[result.size() > 1 ? static_cast<quint32>(rng_.get()) % result.size() : 0];
-   if ((!isBeeftextTheForegroundApplication()) &&
-      (combo->performSubstitution() && PreferencesManager::instance().playSoundOnCombo()) && sound_)
-      sound_->play(); // in Beeftext windows, substitution is disabled
+   // The longest keyword wins. Combos sharing this keyword are at the beginning of the result, we pick one randomly.
+   qint32 const longestKeywordSize = result.front()->keyword().size();
+   quint32 const candidateCount = static_cast<quint32>(std::count_if(result.begin(), result.end(),
+      [&](SpCombo const& c) -> bool { return c->keyword().size() == longestKeywordSize; }));
+   SpCombo const combo = result[candidateCount > 1 ? static_cast<quint32>(rng_.get()) % candidateCount : 0];
+   matchingSpan.finish();
+   KeystrokeTraceRecorder::instance().recordMatch(longestKeywordSize);
+   // in Beeftext windows, substitution is disabled
+   bool userWasPrompted = false; // the time spent in an input dialog would make the sample meaningless
+   bool const performed = (!isBeeftextTheForegroundApplication()) && combo->performSubstitution(&userWasPrompted);
+   if (performed && prefs.useAutomaticSubstitution() && !userWasPrompted)
+      SubstitutionLatencyMonitor::instance().record(ESubstitutionPhase::TriggerToCompletion,
+         InputManager::instance().timestampNs() - lastKeyEventTimestampNs_);
+   if (performed && prefs.playSoundOnCombo() && sound_)
+      sound_->play();
    this->onComboBreakerTyped();
    return true;
 }
@@ -307,12 +532,128 @@ bool ComboManager::checkAndPerformEmojiSubstitution()
 }
 
 
+//**********************************************************************************************************************
+/// The check is a simple comparison of revision numbers, so it can be performed at every keystroke. When the
+/// automaton is rebuilt, or when the states were not tracked because automatic substitution was disabled, the states
+/// for the current string are recomputed.
+//**********************************************************************************************************************
+void ComboManager::ensureAutomatonIsUpToDate()
+{
+   bool const isUpToDate = automaton_.isBuilt() && (automaton_.revision() == comboList_.revision());
+   if (isUpToDate && (automatonStates_.size() == currentText_.size()))
+      return;
+   if (!isUpToDate)
+      automaton_.build(comboList_);
+   automatonStates_.clear();
+   ComboKeywordAutomaton::State state = ComboKeywordAutomaton::rootState();
+   for (QChar const c: currentText_)
+   {
+      state = automaton_.nextState(state, c);
+      automatonStates_.push_back(state);
+   }
+}
+
+
+//**********************************************************************************************************************
+/// \return The state of the automaton after reading the current string.
+//**********************************************************************************************************************
+ComboKeywordAutomaton::State ComboManager::currentAutomatonState() const
+{
+   return automatonStates_.isEmpty() ? ComboKeywordAutomaton::rootState() : automatonStates_.back();
+}
+
+
+//**********************************************************************************************************************
+/// \return The path the combo list file is saved to, according to the file format selected in the preferences
+//**********************************************************************************************************************
+QString ComboManager::comboListFilePath() const
+{
+   PreferencesManager const& prefs = PreferencesManager::instance();
+   return ComboList::filePathInFolder(prefs.comboListFolderPath(), prefs.useBinaryComboListFile());
+}
+
+
+//**********************************************************************************************************************
+/// \return The path of the existing combo list file, which can be in either file format
+//**********************************************************************************************************************
+QString ComboManager::existingComboListFilePath() const
+{
+   return ComboList::existingFilePathInFolder(PreferencesManager::instance().comboListFolderPath());
+}
+
+
+//**********************************************************************************************************************
+/// This function is called after the combo list has been fully written, so that the next launch does not load a stale
+/// file in the other format.
+//**********************************************************************************************************************
+void ComboManager::removeComboListFileInOtherFormat() const
+{
+   PreferencesManager const& prefs = PreferencesManager::instance();
+   QString const otherPath = ComboList::filePathInFolder(prefs.comboListFolderPath(),
+      !prefs.useBinaryComboListFile());
+   ComboListJournal::removeFiles(otherPath);
+   if (QFileInfo(otherPath).exists() && !QFile(otherPath).remove())
+      globals::debugLog().addWarning(QString("Could not remove the combo list file '%1'.")
+         .arg(QDir::toNativeSeparators(otherPath)));
+}
+
+
+//**********************************************************************************************************************
+/// Evaluating the variables of a snippet, for instance a script variable, can process events while the substitution is
+/// in progress. The key events processed at that time are discarded: the current text is reset when the substitution
+/// completes, and they must not trigger a recursive substitution.
+//**********************************************************************************************************************
+void ComboManager::onKeyEventsAvailable()
+{
+   InputManager& inputManager = InputManager::instance();
+   KeystrokeTraceRecorder& recorder = KeystrokeTraceRecorder::instance();
+   InputManager::KeyEvent event;
+   while (inputManager.popKeyEvent(event))
+   {
+      recorder.recordKeyEvent(event);
+      if (event.followsDrop)
+         this->onKeyEventsDropped();
+      if (substitutionInProgress_)
+         continue;
+      lastKeyEventTimestampNs_ = event.timestampNs;
+      switch (event.type)
+      {
+      case InputManager::EKeyEventType::Character:
+         this->onCharacterTyped(event.character);
+         break;
+      case InputManager::EKeyEventType::Backspace:
+         this->onBackspaceTyped();
+         break;
+      case InputManager::EKeyEventType::ComboBreaker:
+      default:
+         this->onComboBreakerTyped();
+         break;
+      }
+   }
+}
+
+
+//**********************************************************************************************************************
+/// This function is called before processing the first key event that follows key events dropped because the queue
+/// was full. The current text is not reliable anymore, so it is reset.
+//**********************************************************************************************************************
+void ComboManager::onKeyEventsDropped()
+{
+   quint64 const droppedCount = InputManager::instance().droppedKeyEventCount();
+   globals::debugLog().addWarning(QString("%1 key event(s) were dropped because the key event queue was full.")
+      .arg(droppedCount - droppedKeyEventCount_));
+   droppedKeyEventCount_ = droppedCount;
+   this->onComboBreakerTyped();
+}
+
+
 //**********************************************************************************************************************
 // 
 //**********************************************************************************************************************
 void ComboManager::onComboBreakerTyped()
 {
    currentText_ = QString();
+   automatonStates_.clear();
 }
 
 
@@ -322,6 +663,11 @@ void ComboManager::onComboBreakerTyped()
 void ComboManager::onCharacterTyped(QChar c)
 {
    PreferencesManager const& prefs = PreferencesManager::instance();
+   if (prefs.useAutomaticSubstitution())
+   {
+      this->ensureAutomatonIsUpToDate();
+      automatonStates_.push_back(automaton_.nextState(this->currentAutomatonState(), c));
+   }
    currentText_.append(c);
    if ((!prefs.useAutomaticSubstitution()) || (prefs.comboTriggersOnSpace() && (!c.isSpace())))
       return;
@@ -335,6 +681,8 @@ void ComboManager::onCharacterTyped(QChar c)
 void ComboManager::onBackspaceTyped()
 {
    currentText_.chop(1);
+   if (!automatonStates_.isEmpty())
+      automatonStates_.pop_back();
 }
 
 
@@ -346,3 +694,60 @@ void ComboManager::onSubstitutionTriggerShortcut()
    if (!PreferencesManager::instance().useAutomaticSubstitution())
       this->checkAndPerformSubstitution();
 }
+
+
+//**********************************************************************************************************************
+// 
+//**********************************************************************************************************************
+void ComboManager::onSaveTimerTimeout()
+{
+   if (writeInProgress_ && !writeIsCompaction_)
+   {
+      saveTimer_.start(); // the journal cannot be appended to while a full save is in progress, we try again later
+      return;
+   }
+   if (this->appendToJournal())
+      return;
+   if (writeInProgress_)
+   {
+      saveTimer_.start();
+      return;
+   }
+   this->startBackgroundWrite(false);
+}
+
+
+//**********************************************************************************************************************
+// 
+//**********************************************************************************************************************
+void ComboManager::onBackgroundWriteFinished()
+{
+   if (!writeInProgress_)
+      return;
+   writeInProgress_ = false;
+   bool const success = writeWatcher_.result();
+   if (writeIsCompaction_)
+   {
+      if (success)
+      {
+         journal_.endCompaction();
+         globals::debugLog().addInfo("The combo list journal was compacted.");
+         return;
+      }
+      globals::debugLog().addWarning("The compaction of the combo list journal failed, performing a full save.");
+      journal_.invalidate();
+      this->requestComboListSave();
+      return;
+   }
+   if (success)
+   {
+      this->removeComboListFileInOtherFormat();
+      ComboListJournal::removeFiles(writePath_);
+      emit comboListWasSaved(true, QString());
+      return;
+   }
+   journal_.invalidate(); // the next save will be a full save
+   QString const errorMsg = tr("Could not save the combo list file %1.").arg(QDir::toNativeSeparators(writePath_));
+   globals::debugLog().addError(errorMsg);
+   emit comboListWasSaved(false, errorMsg);
+}
@@ -12,6 +12,9 @@
 
 
 #include "ComboList.h"
+#include "ComboKeywordAutomaton.h"
+#include "ComboDependencyGraph.h"
+#include "ComboListJournal.h"
 #include "Group/GroupList.h"
 #include <XMiLib/RandomNumberGenerator.h>
 #include <memory>
@@ -31,21 +34,25 @@ public: // static member functions
 public: // member functions
    ComboManager(ComboManager const&) = delete; ///< Disabled copy constructor
 	ComboManager(ComboManager const&&) = delete; ///< Disabled move constructor
-	~ComboManager() = default; ///< Default destructor
+	~ComboManager() override; ///< Destructor
 	ComboManager& operator=(ComboManager const&) = delete; ///< Disabled assignment operator
 	ComboManager& operator=(ComboManager const&&) = delete; ///< Disabled move assignment operator
    ComboList& comboListRef(); ///< Return a mutable reference to the combo list
    ComboList const& comboListRef() const; ///< Return a constant reference to the combo list
    GroupList& groupListRef(); ///< Return a mutable reference to the group list
    GroupList const& groupListRef() const; ///< Return a constant reference to the group list
+   ComboDependencyGraph& dependencyGraph(); ///< Return the dependency graph of the combo list, rebuilding it if needed
    bool loadComboListFromFile(QString* outErrorMsg = nullptr); ///< Load the combo list from the default file
-   bool saveComboListToFile(QString* outErrorMsg = nullptr) const; /// Save the combo list to the default location
+   bool saveComboListToFile(QString* outErrorMsg = nullptr); /// Save the combo list to the default location
+   void requestComboListSave(); ///< Schedule a save of the combo list in the background
+   void flushComboListSave(); ///< Perform the scheduled save of the combo list, if any, and wait for its completion
    bool restoreBackup(QString const& backupFilePath); /// Restore the combo list from a backup file
+   bool writeComboListFile(QString* outErrorMsg = nullptr); ///< Fully write the combo list file, and clear the journal
    void loadSoundFromPreferences(); ///< Load the combo sound to be played from the preferences
    void playSound() const; ///< Play the combo substitution sound.
 signals:
    void comboListWasLoaded() const; ///< Signal emitted when the combo list has been loaded
-   void comboListWasSaved() const;  ///< Signal emitted when the combo list has been saved
+   void comboListWasSaved(bool success, QString const& errorMessage) const;  ///< Signal emitted when the combo list has been saved, or a background save failed
    void backupWasRestored() const; ///< Signal emitted when a backup has been restored
 
 private: // member functions
@@ -53,18 +60,44 @@ private: // member functions
    void checkAndPerformSubstitution(); ///< Check if a combo or emoji substitution is possible and if so performs it
    bool checkAndPerformComboSubstitution(); ///< check if a combo substitution is possible and if so performs it
    bool checkAndPerformEmojiSubstitution(); ///< check if an emoji substitution is possible and if so performs it
+   void ensureAutomatonIsUpToDate(); ///< Rebuild the keyword automaton if the combo list changed since it was built
+   ComboKeywordAutomaton::State currentAutomatonState() const; ///< Return the automaton state for the current text
+   QString comboListFilePath() const; ///< Return the path the combo list file is saved to
+   QString existingComboListFilePath() const; ///< Return the path of the existing combo list file
+   void removeComboListFileInOtherFormat() const; ///< Remove the combo list file in the format that is not in use
+   bool appendToJournal(); ///< Save the combo list by appending the changes to the journal, if possible
+   void startJournalCompaction(); ///< Start compacting the journal into the combo list file in the background
+   void startBackgroundWrite(bool isCompaction); ///< Start writing the combo list file in the background
+   void waitForBackgroundWrite(); ///< Wait for the completion of the background write in progress, if any
+
+   void onComboBreakerTyped(); ///< Process a combo breaker event
+   void onCharacterTyped(QChar c); ///< Process a typed character
+   void onBackspaceTyped(); ///< Process a backspace
+   void onKeyEventsDropped(); ///< Process the loss of key events dropped because the queue was full
 
 private slots:
-   void onComboBreakerTyped(); ///< Slot for the "Combo Breaker Typed" signal
-   void onCharacterTyped(QChar c); ///< Slot for the "Character Typed" signal
-   void onBackspaceTyped(); ///< Slot for the 'Backspace typed" signal
+   void onKeyEventsAvailable(); ///< Slot for the availability of key events in the queue of the input manager
    void onSubstitutionTriggerShortcut(); ///< Slot for the triggering of the substitution shortcut
+   void onSaveTimerTimeout(); ///< Slot for the timeout of the save timer
+   void onBackgroundWriteFinished(); ///< Slot for the completion of the background write of the combo list file
 
 private: // data member
    QString currentText_; ///< The current string
+   ComboKeywordAutomaton automaton_; ///< The automaton recognizing combo keywords
+   QVector<ComboKeywordAutomaton::State> automatonStates_; ///< The automaton state after each character of the current string
    ComboList comboList_; ///< The list of combos
+   ComboDependencyGraph dependencyGraph_; ///< The dependency graph of the combo list, built lazily
+   ComboListJournal journal_; ///< The journal of the changes made to the combo list since its file was last written
+   QTimer saveTimer_; ///< The timer used to coalesce save requests
+   QFutureWatcher<bool> writeWatcher_; ///< The watcher for the background write of the combo list file
+   bool writeInProgress_ { false }; ///< Is a background write of the combo list file in progress
+   bool writeIsCompaction_ { false }; ///< Is the background write in progress a compaction of the journal
+   QString writePath_; ///< The path of the file being written in the background
    std::unique_ptr<QSound> sound_; ///< The sound to play when a combo is executed
    xmilib::RandomNumberGenerator rng_; ///< The RNG used to pick combos when multiple occurences are found
+   quint64 droppedKeyEventCount_ { 0 }; ///< The number of dropped key events already accounted for
+   qint64 lastKeyEventTimestampNs_ { 0 }; ///< The timestamp of the last processed key event
+   bool substitutionInProgress_ { false }; ///< Is a substitution being performed
 };
 
 
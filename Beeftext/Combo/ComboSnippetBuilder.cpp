@@ -0,0 +1,118 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the builder for evaluated snippets
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "ComboSnippetBuilder.h"
+
+
+namespace {
+
+
+QString const kCursorMarker = "#{cursor}"; ///< The marker for the cursor position
+
+
+} // anonymous namespace
+
+
+//**********************************************************************************************************************
+/// \param[in] processCursor If true, #{cursor} markers are removed and their position is recorded. Otherwise they are
+/// left in place
+//**********************************************************************************************************************
+ComboSnippetBuilder::ComboSnippetBuilder(bool processCursor)
+   : processCursor_(processCursor)
+{
+}
+
+
+//**********************************************************************************************************************
+/// Literal runs cannot contain a #{cursor} marker, so they are not scanned.
+///
+/// \param[in] text The string the run is taken from
+/// \param[in] position The position of the run in the string
+/// \param[in] length The length of the run
+//**********************************************************************************************************************
+void ComboSnippetBuilder::appendLiteral(QString const& text, qint32 position, qint32 length)
+{
+   if (length <= 0)
+      return;
+   chunks_.push_back({ text, position, length });
+   length_ += length;
+}
+
+
+//**********************************************************************************************************************
+/// The value may contain #{cursor} markers, for instance if it is the expansion of another combo.
+///
+/// \param[in] value The value
+//**********************************************************************************************************************
+void ComboSnippetBuilder::appendValue(QString const& value)
+{
+   if (!processCursor_)
+   {
+      this->appendLiteral(value, 0, value.size());
+      return;
+   }
+   qint32 start = 0;
+   while (true)
+   {
+      qint32 const index = value.indexOf(kCursorMarker, start);
+      if (index < 0)
+         break;
+      this->appendLiteral(value, start, index - start);
+      cursorPosition_ = length_;
+      start = index + kCursorMarker.size();
+   }
+   this->appendLiteral(value, start, value.size() - start);
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void ComboSnippetBuilder::appendCursor()
+{
+   if (processCursor_)
+      cursorPosition_ = length_;
+   else
+      this->appendLiteral(kCursorMarker, 0, kCursorMarker.size());
+}
+
+
+//**********************************************************************************************************************
+/// \return The length of the text
+//**********************************************************************************************************************
+qint32 ComboSnippetBuilder::length() const
+{
+   return length_;
+}
+
+
+//**********************************************************************************************************************
+/// \return The position of the last #{cursor} marker in the text, once markers have been removed
+/// \return -1 if the text contains no marker, or if cursor processing is disabled
+//**********************************************************************************************************************
+qint32 ComboSnippetBuilder::cursorPosition() const
+{
+   return cursorPosition_;
+}
+
+
+//**********************************************************************************************************************
+/// \return The text
+//**********************************************************************************************************************
+QString ComboSnippetBuilder::toString() const
+{
+   if ((1 == chunks_.size()) && (chunks_[0].length == chunks_[0].text.size()))
+      return chunks_[0].text; // no copy needed
+   QString result;
+   result.reserve(length_);
+   for (Chunk const& chunk: chunks_)
+      result.append(chunk.text.midRef(chunk.position, chunk.length));
+   return result;
+}
@@ -0,0 +1,56 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of the builder for evaluated snippets
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_COMBO_SNIPPET_BUILDER_H
+#define BEEFTEXT_COMBO_SNIPPET_BUILDER_H
+
+
+#include <vector>
+
+
+//**********************************************************************************************************************
+/// \brief A builder assembling an evaluated snippet from chunks.
+///
+/// Chunks share the data of the strings they are taken from, and the text is assembled in a single allocation when
+/// the evaluation is complete. When cursor processing is enabled, the #{cursor} markers are removed as the text is
+/// built, and the position of the last one is recorded, so that the final text never needs to be scanned again.
+//**********************************************************************************************************************
+class ComboSnippetBuilder
+{
+public: // member functions
+   explicit ComboSnippetBuilder(bool processCursor); ///< Constructor
+   ComboSnippetBuilder(ComboSnippetBuilder const&) = delete; ///< Disabled copy constructor
+   ComboSnippetBuilder(ComboSnippetBuilder&&) = delete; ///< Disabled move constructor
+   ~ComboSnippetBuilder() = default; ///< Default destructor
+   ComboSnippetBuilder& operator=(ComboSnippetBuilder const&) = delete; ///< Disabled assignment operator
+   ComboSnippetBuilder& operator=(ComboSnippetBuilder&&) = delete; ///< Disabled move assignment operator
+   void appendLiteral(QString const& text, qint32 position, qint32 length); ///< Append a literal run
+   void appendValue(QString const& value); ///< Append the value of a variable
+   void appendCursor(); ///< Append a #{cursor} variable
+   qint32 length() const; ///< Return the length of the text
+   qint32 cursorPosition() const; ///< Return the position of the cursor
+   QString toString() const; ///< Assemble the text
+
+private: // data types
+   struct Chunk
+   {
+      QString text; ///< The string the chunk is taken from
+      qint32 position { 0 }; ///< The position of the chunk in the string
+      qint32 length { 0 }; ///< The length of the chunk
+   }; ///< A chunk of text
+
+private: // data members
+   std::vector<Chunk> chunks_; ///< The chunks
+   qint32 length_ { 0 }; ///< The length of the text
+   qint32 cursorPosition_ { -1 }; ///< The position of the last #{cursor} marker, or -1 if there is none
+   bool processCursor_ { false }; ///< Are #{cursor} markers processed
+};
+
+
+#endif // #ifndef BEEFTEXT_COMBO_SNIPPET_BUILDER_H
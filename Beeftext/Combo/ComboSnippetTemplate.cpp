@@ -0,0 +1,153 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the compiled form of combo snippets
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "ComboSnippetTemplate.h"
+
+
+namespace {
+
+
+QString const kVariableStart = "#{"; ///< The opening sequence of variables
+QString const kCursorVariable = "cursor"; ///< The cursor variable
+
+
+} // anonymous namespace
+
+
+//**********************************************************************************************************************
+/// \param[in] snippet The snippet
+//**********************************************************************************************************************
+ComboSnippetTemplate::ComboSnippetTemplate(QString const& snippet)
+{
+   this->compile(snippet);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] snippet The snippet
+//**********************************************************************************************************************
+void ComboSnippetTemplate::compile(QString const& snippet)
+{
+   snippet_ = snippet;
+   tokens_.clear();
+   isStatic_ = true;
+   qint32 const size = snippet.size();
+   qint32 literalStart = 0;
+   qint32 searchFrom = 0;
+   auto const addLiteral = [&](qint32 end)
+   {
+      if (end <= literalStart)
+         return;
+      Token token;
+      token.position = literalStart;
+      token.length = end - literalStart;
+      tokens_.push_back(token);
+   };
+
+   while (true)
+   {
+      qint32 const start = snippet.indexOf(kVariableStart, searchFrom);
+      if (start < 0)
+         break;
+      qint32 end = -1;
+      for (qint32 i = start + kVariableStart.size(); i < size; ++i)
+      {
+         QChar const c = snippet[i];
+         if ('\n' == c)
+            break;
+         if (('}' == c) && ('\\' != snippet[i - 1]))
+         {
+            end = i;
+            break;
+         }
+      }
+      if (end < 0)
+      {
+         searchFrom = start + 1;
+         continue;
+      }
+      addLiteral(start);
+      Token token;
+      token.isVariable = true;
+      token.variable = snippet.mid(start + kVariableStart.size(), end - start - kVariableStart.size());
+      token.variable.replace("\\}", "}");
+      token.isCursor = (kCursorVariable == token.variable);
+      token.evaluator = ComboVariableRegistry::instance().resolve(token.variable);
+      tokens_.push_back(token);
+      isStatic_ = false;
+      literalStart = searchFrom = end + 1;
+   }
+   addLiteral(size);
+}
+
+
+//**********************************************************************************************************************
+/// \return true if and only if the snippet contains no variable
+//**********************************************************************************************************************
+bool ComboSnippetTemplate::isStatic() const
+{
+   return isStatic_;
+}
+
+
+//**********************************************************************************************************************
+/// \return The variables of the snippet, unescaped and without the enclosing #{}, in order of appearance
+//**********************************************************************************************************************
+QStringList ComboSnippetTemplate::variables() const
+{
+   QStringList result;
+   for (Token const& token: tokens_)
+      if (token.isVariable)
+         result.append(token.variable);
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// This function does not process the #{cursor} variable, that is left in place.
+///
+/// \param[in,out] context The evaluation context
+/// \param[out] outCancelled Did the user cancel user input
+/// \return The snippet text once it has been evaluated
+//**********************************************************************************************************************
+QString ComboSnippetTemplate::evaluate(ComboEvaluationContext& context, bool& outCancelled) const
+{
+   outCancelled = false;
+   if (isStatic_)
+      return snippet_;
+   ComboSnippetBuilder builder(false);
+   this->evaluate(context, builder, outCancelled);
+   return outCancelled ? QString() : builder.toString();
+}
+
+
+//**********************************************************************************************************************
+/// \param[in,out] context The evaluation context
+/// \param[in,out] builder The builder the evaluated snippet is appended to
+/// \param[out] outCancelled Did the user cancel user input. If true, the content of the builder is undefined
+//**********************************************************************************************************************
+void ComboSnippetTemplate::evaluate(ComboEvaluationContext& context, ComboSnippetBuilder& builder,
+   bool& outCancelled) const
+{
+   outCancelled = false;
+   for (Token const& token: tokens_)
+   {
+      if (!token.isVariable)
+         builder.appendLiteral(snippet_, token.position, token.length);
+      else if (token.isCursor)
+         builder.appendCursor();
+      else
+      {
+         builder.appendValue((*token.evaluator)(token.variable, context, outCancelled));
+         if (outCancelled)
+            return;
+      }
+   }
+}
@@ -0,0 +1,61 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of the compiled form of combo snippets
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_COMBO_SNIPPET_TEMPLATE_H
+#define BEEFTEXT_COMBO_SNIPPET_TEMPLATE_H
+
+
+#include "ComboVariableRegistry.h"
+#include "ComboSnippetBuilder.h"
+#include <vector>
+
+
+//**********************************************************************************************************************
+/// \brief A snippet compiled into a list of literal runs and variables.
+///
+/// A variable is written #{...}. Its closing brace is the first one that is not escaped with a backslash, and it
+/// cannot span several lines. Escaped closing braces are unescaped and the evaluators of variables are resolved at
+/// compilation time. Text that does not form a valid variable is kept as a literal. #{cursor} variables are not
+/// evaluated but passed to the builder, that decides whether to keep them.
+//**********************************************************************************************************************
+class ComboSnippetTemplate
+{
+public: // member functions
+   ComboSnippetTemplate() = default; ///< Default constructor
+   explicit ComboSnippetTemplate(QString const& snippet); ///< Constructor from a snippet
+   ComboSnippetTemplate(ComboSnippetTemplate const&) = default; ///< Default copy constructor
+   ComboSnippetTemplate(ComboSnippetTemplate&&) = default; ///< Default move constructor
+   ~ComboSnippetTemplate() = default; ///< Default destructor
+   ComboSnippetTemplate& operator=(ComboSnippetTemplate const&) = default; ///< Default assignment operator
+   ComboSnippetTemplate& operator=(ComboSnippetTemplate&&) = default; ///< Default move assignment operator
+   void compile(QString const& snippet); ///< Compile a snippet
+   bool isStatic() const; ///< Check whether the snippet contains no variable
+   QStringList variables() const; ///< Return the variables of the snippet
+   QString evaluate(ComboEvaluationContext& context, bool& outCancelled) const; ///< Evaluate the snippet
+   void evaluate(ComboEvaluationContext& context, ComboSnippetBuilder& builder, bool& outCancelled) const; ///< Evaluate the snippet into a builder
+
+private: // data types
+   struct Token
+   {
+      bool isVariable { false }; ///< Is the token a variable
+      bool isCursor { false }; ///< Is the token a #{cursor} variable
+      qint32 position { 0 }; ///< For literal runs, the position of the run in the snippet
+      qint32 length { 0 }; ///< For literal runs, the length of the run
+      QString variable; ///< For variables, the unescaped content of the variable
+      ComboVariableRegistry::SpEvaluator evaluator; ///< For variables, the evaluator, resolved at compilation time
+   }; ///< A token of the compiled snippet
+
+private: // data members
+   QString snippet_; ///< The snippet
+   std::vector<Token> tokens_; ///< The tokens
+   bool isStatic_ { true }; ///< Does the snippet contain no variable
+};
+
+
+#endif // #ifndef BEEFTEXT_COMBO_SNIPPET_TEMPLATE_H
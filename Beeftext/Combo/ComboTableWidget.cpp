@@ -127,15 +127,11 @@ void ComboTableWidget::selectCombo(SpCombo const& combo) const
    if (groupListWidget_)
       groupListWidget_->selectGroup(combo->group());
    ComboList& comboList = ComboManager::instance().comboListRef();
-   for (qint32 i = 0; i < comboList.size(); ++i)
-   {
-      SpCombo const& c = comboList[i];
-      if (c && (c->uuid() == combo->uuid()))
-      {
-         ui_.tableComboList->selectRow(proxyModel_.mapFromSource(comboList.index(i, 0)).row());
-         return;
-      }
-   }
+   ComboList::const_iterator const it = comboList.findByUuid(combo->uuid());
+   if (it == comboList.end())
+      return;
+   qint32 const row = static_cast<qint32>(it - comboList.begin());
+   ui_.tableComboList->selectRow(proxyModel_.mapFromSource(comboList.index(row, 0)).row());
 }
 
 
@@ -362,9 +358,7 @@ void ComboTableWidget::changeMatchingModeOfSelectedCombos(bool const looseMatchi
          if (combo)
             combo->setUseLooseMatching(looseMatching);
       this->updateGui();
-      QString errorMessage;
-      if (!ComboManager::instance().saveComboListToFile(&errorMessage))
-         throw xmilib::Exception(errorMessage);
+      ComboManager::instance().requestComboListSave();
    }
    catch (xmilib::Exception const& e)
    {
@@ -480,9 +474,7 @@ void ComboTableWidget::onActionNewCombo()
       ComboList& comboList = ComboManager::instance().comboListRef();
       if (!comboList.append(combo))
          throw xmilib::Exception(tr("The combo could not be added to the list."));
-      QString errorMessage;
-      if (!comboManager.saveComboListToFile(&errorMessage))
-         throw xmilib::Exception(errorMessage);
+      comboManager.requestComboListSave();
       this->selectCombo(combo);
       this->updateGui();
    }
@@ -514,9 +506,7 @@ void ComboTableWidget::onActionDuplicateCombo()
          return;
       if (!comboList.append(combo))
          throw xmilib::Exception(tr("The duplicated combo could not added to the list."));
-      QString errorMessage;
-      if (!comboManager.saveComboListToFile(&errorMessage))
-         throw xmilib::Exception(errorMessage);
+      comboManager.requestComboListSave();
       this->selectCombo(combo);
       this->updateGui();
    }
@@ -546,9 +536,7 @@ void ComboTableWidget::onActionDeleteCombo()
    std::sort(indexes.begin(), indexes.end(), [](qint32 first, qint32 second) -> bool { return first > second; });
    for (qint32 index: indexes)
       comboManager.comboListRef().erase(index);
-   QString errorMessage;
-   if (!comboManager.saveComboListToFile(&errorMessage))
-      QMessageBox::critical(this, tr("Error"), errorMessage);
+   comboManager.requestComboListSave();
    this->updateGui();
 }
 
@@ -570,9 +558,7 @@ void ComboTableWidget::onActionEditCombo()
    if (!ComboDialog::run(combo, tr("Edit Combo")))
       return;
    comboList.markComboAsEdited(index);
-   QString errorMessage;
-   if (!comboManager.saveComboListToFile(&errorMessage))
-      QMessageBox::critical(this, tr("Error"), errorMessage);
+   comboManager.requestComboListSave();
    proxyModel_.invalidate();
    this->selectCombo(combo);
    this->updateGui();
@@ -589,8 +575,8 @@ void ComboTableWidget::onActionCopySnippet() const
    if (!combo)
       return;
    bool cancelled = false;
-   QMap<QString, QString> knownInputVariables;
-   QString const text = combo->evaluatedSnippet(cancelled, QSet<QString>(), knownInputVariables, nullptr);
+   ComboEvaluationContext context;
+   QString const text = combo->evaluatedSnippet(cancelled, context, nullptr);
    if (!cancelled)
       QGuiApplication::clipboard()->setText(text);
 }
@@ -630,9 +616,7 @@ void ComboTableWidget::onActionEnableDisableCombo()
    SpCombo combo = comboList[index];
    combo->setEnabled(!combo->isEnabled());
    comboList.markComboAsEdited(index);
-   QString errorMessage;
-   if (!comboManager.saveComboListToFile(&errorMessage))
-      QMessageBox::critical(this, tr("Error"), errorMessage);
+   comboManager.requestComboListSave();
    this->updateGui();
 }
 
@@ -773,8 +757,7 @@ void ComboTableWidget::onDoubleClick()
 void ComboTableWidget::onComboChangedGroup()
 {
    proxyModel_.invalidate();
-   if (!ComboManager::instance().saveComboListToFile())
-      throw xmilib::Exception("Could not save combo list.");
+   ComboManager::instance().requestComboListSave();
    this->resizeColumnsToContents();
 }
 
@@ -6,10 +6,11 @@
 
 #include "stdafx.h"
 #include "ComboVariable.h"
+#include "ComboVariableRegistry.h"
 #include "ComboManager.h"
 #include "VariableInputDialog.h"
-#include "PreferencesManager.h"
-#include "Clipboard/ClipboardManager.h"
+#include "VariableInputFormDialog.h"
+#include "ScriptVariableExecutor.h"
 #include "BeeftextGlobals.h"
 #include <XMiLib/RandomNumberGenerator.h>
 #include <XMiLib/Exception.h>
@@ -30,6 +31,28 @@ QString const kCustomDateTimeVariable = "dateTime:"; ///< The dateTime variable.
 QString const kInputVariable = "input:"; ///< The input variable.
 QString const kEnvVarVariable = "envVar:"; ///< The envVar variable.
 QString const kPowershellVariable = "powershell:"; ///< The execute variable.
+QStringList const kComboVariables = { "combo:", "upper:", "lower:", "trim:" }; ///< The variables referencing a combo
+
+
+//**********************************************************************************************************************
+/// \brief A time shift of a #{dateTime:} variable, e.g. -4w
+//**********************************************************************************************************************
+struct TimeShift
+{
+   char unit { 0 }; ///< The unit of the shift: y, M, w, d, h, m, s or z
+   qint64 amount { 0 }; ///< The signed amount of the shift
+};
+
+
+//**********************************************************************************************************************
+/// \brief A #{dateTime:} variable, parsed when its snippet is compiled.
+//**********************************************************************************************************************
+struct DateTimeSpec
+{
+   bool isValid { false }; ///< Is the variable well formed
+   std::vector<TimeShift> shifts; ///< The shifts to apply to the current date/time
+   QString format; ///< The format. If empty, the default format of the system locale is used
+};
 
 
 //**********************************************************************************************************************
@@ -70,11 +93,12 @@ QString qcharToDiscordEmoji(QChar const& c)
 //**********************************************************************************************************************
 /// \brief Create a Discord emoji representation of the content of the clipboard
 ///
+/// \param[in,out] context The evaluation context
 /// \return A string containing the sequence of Discord emojis
 //**********************************************************************************************************************
-QString discordEmojisFromClipboard()
+QString discordEmojisFromClipboard(ComboEvaluationContext& context)
 {
-   QString str = ClipboardManager::instance().text();
+   QString const str = context.clipboardText();
    QString result;
    for (QChar const& c : str)
       result += qcharToDiscordEmoji(c);
@@ -83,56 +107,44 @@ QString discordEmojisFromClipboard()
 
 
 //**********************************************************************************************************************
-/// \brief Split a timeshift string (e.g. +1d-4w+11h), into individual shifts (e.g. { +1d, -4w, +11h)
+/// \brief Parse a timeshift string (e.g. +1d-4w+11h), into individual shifts (e.g. { +1d, -4w, +11h)
 ///
 /// \param[in] shiftStr The timeshift string
-/// \return a string list containing the individual shifts
+/// \return The individual shifts
 //**********************************************************************************************************************
-QStringList splitTimeShiftString(QString const& shiftStr)
+std::vector<TimeShift> parseTimeShiftString(QString const& shiftStr)
 {
-   QStringList result;
-   QString acc;
-   for (QChar const c : shiftStr)
+   std::vector<TimeShift> result;
+   QRegularExpressionMatchIterator it = QRegularExpression(R"(([+-])(\d+)([yMwdhmsz]))").globalMatch(shiftStr);
+   while (it.hasNext())
    {
-      if (('+' == c) || ('-' == c))
-      {
-         if (!acc.isEmpty())
-         {
-            result.append(acc);
-            acc = QString();
-         }
-      }
-      acc += c;
+      QRegularExpressionMatch const match = it.next();
+      bool ok = false;
+      qint64 const value = match.captured(2).toLongLong(&ok);
+      if (!ok)
+         continue;
+      TimeShift shift;
+      shift.unit = match.captured(3)[0].toLatin1();
+      shift.amount = (match.captured(1) == "-") ? -value : value;
+      result.push_back(shift);
    }
-   if (!acc.isEmpty())
-      result.append(acc);
    return result;
 }
 
 
 //**********************************************************************************************************************
-/// \brief Returns the current date shifted according to the instructions in the shift string.
-/// \param[in] shiftStr The string describing the timeshift (as defined in the dateTime: variable documentation.
-/// \return The current date shifted according to the instructions in the shift string.
+/// \brief Returns a date/time shifted according to a list of shifts.
+/// \param[in] dateTime The date/time
+/// \param[in] shifts The shifts
+/// \return The shifted date/time
 //**********************************************************************************************************************
-QDateTime shiftedDateTime(QString const& shiftStr)
+QDateTime shiftedDateTime(QDateTime const& dateTime, std::vector<TimeShift> const& shifts)
 {
-   QDateTime result = QDateTime::currentDateTime();
-
-   QStringList const shifts = splitTimeShiftString(shiftStr);
-   for (QString const& shift : shifts)
+   QDateTime result = dateTime;
+   for (TimeShift const& shift: shifts)
    {
-      QRegularExpressionMatch const match = QRegularExpression(R"(([+-])(\d+)([yMwdhmsz]))").match(shift);
-      if (!match.hasMatch())
-         continue;
-      bool ok = false;
-      qint64 value = match.captured(2).toLongLong(&ok);
-      if (!ok)
-         continue;
-      if (match.captured(1) == "-")
-         value = -value;
-      char const type = match.captured(3)[0].toLatin1();
-      switch (type)
+      qint64 const value = shift.amount;
+      switch (shift.unit)
       {
       case 'y': result = result.addYears(static_cast<qint32>(value)); break;
       case 'M': result = result.addMonths(static_cast<qint32>(value)); break;
@@ -150,23 +162,38 @@ QDateTime shiftedDateTime(QString const& shiftStr)
 
 
 //**********************************************************************************************************************
-/// \brief Evaluate a #[dateTime:} variable
+/// \brief Parse a #{dateTime:} variable.
 /// \param[in] variable The variable.
-/// \return the result of the evaluation.
+/// \return The parsed variable.
 //**********************************************************************************************************************
-QString evaluateDateTimeVariable(QString const& variable)
+DateTimeSpec parseDateTimeVariable(QString const& variable)
 {
-   QString const formatString = resolveEscapingInVariableParameter(variable.right(variable.size()
-      - kCustomDateTimeVariable.size()));
-
-   QRegularExpression const regExp(R"(^dateTime(:(([+-]\d+[yMwdhmsz])+))?:(.*)$)");
-   QRegularExpressionMatch const match = regExp.match(variable);
+   DateTimeSpec result;
+   QRegularExpressionMatch const match = QRegularExpression(R"(^dateTime(:(([+-]\d+[yMwdhmsz])+))?:(.*)$)")
+      .match(variable);
    if (!match.hasMatch())
+      return result;
+   result.isValid = true;
+   if (!match.captured(1).isEmpty())
+      result.shifts = parseTimeShiftString(match.captured(2));
+   result.format = match.captured(4);
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \brief Evaluate a parsed #[dateTime:} variable
+/// \param[in] spec The parsed variable.
+/// \param[in,out] context The evaluation context
+/// \return the result of the evaluation.
+//**********************************************************************************************************************
+QString evaluateDateTimeVariable(DateTimeSpec const& spec, ComboEvaluationContext& context)
+{
+   if (!spec.isValid)
       return QString();
-   QDateTime const dateTime = match.captured(1).isEmpty() ? QDateTime::currentDateTime() :
-      shiftedDateTime(match.captured(2));
-   QString const formatStr = match.captured(4);
-   return formatStr.isEmpty() ? QLocale::system().toString(dateTime) : QLocale::system().toString(dateTime, formatStr);
+   QDateTime const dateTime = shiftedDateTime(context.currentDateTime(), spec.shifts);
+   return spec.format.isEmpty() ? QLocale::system().toString(dateTime) : QLocale::system().toString(dateTime, 
+      spec.format);
 }
 
 
@@ -175,47 +202,54 @@ QString evaluateDateTimeVariable(QString const& variable)
 ///
 /// \param[in] variable The variable, without the enclosing #{}.
 /// \param[in] caseChange The change of case (uppercase, lowercase) to apply to the evaluated variable.
-/// \param[in] forbiddenSubCombos The text of the combos that are not allowed to be substituted using #{combo:}, to 
-/// avoid endless recursion.
-/// \param[in,out] knownInputVariables The list of know input variables.
+/// \param[in,out] context The evaluation context
 /// \param[out] outCancelled Was the input variable cancelled by the user.
 /// \return The result of evaluating the variable.
 //**********************************************************************************************************************
-QString evaluateComboVariable(QString const& variable, ECaseChange caseChange, QSet<QString> forbiddenSubCombos,
-   QMap<QString, QString>& knownInputVariables, bool& outCancelled)
+QString evaluateComboVariable(QString const& variable, ECaseChange caseChange, ComboEvaluationContext& context,
+   bool& outCancelled)
 {
-   QString fallbackResult = QString("#{%1}").arg(variable);
-   qint32 const varNameLength = variable.indexOf(':');
-   if (varNameLength < 0)
+   QString comboName;
+   if (!comboKeywordFromVariable(variable, &comboName))
       return QString();
-   QString const comboName = resolveEscapingInVariableParameter(variable.right(variable.size() - varNameLength - 1));
-   if (forbiddenSubCombos.contains(comboName))
-      return fallbackResult;
-
-   ComboList results;
-   for (SpCombo const& combo : ComboManager::instance().comboListRef())
-      if (combo->keyword() == comboName)
-         results.push_back(combo);
-
-   
-   qint32 const resultCount = results.size();
-   ComboList::const_iterator it;
-   switch (resultCount)
+   if (context.isForbiddenCombo(comboName))
+      return QString("#{%1}").arg(variable);
+
+   ComboManager& comboManager = ComboManager::instance();
+   ComboDependencyGraph& graph = comboManager.dependencyGraph();
+   QString str;
+   if (!graph.cachedExpansion(comboName, str))
    {
-   case 0:
-      return fallbackResult;
-   case 1:
-      it = results.begin();
-      break;
-   default:
+      VecSpCombo const results = comboManager.comboListRef().findAllByKeyword(comboName);
+      qint32 const resultCount = static_cast<qint32>(results.size());
+      VecSpCombo::const_iterator it;
+      switch (resultCount)
       {
-         xmilib::RandomNumberGenerator rng(0, results.size() - 1);
-         it = results.begin() + rng.get();
+      case 0:
+         return QString("#{%1}").arg(variable);
+      case 1:
+         it = results.begin();
          break;
+      default:
+         {
+            xmilib::RandomNumberGenerator rng(0, resultCount - 1);
+            it = results.begin() + rng.get();
+            break;
+         }
       }
+
+      // forbidden combos are intended at avoiding endless recursion, only combos that are part of a circular
+      // reference need to be forbidden.
+      bool const isCyclic = graph.isCyclic(comboName);
+      if (isCyclic)
+         context.addForbiddenCombo(comboName);
+      str = (*it)->evaluatedSnippet(outCancelled, context);
+      if (isCyclic)
+         context.removeForbiddenCombo(comboName);
+      if (outCancelled)
+         return QString();
+      graph.cacheExpansion(comboName, str);
    }
-   
-   QString str = (*it)->evaluatedSnippet(outCancelled, forbiddenSubCombos << comboName, knownInputVariables); // forbiddenSubcombos is intended at avoiding endless recursion
    switch (caseChange)
    {
    case ECaseChange::ToUpper: return str.toUpper();
@@ -231,39 +265,72 @@ QString evaluateComboVariable(QString const& variable, ECaseChange caseChange, Q
 /// \brief Evaluate an #{input:} variable.
 ///
 /// \param[in] variable The variable, without the enclosing #{}.
-/// \param[in,out] knownInputVariables The list of know input variables.
+/// \param[in,out] context The evaluation context
 /// \param[out] outCancelled Was the input variable cancelled by the user.
 /// \return The result of evaluating the variable.
 //**********************************************************************************************************************
-QString evaluateInputVariable(QString const& variable, QMap<QString, QString>& knownInputVariables, bool& outCancelled)
+QString evaluateInputVariable(QString const& variable, ComboEvaluationContext& context, bool& outCancelled)
 {
    // check if we already add the user input for the given description
    QString const description = variable.right(variable.size() - kInputVariable.size());
-   if (knownInputVariables.contains(description))
-      return knownInputVariables[description];
-
    QString result;
+   if (context.inputValue(description, result))
+      return result;
+
    if (!VariableInputDialog::run(resolveEscapingInVariableParameter(description), result))
    {
       outCancelled = true;
       return QString();
    }
-   knownInputVariables.insert(description, result); // add the new input to the list of known ones
+   context.setInputValue(description, result); // add the new input to the list of known ones
    return result;
 
 }
 
 
+//**********************************************************************************************************************
+/// \brief Collect the descriptions of the #{input:} variables of a snippet, and of the combos it references.
+///
+/// Combos referenced through a keyword shared by several combos are not followed, as the combo is picked randomly at
+/// evaluation time. Their input variables will be requested during the evaluation.
+///
+/// \param[in] snippetTemplate The compiled snippet
+/// \param[in,out] descriptions The descriptions collected so far, in order of evaluation
+/// \param[in,out] visitedKeywords The keywords whose combos have already been visited
+//**********************************************************************************************************************
+void collectInputDescriptions(ComboSnippetTemplate const& snippetTemplate, QStringList& descriptions,
+   QSet<QString>& visitedKeywords)
+{
+   for (QString const& variable: snippetTemplate.variables())
+   {
+      if (variable.startsWith(kInputVariable))
+      {
+         QString const description = variable.right(variable.size() - kInputVariable.size());
+         if (!descriptions.contains(description))
+            descriptions.append(description);
+         continue;
+      }
+      QString keyword;
+      if ((!comboKeywordFromVariable(variable, &keyword)) || visitedKeywords.contains(keyword))
+         continue;
+      visitedKeywords.insert(keyword);
+      VecSpCombo const combos = ComboManager::instance().comboListRef().findAllByKeyword(keyword);
+      if (1 == combos.size())
+         collectInputDescriptions(combos.front()->snippetTemplate(), descriptions, visitedKeywords);
+   }
+}
+
+
 //**********************************************************************************************************************
 /// \brief Evaluate an #{envvar:} variable.
 ///
 /// \param[in] variable The variable, without the enclosing #{}.
+/// \param[in,out] context The evaluation context
 /// \return The result of evaluating the variable.
 //**********************************************************************************************************************
-QString evaluateEnvVarVariable(QString const& variable)
+QString evaluateEnvVarVariable(QString const& variable, ComboEvaluationContext& context)
 {
-   return QProcessEnvironment::systemEnvironment().value(variable.right(variable.size() -
-      kEnvVarVariable.size()));
+   return context.environmentVariable(variable.right(variable.size() - kEnvVarVariable.size()));
 }
 
 
@@ -275,42 +342,7 @@ QString evaluateEnvVarVariable(QString const& variable)
 //**********************************************************************************************************************
 QString evaluatePowershellVariable(QString const& variable)
 {
-   try
-   {
-      QString const path = variable.right(variable.size() - kPowershellVariable.size());
-      if (!QFileInfo(path).exists())
-         throw xmilib::Exception(QString("the file `%1` does not exist.").arg(path));
-
-      PreferencesManager const& prefs = PreferencesManager::instance();
-      QString exePath = "powershell.exe";
-      if (prefs.useCustomPowershellVersion())
-      {
-         QString const customPath = prefs.customPowershellPath();
-         QFileInfo const  fi(customPath);
-         if (fi.exists() && fi.isExecutable())
-            exePath = customPath;
-         else 
-            globals::debugLog().addWarning(QString("The custom PowerShell executable '%1' is invalid or not "
-               "executable.").arg(QDir::toNativeSeparators(customPath)));
-      }
-
-      QProcess p;
-      qDebug() << QString("Powershell executable: '%1'").arg(exePath);
-      p.start(exePath, { "-NonInteractive", "-ExecutionPolicy", "Unrestricted", "-File", path });
-      if (!p.waitForFinished(10000)) ///< we timeout after 10 seconds
-         throw xmilib::Exception(QString("the script `%1` timed out.").arg(path));
-
-      qint32 const returnCode = p.exitCode();
-      if (returnCode)
-         throw xmilib::Exception(QString("execution of `%1` return an error (code %2).").arg(path).arg(returnCode));
-      return QString::fromUtf8(p.readAllStandardOutput());
-   }
-   catch (xmilib::Exception const& e)
-   {
-      globals::debugLog().addWarning(QString("Evaluation of #{%1} variable failed: %2").arg(kPowershellVariable)
-         .arg(e.qwhat()));
-      return QString();
-   }
+   return ScriptVariableExecutor::instance().evaluate(variable.right(variable.size() - kPowershellVariable.size()));
 }
 
 
@@ -319,62 +351,110 @@ QString evaluatePowershellVariable(QString const& variable)
 
 //**********************************************************************************************************************
 /// \param[in] variable The variable, without the enclosing #{}.
-/// \param[in] forbiddenSubCombos The text of the combos that are not allowed to be substituted using #{combo:}, to 
-/// avoid endless recursion.
-/// \param[in,out] knownInputVariables The list of know input variables.
+/// \param[in,out] context The evaluation context
 /// \param[out] outCancelled Was the input variable cancelled by the user.
 /// \return The result of evaluating the variable.
 //**********************************************************************************************************************
-QString evaluateVariable(QString const& variable, QSet<QString> const& forbiddenSubCombos, 
-   QMap<QString, QString>& knownInputVariables, bool& outCancelled)
+QString evaluateVariable(QString const& variable, ComboEvaluationContext& context, bool& outCancelled)
 {
    outCancelled = false;
-   QLocale const systemLocale = QLocale::system();
-   if (variable == "clipboard")
-      return ClipboardManager::instance().text();
-   
-   if (variable == "discordemoji") //secret variable that create text in Discord emoji from the clipboard text
-      return discordEmojisFromClipboard();
-
-   if (variable == "date")
-      return systemLocale.toString(QDate::currentDate());
-
-   if (variable == "time")
-      return systemLocale.toString(QTime::currentTime());
-
-   if (variable == "dateTime")
-      return systemLocale.toString(QDateTime::currentDateTime());
-
-   if (variable.startsWith(kCustomDateTimeVariable))
-      return evaluateDateTimeVariable(variable);
-
-   if (variable.startsWith("combo:"))
-      return evaluateComboVariable(variable, ECaseChange::NoChange, forbiddenSubCombos, knownInputVariables, 
-         outCancelled);
-
-   if (variable.startsWith("upper:"))
-      return evaluateComboVariable(variable, ECaseChange::ToUpper, forbiddenSubCombos, knownInputVariables, 
-         outCancelled);
+   return (*ComboVariableRegistry::instance().resolve(variable))(variable, context, outCancelled);
+}
 
-   if (variable.startsWith("lower:"))
-      return evaluateComboVariable(variable, ECaseChange::ToLower, forbiddenSubCombos, knownInputVariables, 
-         outCancelled);
 
-   if (variable.startsWith("trim:"))
+//**********************************************************************************************************************
+/// All the #{input:} variables that the expansion of the snippet will evaluate, including those of referenced combos,
+/// are requested in a single form before the evaluation starts. If there is only one, the usual input dialog is used.
+///
+/// \param[in] snippetTemplate The compiled snippet
+/// \param[in,out] context The evaluation context, that receives the values entered by the user
+/// \return false if and only if the user cancelled the input
+//**********************************************************************************************************************
+bool promptForInputVariables(ComboSnippetTemplate const& snippetTemplate, ComboEvaluationContext& context)
+{
+   QStringList descriptions;
+   QSet<QString> visitedKeywords;
+   collectInputDescriptions(snippetTemplate, descriptions, visitedKeywords);
+   QString value;
+   descriptions.erase(std::remove_if(descriptions.begin(), descriptions.end(), [&](QString const& description)
+      -> bool { return context.inputValue(description, value); }), descriptions.end());
+   if (descriptions.isEmpty())
+      return true;
+
+   QStringList labels;
+   for (QString const& description: descriptions)
+      labels.append(resolveEscapingInVariableParameter(description));
+   QStringList values;
+   context.setUserWasPrompted();
+   if (1 == descriptions.size())
    {
-      QString const var = evaluateComboVariable(variable, ECaseChange::NoChange, forbiddenSubCombos, 
-         knownInputVariables, outCancelled);
-      return var.trimmed();
+      if (!VariableInputDialog::run(labels.front(), value))
+         return false;
+      values.append(value);
    }
+   else if (!VariableInputFormDialog::run(labels, values))
+      return false;
+   for (qint32 i = 0; i < descriptions.size(); ++i)
+      context.setInputValue(descriptions[i], values.value(i));
+   return true;
+}
 
-   if (variable.startsWith(kInputVariable))
-      return evaluateInputVariable(variable, knownInputVariables, outCancelled);
 
-   if (variable.startsWith(kEnvVarVariable))
-      return evaluateEnvVarVariable(variable);
+//**********************************************************************************************************************
+/// \param[in] variable The variable, without the enclosing #{}.
+/// \param[out] outKeyword If not null and the function returns true, receives the keyword of the referenced combo.
+/// \return true if and only if the variable references a combo, e.g. #{combo:} or #{upper:}
+//**********************************************************************************************************************
+bool comboKeywordFromVariable(QString const& variable, QString* outKeyword)
+{
+   for (QString const& prefix: kComboVariables)
+      if (variable.startsWith(prefix))
+      {
+         if (outKeyword)
+            *outKeyword = resolveEscapingInVariableParameter(variable.right(variable.size() - prefix.size()));
+         return true;
+      }
+   return false;
+}
 
-   if (variable.startsWith(kPowershellVariable))
-      return evaluatePowershellVariable(variable);
 
-   return QString("#{%1}").arg(variable); // we could not recognize the variable, so we put it back in the result
+//**********************************************************************************************************************
+/// \param[in] registry The registry
+//**********************************************************************************************************************
+void registerBuiltInVariables(ComboVariableRegistry& registry)
+{
+   typedef ComboEvaluationContext& Context; // local shorthand for the parameter of evaluators
+
+   registry.registerVariable("clipboard", [](QString const&, Context context, bool&) -> QString
+      { return context.clipboardText(); });
+   //secret variable that create text in Discord emoji from the clipboard text
+   registry.registerVariable("discordemoji", [](QString const&, Context context, bool&) -> QString
+      { return discordEmojisFromClipboard(context); });
+   registry.registerVariable("date", [](QString const&, Context context, bool&) -> QString
+      { return QLocale::system().toString(context.currentDateTime().date()); });
+   registry.registerVariable("time", [](QString const&, Context context, bool&) -> QString
+      { return QLocale::system().toString(context.currentDateTime().time()); });
+   registry.registerVariable("dateTime", [](QString const&, Context context, bool&) -> QString
+      { return QLocale::system().toString(context.currentDateTime()); });
+   registry.registerVariablePrefixCompiler(kCustomDateTimeVariable, [](QString const& variable)
+      -> ComboVariableRegistry::Evaluator
+   {
+      DateTimeSpec const spec = parseDateTimeVariable(variable);
+      return [spec](QString const&, Context context, bool&) -> QString
+         { return evaluateDateTimeVariable(spec, context); };
+   });
+   registry.registerVariablePrefix("combo:", [](QString const& variable, Context context, bool& outCancelled)
+      -> QString { return evaluateComboVariable(variable, ECaseChange::NoChange, context, outCancelled); });
+   registry.registerVariablePrefix("upper:", [](QString const& variable, Context context, bool& outCancelled)
+      -> QString { return evaluateComboVariable(variable, ECaseChange::ToUpper, context, outCancelled); });
+   registry.registerVariablePrefix("lower:", [](QString const& variable, Context context, bool& outCancelled)
+      -> QString { return evaluateComboVariable(variable, ECaseChange::ToLower, context, outCancelled); });
+   registry.registerVariablePrefix("trim:", [](QString const& variable, Context context, bool& outCancelled)
+      -> QString { return evaluateComboVariable(variable, ECaseChange::NoChange, context, outCancelled).trimmed(); });
+   registry.registerVariablePrefix(kInputVariable, [](QString const& variable, Context context, bool& outCancelled)
+      -> QString { return evaluateInputVariable(variable, context, outCancelled); });
+   registry.registerVariablePrefix(kEnvVarVariable, [](QString const& variable, Context context, bool&)
+      -> QString { return evaluateEnvVarVariable(variable, context); });
+   registry.registerVariablePrefix(kPowershellVariable, [](QString const& variable, Context, bool&)
+      -> QString { return evaluatePowershellVariable(variable); });
 }
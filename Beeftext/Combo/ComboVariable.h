@@ -8,8 +8,15 @@
 #define BEEFTEXT_COMBO_VARIABLE_H
 
 
-QString evaluateVariable(QString const& variable, QSet<QString> const& forbiddenSubCombos, 
-   QMap<QString, QString>& knownInputVariables, bool& outCancelled); ///< Compute the value of a variable.
+class ComboEvaluationContext;
+class ComboSnippetTemplate;
+class ComboVariableRegistry;
+
+
+QString evaluateVariable(QString const& variable, ComboEvaluationContext& context, bool& outCancelled); ///< Compute the value of a variable.
+void registerBuiltInVariables(ComboVariableRegistry& registry); ///< Register the evaluators for the built-in variables
+bool comboKeywordFromVariable(QString const& variable, QString* outKeyword = nullptr); ///< Retrieve the keyword of the combo referenced by a variable
+bool promptForInputVariables(ComboSnippetTemplate const& snippetTemplate, ComboEvaluationContext& context); ///< Request the values of all the input variables of an expansion at once
 
 
 #endif // #ifndef BEEFTEXT_COMBO_VARIABLE_H
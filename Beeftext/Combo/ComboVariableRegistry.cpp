@@ -0,0 +1,171 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the registry of combo variable evaluators
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "ComboVariableRegistry.h"
+#include "ComboVariable.h"
+
+
+//**********************************************************************************************************************
+/// \return A reference to the only allowed instance of the class
+//**********************************************************************************************************************
+ComboVariableRegistry& ComboVariableRegistry::instance()
+{
+   static ComboVariableRegistry instance;
+   return instance;
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+ComboVariableRegistry::ComboVariableRegistry()
+   : fallback_(std::make_shared<Evaluator const>([](QString const& variable, ComboEvaluationContext&, bool&)
+      -> QString { return QString("#{%1}").arg(variable); }))
+{
+   deterministicEvaluators_.insert(fallback_.get());
+   registerBuiltInVariables(*this);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] name The name of the variable
+/// \param[in] evaluator The evaluator
+/// \param[in] isDeterministic Does the evaluator always return the same value for a given variable
+//**********************************************************************************************************************
+void ComboVariableRegistry::registerVariable(QString const& name, Evaluator const& evaluator, bool isDeterministic)
+{
+   QWriteLocker locker(&lock_);
+   SpEvaluator const spEvaluator = std::make_shared<Evaluator const>(evaluator);
+   this->setDeterministic(spEvaluator, names_.value(name), isDeterministic);
+   names_.insert(name, spEvaluator);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] prefix The prefix of the variable
+/// \param[in] evaluator The evaluator
+/// \param[in] isDeterministic Does the evaluator always return the same value for a given variable
+//**********************************************************************************************************************
+void ComboVariableRegistry::registerVariablePrefix(QString const& prefix, Evaluator const& evaluator,
+   bool isDeterministic)
+{
+   this->registerPrefixEntry(prefix, evaluator, Compiler(), isDeterministic);
+}
+
+
+//**********************************************************************************************************************
+/// The compiler is called when a snippet containing a matching variable is compiled. It receives the variable and
+/// returns the evaluator that will be used for it.
+///
+/// \param[in] prefix The prefix of the variable
+/// \param[in] compiler The compiler
+/// \param[in] isDeterministic Do the compiled evaluators always return the same value for a given variable
+//**********************************************************************************************************************
+void ComboVariableRegistry::registerVariablePrefixCompiler(QString const& prefix, Compiler const& compiler,
+   bool isDeterministic)
+{
+   this->registerPrefixEntry(prefix, [compiler](QString const& variable, ComboEvaluationContext& context,
+      bool& outCancelled) -> QString { return compiler(variable)(variable, context, outCancelled); }, compiler, 
+      isDeterministic);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] variable The variable, without the enclosing #{}
+/// \return The evaluator for the variable. If the variable cannot be resolved, an evaluator returning the variable
+/// itself is returned. The returned value is never null.
+//**********************************************************************************************************************
+ComboVariableRegistry::SpEvaluator ComboVariableRegistry::resolve(QString const& variable) const
+{
+   Compiler compiler;
+   SpEvaluator const result = this->find(variable, &compiler);
+   return compiler ? std::make_shared<Evaluator const>(compiler(variable)) : result; // compilers are called unlocked
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] variable The variable, without the enclosing #{}
+/// \return true if and only if the evaluator of the variable was registered as deterministic, or if the variable
+/// cannot be resolved
+//**********************************************************************************************************************
+bool ComboVariableRegistry::isDeterministic(QString const& variable) const
+{
+   SpEvaluator const evaluator = this->find(variable);
+   QReadLocker locker(&lock_);
+   return deterministicEvaluators_.contains(evaluator.get());
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] prefix The prefix of the variable
+/// \param[in] evaluator The evaluator
+/// \param[in] compiler The compiler. May be empty
+/// \param[in] isDeterministic Does the evaluator always return the same value for a given variable
+//**********************************************************************************************************************
+void ComboVariableRegistry::registerPrefixEntry(QString const& prefix, Evaluator const& evaluator,
+   Compiler const& compiler, bool isDeterministic)
+{
+   QWriteLocker locker(&lock_);
+   SpEvaluator const spEvaluator = std::make_shared<Evaluator const>(evaluator);
+   for (PrefixEntry& entry: prefixes_)
+      if (entry.prefix == prefix)
+      {
+         this->setDeterministic(spEvaluator, entry.evaluator, isDeterministic);
+         entry.evaluator = spEvaluator;
+         entry.compiler = compiler;
+         return;
+      }
+   this->setDeterministic(spEvaluator, SpEvaluator(), isDeterministic);
+   prefixes_.push_back({ prefix, spEvaluator, compiler });
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] variable The variable, without the enclosing #{}
+/// \param[out] outCompiler If not null, receives the compiler registered for the variable, or an empty compiler
+/// \return The registered evaluator for the variable, or the fallback evaluator if it cannot be resolved
+//**********************************************************************************************************************
+ComboVariableRegistry::SpEvaluator ComboVariableRegistry::find(QString const& variable, Compiler* outCompiler) const
+{
+   QReadLocker locker(&lock_);
+   if (outCompiler)
+      *outCompiler = Compiler();
+   QHash<QString, SpEvaluator>::const_iterator const it = names_.constFind(variable);
+   if (it != names_.constEnd())
+      return it.value();
+   SpEvaluator result = fallback_;
+   qint32 longestPrefix = -1;
+   for (PrefixEntry const& entry: prefixes_)
+      if ((entry.prefix.size() > longestPrefix) && variable.startsWith(entry.prefix))
+      {
+         longestPrefix = entry.prefix.size();
+         result = entry.evaluator;
+         if (outCompiler)
+            *outCompiler = entry.compiler;
+      }
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// The lock must be held for writing when calling this function.
+///
+/// \param[in] evaluator The evaluator being registered
+/// \param[in] replaced The evaluator being replaced, if any
+/// \param[in] isDeterministic Is the evaluator being registered deterministic
+//**********************************************************************************************************************
+void ComboVariableRegistry::setDeterministic(SpEvaluator const& evaluator, SpEvaluator const& replaced,
+   bool isDeterministic)
+{
+   if (replaced)
+      deterministicEvaluators_.remove(replaced.get());
+   if (isDeterministic)
+      deterministicEvaluators_.insert(evaluator.get());
+}
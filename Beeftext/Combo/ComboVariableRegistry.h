@@ -0,0 +1,90 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of the registry of combo variable evaluators
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_COMBO_VARIABLE_REGISTRY_H
+#define BEEFTEXT_COMBO_VARIABLE_REGISTRY_H
+
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+
+class ComboEvaluationContext;
+
+
+//**********************************************************************************************************************
+/// \brief The registry mapping variable names and prefixes to the functions evaluating them.
+///
+/// A variable is resolved once, when its snippet is compiled (see ComboSnippetTemplate). Names are matched exactly
+/// (e.g. 'clipboard'). Prefixes (e.g. 'combo:') match any variable starting with them, the longest prefix taking
+/// precedence. Evaluators receive the whole variable, without the enclosing #{}. Variables that cannot be resolved
+/// are evaluated to themselves.
+///
+/// An evaluator is registered as deterministic if its result only depends on the variable, so that expansions using
+/// it can be cached (see ComboDependencyGraph).
+///
+/// A prefix can also be registered with a compiler, that parses the variable once when the snippet is compiled and
+/// returns an evaluator specialized for it.
+///
+/// Registering a name or prefix that is already registered replaces its evaluator. Snippets compiled before the
+/// registration keep the previous evaluator, so new variable kinds should be registered at startup, before the combo
+/// list is loaded.
+//**********************************************************************************************************************
+class ComboVariableRegistry
+{
+public: // data types
+   typedef std::function<QString(QString const& variable, ComboEvaluationContext& context, bool& outCancelled)>
+      Evaluator; ///< Type definition for variable evaluators
+   typedef std::function<Evaluator(QString const& variable)> Compiler; ///< Type definition for variable compilers
+   typedef std::shared_ptr<Evaluator const> SpEvaluator; ///< Type definition for shared pointer to variable evaluators
+
+public: // static member functions
+   static ComboVariableRegistry& instance(); ///< Return the only allowed instance of the class
+
+public: // member functions
+   ComboVariableRegistry(ComboVariableRegistry const&) = delete; ///< Disabled copy-constructor
+   ComboVariableRegistry(ComboVariableRegistry&&) = delete; ///< Disabled assignment copy-constructor
+   ~ComboVariableRegistry() = default; ///< Destructor
+   ComboVariableRegistry& operator=(ComboVariableRegistry const&) = delete; ///< Disabled assignment operator
+   ComboVariableRegistry& operator=(ComboVariableRegistry&&) = delete; ///< Disabled move assignment operator
+   void registerVariable(QString const& name, Evaluator const& evaluator, 
+      bool isDeterministic = false); ///< Register the evaluator for a variable name
+   void registerVariablePrefix(QString const& prefix, Evaluator const& evaluator,
+      bool isDeterministic = false); ///< Register the evaluator for a variable prefix
+   void registerVariablePrefixCompiler(QString const& prefix, Compiler const& compiler,
+      bool isDeterministic = false); ///< Register the compiler for a variable prefix
+   SpEvaluator resolve(QString const& variable) const; ///< Retrieve the evaluator for a variable
+   bool isDeterministic(QString const& variable) const; ///< Check whether a variable always evaluates to the same value
+
+private: // data types
+   struct PrefixEntry
+   {
+      QString prefix; ///< The prefix
+      SpEvaluator evaluator; ///< The evaluator
+      Compiler compiler; ///< The compiler, if any
+   }; ///< A registered variable prefix
+
+private: // member functions
+   ComboVariableRegistry(); ///< Default constructor
+   void registerPrefixEntry(QString const& prefix, Evaluator const& evaluator, Compiler const& compiler,
+      bool isDeterministic); ///< Register an entry for a variable prefix
+   SpEvaluator find(QString const& variable, Compiler* outCompiler = nullptr) const; ///< Find the registered evaluator for a variable
+   void setDeterministic(SpEvaluator const& evaluator, SpEvaluator const& replaced, bool isDeterministic); ///< Update the set of deterministic evaluators
+
+private: // data members
+   mutable QReadWriteLock lock_; ///< The lock protecting the registry, as snippets may be compiled on worker threads
+   QHash<QString, SpEvaluator> names_; ///< The evaluators for variable names
+   std::vector<PrefixEntry> prefixes_; ///< The evaluators for variable prefixes
+   SpEvaluator fallback_; ///< The evaluator for variables that cannot be resolved
+   QSet<Evaluator const*> deterministicEvaluators_; ///< The evaluators that were registered as deterministic
+};
+
+
+#endif // #ifndef BEEFTEXT_COMBO_VARIABLE_REGISTRY_H
@@ -0,0 +1,227 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the keystroke trace replay benchmark
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "KeystrokeTraceBenchmark.h"
+#include "ComboManager.h"
+#include "KeystrokeTrace.h"
+#include "InputManager.h"
+#include "PreferencesManager.h"
+#include "AllocationCounter.h"
+#include "InputBackend/InputBackendHeadless.h"
+#include <algorithm>
+
+
+namespace {
+
+
+//**********************************************************************************************************************
+/// \param[in] kind The kind of event
+/// \return The character used to replay events of the given kind
+//**********************************************************************************************************************
+QChar fillerCharacter(EKeystrokeTraceEventKind kind)
+{
+   switch (kind)
+   {
+   case EKeystrokeTraceEventKind::Letter: return 'x';
+   case EKeystrokeTraceEventKind::Digit: return '0';
+   case EKeystrokeTraceEventKind::Space: return ' ';
+   case EKeystrokeTraceEventKind::Symbol:
+   default:
+      return '.';
+   }
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] kind The kind of event
+/// \return true if and only if the event kind corresponds to a typed character
+//**********************************************************************************************************************
+bool isCharacterEvent(EKeystrokeTraceEventKind kind)
+{
+   switch (kind)
+   {
+   case EKeystrokeTraceEventKind::Letter:
+   case EKeystrokeTraceEventKind::Digit:
+   case EKeystrokeTraceEventKind::Symbol:
+   case EKeystrokeTraceEventKind::Space:
+      return true;
+   default:
+      return false;
+   }
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] kind The kind of event
+/// \return The type of the key event pushed to the input manager when replaying an event of the given kind
+//**********************************************************************************************************************
+InputManager::EKeyEventType keyEventType(EKeystrokeTraceEventKind kind)
+{
+   switch (kind)
+   {
+   case EKeystrokeTraceEventKind::Backspace: return InputManager::EKeyEventType::Backspace;
+   case EKeystrokeTraceEventKind::ComboBreaker: return InputManager::EKeyEventType::ComboBreaker;
+   default: return InputManager::EKeyEventType::Character;
+   }
+}
+
+
+//**********************************************************************************************************************
+/// \brief A replayed event
+//**********************************************************************************************************************
+struct ReplayEvent
+{
+   EKeystrokeTraceEventKind kind; ///< The kind of event
+   QChar character; ///< For character events, the character
+   quint32 delayUs; ///< The delay since the previous event, in microseconds
+};
+
+
+//**********************************************************************************************************************
+/// \brief Convert a trace into a list of replayable events.
+///
+/// Traces are anonymized, so characters are replaced by fillers. Before each match marker, the characters that
+/// triggered the combo are replaced by the keyword of a combo of the list with the same length, if any.
+///
+/// \param[in] trace The trace
+/// \param[in] comboList The combo list
+/// \param[in] triggersOnSpace Are combos triggered by a space
+/// \return The replay events
+//**********************************************************************************************************************
+QVector<ReplayEvent> replayEvents(KeystrokeTrace const& trace, ComboList const& comboList, bool triggersOnSpace)
+{
+   QHash<qint32, QString> keywordForLength;
+   for (SpCombo const& combo: comboList)
+   {
+      QString const keyword = combo->keyword();
+      if (combo->isEnabled() && (!keywordForLength.contains(keyword.size())))
+         keywordForLength.insert(keyword.size(), keyword);
+   }
+
+   QVector<ReplayEvent> result;
+   result.reserve(trace.size());
+   quint32 pendingDelayUs = 0; // the delay of match markers is carried to the next replayed event
+   for (KeystrokeTraceEvent const& event: trace)
+   {
+      if (EKeystrokeTraceEventKind::Match != event.kind)
+      {
+         result.append({ event.kind, fillerCharacter(event.kind), pendingDelayUs + event.delayUs });
+         pendingDelayUs = 0;
+         continue;
+      }
+      pendingDelayUs += event.delayUs;
+      QString const keyword = keywordForLength.value(event.keywordLength);
+      qint32 index = result.size() - 1;
+      if (triggersOnSpace && (index >= 0) && (EKeystrokeTraceEventKind::Space == result[index].kind))
+         --index;
+      if (keyword.isEmpty() || (index + 1 < keyword.size()))
+         continue;
+      bool const isTyped = std::all_of(result.begin() + (index + 1 - keyword.size()), result.begin() + (index + 1),
+         [](ReplayEvent const& e) -> bool { return isCharacterEvent(e.kind); });
+      if (!isTyped)
+         continue;
+      for (qint32 i = 0; i < keyword.size(); ++i)
+         result[index + 1 - keyword.size() + i].character = keyword[i];
+   }
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] sortedValues The values, sorted in increasing order
+/// \param[in] percentile The percentile, between 0 and 100
+/// \return The value for the percentile, in microseconds
+//**********************************************************************************************************************
+double percentileUs(std::vector<qint64> const& sortedValues, double percentile)
+{
+   if (sortedValues.empty())
+      return 0.0;
+   size_t const index = qMin(sortedValues.size() - 1, static_cast<size_t>(percentile * 0.01 * sortedValues.size()));
+   return static_cast<double>(sortedValues[index]) / 1000.0;
+}
+
+
+} // anonymous namespace
+
+
+//**********************************************************************************************************************
+/// The key events of the trace are pushed to the input manager and processed by the combo manager, as they would be
+/// when produced by the keyboard hook, so the whole substitution pipeline is timed. The caller must have selected the
+/// headless input backend before the creation of the input manager, and the data folder must be a sandbox, as the
+/// combo list file is copied to it to be loaded by the combo manager. The key events are processed in the calling
+/// thread, and only the allocations performed by this thread are counted (see AllocationCounter).
+///
+/// \param[in] tracePath The path of the keystroke trace file
+/// \param[in] comboListPath The path of the combo list file
+/// \param[in] realTime If true, the delays between events recorded in the trace are respected. Otherwise the trace
+/// is replayed at full speed
+/// \return A human readable report of the benchmark
+//**********************************************************************************************************************
+QString benchmarkKeystrokeTraceReplay(QString const& tracePath, QString const& comboListPath, bool realTime)
+{
+   InputBackend& backend = InputBackend::instance();
+   if (InputBackend::EType::Headless != backend.type())
+      return "The keystroke trace replay benchmark requires the headless input backend.";
+   InputBackendHeadless& headlessBackend = static_cast<InputBackendHeadless&>(backend);
+   QString errorMsg;
+   KeystrokeTrace trace;
+   if (!loadKeystrokeTrace(tracePath, trace, &errorMsg))
+      return errorMsg;
+   ComboList comboList;
+   if (!comboList.load(comboListPath, nullptr, &errorMsg)) // we check the file here, so the error is reported
+      return errorMsg;
+   PreferencesManager& prefs = PreferencesManager::instance();
+   QString const destPath = ComboList::filePathInFolder(prefs.comboListFolderPath(),
+      0 == QFileInfo(comboListPath).suffix().compare("cbor", Qt::CaseInsensitive));
+   QFile::remove(destPath);
+   if (!QFile::copy(comboListPath, destPath))
+      return QString("Could not copy the combo list file to '%1'.").arg(QDir::toNativeSeparators(destPath));
+   prefs.setPlaySoundOnCombo(false);
+   qint32 const recordedMatchCount = static_cast<qint32>(std::count_if(trace.begin(), trace.end(),
+      [](KeystrokeTraceEvent const& e) -> bool { return EKeystrokeTraceEventKind::Match == e.kind; }));
+
+   ComboManager& comboManager = ComboManager::instance(); // loads the combo list copied to the data folder
+   InputManager& inputManager = InputManager::instance();
+   QVector<ReplayEvent> const events = replayEvents(trace, comboManager.comboListRef(), 
+      prefs.useAutomaticSubstitution() && prefs.comboTriggersOnSpace());
+   QCoreApplication::processEvents(); // the combo manager drains the events queued before its creation
+   headlessBackend.reset();
+   std::vector<qint64> latenciesNs;
+   latenciesNs.reserve(static_cast<size_t>(events.size()));
+
+   qint64 allocations = 0;
+   QElapsedTimer timer;
+   for (ReplayEvent const& event: events)
+   {
+      if (realTime && event.delayUs)
+         QThread::usleep(event.delayUs);
+      AllocationCounter const counter;
+      timer.start();
+      inputManager.pushKeyEvent(keyEventType(event.kind), event.character);
+      QCoreApplication::sendPostedEvents(&comboManager, QEvent::MetaCall); // delivers the queued notification
+      qint64 const latencyNs = timer.nsecsElapsed();
+      allocations += counter.count();
+      latenciesNs.push_back(latencyNs);
+   }
+
+   std::sort(latenciesNs.begin(), latenciesNs.end());
+   QStringList lines = { QString("Keystroke trace replay benchmark (%1)").arg(realTime ? "real time" : "full speed"),
+      QString(), QString("Trace: %1 key events, %2 recorded matches").arg(events.size()).arg(recordedMatchCount),
+      QString("Combo list: %1 combos").arg(comboManager.comboListRef().size()),
+      QString("Replayed substitutions: %1").arg(headlessBackend.injectionCount()),
+      QString("Dropped key events: %1").arg(inputManager.droppedKeyEventCount()),
+      QString("Per-event latency: p50 %1 us, p95 %2 us, p99 %3 us, max %4 us")
+      .arg(percentileUs(latenciesNs, 50.0), 0, 'f', 2).arg(percentileUs(latenciesNs, 95.0), 0, 'f', 2)
+      .arg(percentileUs(latenciesNs, 99.0), 0, 'f', 2)
+      .arg(latenciesNs.empty() ? 0.0 : static_cast<double>(latenciesNs.back()) / 1000.0, 0, 'f', 2) };
+   lines.append(QString("Heap allocations: %1 (%2 per event)").arg(allocations)
+      .arg(events.isEmpty() ? 0.0 : static_cast<double>(allocations) / events.size(), 0, 'f', 3));
+   return lines.join("\n");
+}
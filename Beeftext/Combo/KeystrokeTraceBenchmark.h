@@ -0,0 +1,17 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of the keystroke trace replay benchmark
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_KEYSTROKE_TRACE_BENCHMARK_H
+#define BEEFTEXT_KEYSTROKE_TRACE_BENCHMARK_H
+
+
+QString benchmarkKeystrokeTraceReplay(QString const& tracePath, QString const& comboListPath, bool realTime); ///< Replay a keystroke trace against a combo list
+
+
+#endif // #ifndef BEEFTEXT_KEYSTROKE_TRACE_BENCHMARK_H
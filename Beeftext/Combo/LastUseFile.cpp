@@ -40,7 +40,7 @@ void parseDateTimeObject(ComboList& comboList, QJsonObject const& object)
    QUuid const uuid = QUuid::fromString(object[kPropUuid].toString(QString()));
    if (uuid.isNull())
       return;
-   ComboList::iterator const it = comboList.findByUuid(uuid);
+   ComboList::const_iterator const it = comboList.findByUuid(uuid);
    if (it == comboList.end())
       return;
    SpCombo const combo = *it;
@@ -0,0 +1,256 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the executor for script variables
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "ScriptVariableExecutor.h"
+#include "PreferencesManager.h"
+#include "BeeftextGlobals.h"
+#include <XMiLib/Exception.h>
+
+
+using namespace xmilib;
+
+
+namespace {
+
+
+qint32 const kMaxThreadCount = 4; ///< The maximum number of scripts running simultaneously
+qint32 const kScriptTimeoutMs = 10000; ///< The time after which a script is killed
+qint32 const kPrewarmIntervalMs = 5000; ///< The interval between two checks of the results to refresh
+qint32 const kPrewarmScriptCount = 5; ///< The maximum number of scripts whose results are kept warm
+qint32 const kPrewarmMinUseCount = 3; ///< The number of uses after which a script is considered for pre-warming
+
+
+//**********************************************************************************************************************
+/// \brief Run a script. This function is called on a worker thread.
+///
+/// \param[in] interpreter The path of the interpreter
+/// \param[in] arguments The arguments passed to the interpreter, including the script path
+/// \return The result of the run
+//**********************************************************************************************************************
+ScriptVariableExecutor::RunResult runScript(QString const& interpreter, QStringList const& arguments)
+{
+   ScriptVariableExecutor::RunResult result;
+   QString const path = arguments.isEmpty() ? QString() : arguments.back();
+   try
+   {
+      QProcess p;
+      p.start(interpreter, arguments);
+      if (!p.waitForFinished(kScriptTimeoutMs))
+      {
+         p.kill();
+         p.waitForFinished();
+         throw Exception(QString("the script `%1` timed out.").arg(path));
+      }
+      qint32 const returnCode = p.exitCode();
+      if (returnCode)
+         throw Exception(QString("execution of `%1` return an error (code %2).").arg(path).arg(returnCode));
+      result.output = QString::fromUtf8(p.readAllStandardOutput());
+      result.success = true;
+   }
+   catch (Exception const& e)
+   {
+      result.errorMessage = e.qwhat();
+   }
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \return The path of the script interpreter
+//**********************************************************************************************************************
+QString interpreterPath()
+{
+   PreferencesManager const& prefs = PreferencesManager::instance();
+   if (!prefs.useCustomPowershellVersion())
+      return "powershell.exe";
+   QString const customPath = prefs.customPowershellPath();
+   QFileInfo const fi(customPath);
+   if (fi.exists() && fi.isExecutable())
+      return customPath;
+   globals::debugLog().addWarning(QString("The custom PowerShell executable '%1' is invalid or not "
+      "executable.").arg(QDir::toNativeSeparators(customPath)));
+   return "powershell.exe";
+}
+
+
+} // anonymous namespace
+
+
+//**********************************************************************************************************************
+/// \return A reference to the only allowed instance of the class
+//**********************************************************************************************************************
+ScriptVariableExecutor& ScriptVariableExecutor::instance()
+{
+   static ScriptVariableExecutor instance;
+   return instance;
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+ScriptVariableExecutor::ScriptVariableExecutor()
+   : QObject(nullptr)
+{
+   pool_.setMaxThreadCount(kMaxThreadCount);
+   prewarmTimer_.setInterval(kPrewarmIntervalMs);
+   connect(&prewarmTimer_, &QTimer::timeout, this, &ScriptVariableExecutor::onPrewarmTimerTimeout);
+   prewarmTimer_.start();
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+ScriptVariableExecutor::~ScriptVariableExecutor()
+{
+   pool_.waitForDone();
+}
+
+
+//**********************************************************************************************************************
+/// If the result is not cached, the function waits for the script in a nested event loop. Resuming the substitution
+/// asynchronously would require the whole snippet evaluation to be resumable, so the wait is deliberate.
+///
+/// \param[in] scriptPath The path of the script
+/// \return The output of the script
+/// \return An empty string if the script failed, or if it does not exist
+//**********************************************************************************************************************
+QString ScriptVariableExecutor::evaluate(QString const& scriptPath)
+{
+   QFileInfo const fileInfo(scriptPath);
+   if (!fileInfo.exists())
+   {
+      globals::debugLog().addWarning(QString("Evaluation of #{powershell:} variable failed: the file `%1` does not "
+         "exist.").arg(scriptPath));
+      return QString();
+   }
+   ++useCounts_[scriptPath];
+   qint64 const modificationDateTime = fileInfo.lastModified().toMSecsSinceEpoch();
+   qint64 const cacheDurationMs = 1000LL * PreferencesManager::instance().scriptVariableCacheDurationSeconds();
+   QHash<QString, CacheEntry>::const_iterator const it = cache_.constFind(scriptPath);
+   if ((cacheDurationMs > 0) && (it != cache_.constEnd()) && (it->modificationDateTime == modificationDateTime) &&
+      (QDateTime::currentMSecsSinceEpoch() - it->timestamp < cacheDurationMs))
+      return it->output;
+
+   QFuture<RunResult> const future = this->startRun(scriptPath, modificationDateTime);
+   if (!future.isFinished())
+   {
+      // we keep processing events, so the keyboard hook stays responsive. ComboManager ignores the keystrokes
+      // processed while a substitution is in progress, so they cannot trigger a recursive substitution.
+      QEventLoop loop;
+      QFutureWatcher<RunResult> watcher;
+      connect(&watcher, &QFutureWatcherBase::finished, &loop, &QEventLoop::quit);
+      watcher.setFuture(future);
+      if (!future.isFinished())
+         loop.exec(QEventLoop::ExcludeUserInputEvents);
+   }
+   this->storeResult(scriptPath, modificationDateTime, future);
+   RunResult const result = future.result();
+   if (!result.success)
+      globals::debugLog().addWarning(QString("Evaluation of #{powershell:} variable failed: %1")
+         .arg(result.errorMessage));
+   return result.output;
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void ScriptVariableExecutor::clearCache()
+{
+   cache_.clear();
+}
+
+
+//**********************************************************************************************************************
+/// If the script is already running, for instance to pre-warm its result, the run in progress is returned.
+///
+/// \param[in] scriptPath The path of the script
+/// \param[in] modificationDateTime The modification date/time of the script, in ms since epoch
+/// \return The future for the run
+//**********************************************************************************************************************
+QFuture<ScriptVariableExecutor::RunResult> ScriptVariableExecutor::startRun(QString const& scriptPath,
+   qint64 modificationDateTime)
+{
+   QHash<QString, QFuture<RunResult>>::const_iterator const it = pendingRuns_.constFind(scriptPath);
+   if (it != pendingRuns_.constEnd())
+      return it.value();
+
+   QStringList arguments = PreferencesManager::instance().scriptInterpreterArguments().split(QRegularExpression("\\s"),
+      Qt::SkipEmptyParts);
+   arguments.append(scriptPath);
+   QFuture<RunResult> const future = QtConcurrent::run(&pool_, runScript, interpreterPath(), arguments);
+   pendingRuns_.insert(scriptPath, future);
+   QFutureWatcher<RunResult>* watcher = new QFutureWatcher<RunResult>(this);
+   connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, scriptPath, modificationDateTime]()
+   {
+      this->storeResult(scriptPath, modificationDateTime, watcher->future());
+      watcher->deleteLater();
+   });
+   watcher->setFuture(future);
+   return future;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] scriptPath The path of the script
+/// \param[in] modificationDateTime The modification date/time of the script, in ms since epoch
+/// \param[in] future The future of the run, that must be finished
+//**********************************************************************************************************************
+void ScriptVariableExecutor::storeResult(QString const& scriptPath, qint64 modificationDateTime,
+   QFuture<RunResult> const& future)
+{
+   if (pendingRuns_.value(scriptPath) != future)
+      return; // the result was already stored
+   pendingRuns_.remove(scriptPath);
+   RunResult const result = future.result();
+   if (!result.success)
+      return;
+   CacheEntry entry;
+   entry.modificationDateTime = modificationDateTime;
+   entry.timestamp = QDateTime::currentMSecsSinceEpoch();
+   entry.output = result.output;
+   cache_.insert(scriptPath, entry);
+}
+
+
+//**********************************************************************************************************************
+/// The results of the most frequently used scripts are refreshed when they are about to expire.
+//**********************************************************************************************************************
+void ScriptVariableExecutor::onPrewarmTimerTimeout()
+{
+   PreferencesManager const& prefs = PreferencesManager::instance();
+   qint64 const cacheDurationMs = 1000LL * prefs.scriptVariableCacheDurationSeconds();
+   if ((!prefs.prewarmScriptVariables()) || (cacheDurationMs <= 0))
+      return;
+
+   QList<QPair<qint32, QString>> candidates;
+   for (QHash<QString, qint32>::const_iterator it = useCounts_.constBegin(); it != useCounts_.constEnd(); ++it)
+      if (it.value() >= kPrewarmMinUseCount)
+         candidates.append({ it.value(), it.key() });
+   std::sort(candidates.begin(), candidates.end(), [](QPair<qint32, QString> const& lhs,
+      QPair<qint32, QString> const& rhs) -> bool { return lhs.first > rhs.first; });
+
+   qint64 const now = QDateTime::currentMSecsSinceEpoch();
+   for (qint32 i = 0; i < qMin<qint32>(kPrewarmScriptCount, candidates.size()); ++i)
+   {
+      QString const& path = candidates[i].second;
+      QFileInfo const fileInfo(path);
+      if ((!fileInfo.exists()) || pendingRuns_.contains(path))
+         continue;
+      qint64 const modificationDateTime = fileInfo.lastModified().toMSecsSinceEpoch();
+      QHash<QString, CacheEntry>::const_iterator const it = cache_.constFind(path);
+      if ((it != cache_.constEnd()) && (it->modificationDateTime == modificationDateTime) &&
+         (now - it->timestamp < cacheDurationMs - 2 * kPrewarmIntervalMs))
+         continue; // the result will still be valid at the next check
+      this->startRun(path, modificationDateTime);
+   }
+}
@@ -0,0 +1,73 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of the executor for script variables
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_SCRIPT_VARIABLE_EXECUTOR_H
+#define BEEFTEXT_SCRIPT_VARIABLE_EXECUTOR_H
+
+
+//**********************************************************************************************************************
+/// \brief A class running the scripts of #{powershell:} variables.
+///
+/// Scripts are run by the interpreter set in the preferences, on a pool of worker threads. The evaluation of snippets
+/// is synchronous and recursive, so evaluate() does not return before the script finishes: it waits in a nested event
+/// loop, so the GUI thread keeps processing events and the keyboard hook stays installed and responsive. The key
+/// events received meanwhile are not matched (see ComboManager::onKeyEventsAvailable()). To keep this wait off the
+/// substitution path, results can be cached for a duration set in the preferences, keyed by the script path and
+/// modification date/time, and when pre-warming is enabled, the results of the most frequently used scripts are
+/// refreshed in the background before they expire.
+//**********************************************************************************************************************
+class ScriptVariableExecutor: public QObject
+{
+   Q_OBJECT
+public: // data types
+   struct RunResult
+   {
+      bool success { false }; ///< Did the script run successfully
+      QString output; ///< The standard output of the script
+      QString errorMessage; ///< The error message if the script failed
+   }; ///< The result of the execution of a script
+
+public: // static member functions
+   static ScriptVariableExecutor& instance(); ///< Return the only allowed instance of the class
+
+public: // member functions
+   ScriptVariableExecutor(ScriptVariableExecutor const&) = delete; ///< Disabled copy-constructor
+   ScriptVariableExecutor(ScriptVariableExecutor&&) = delete; ///< Disabled assignment copy-constructor
+   ~ScriptVariableExecutor() override; ///< Destructor
+   ScriptVariableExecutor& operator=(ScriptVariableExecutor const&) = delete; ///< Disabled assignment operator
+   ScriptVariableExecutor& operator=(ScriptVariableExecutor&&) = delete; ///< Disabled move assignment operator
+   QString evaluate(QString const& scriptPath); ///< Run a script, or retrieve its cached result
+   void clearCache(); ///< Clear the cached results
+
+private: // data types
+   struct CacheEntry
+   {
+      qint64 modificationDateTime { 0 }; ///< The modification date/time of the script, in ms since epoch
+      qint64 timestamp { 0 }; ///< The date/time the result was computed, in ms since epoch
+      QString output; ///< The output of the script
+   }; ///< An entry in the result cache
+
+private: // member functions
+   ScriptVariableExecutor(); ///< Default constructor
+   QFuture<RunResult> startRun(QString const& scriptPath, qint64 modificationDateTime); ///< Start running a script on the worker pool
+   void storeResult(QString const& scriptPath, qint64 modificationDateTime, QFuture<RunResult> const& future); ///< Store the result of a run in the cache
+
+private slots:
+   void onPrewarmTimerTimeout(); ///< Slot for the timeout of the pre-warm timer
+
+private: // data members
+   QThreadPool pool_; ///< The pool of worker threads
+   QHash<QString, CacheEntry> cache_; ///< The cached results, keyed by script path
+   QHash<QString, QFuture<RunResult>> pendingRuns_; ///< The runs in progress, keyed by script path
+   QHash<QString, qint32> useCounts_; ///< The number of times each script was used
+   QTimer prewarmTimer_; ///< The timer used to refresh the results of frequently used scripts
+};
+
+
+#endif // #ifndef BEEFTEXT_SCRIPT_VARIABLE_EXECUTOR_H
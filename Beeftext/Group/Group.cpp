@@ -11,6 +11,7 @@
 #include "Group.h"
 #include <utility>
 #include "BeeftextConstants.h"
+#include "BeeftextUtils.h"
 
 
 namespace {
@@ -20,6 +21,12 @@ QString const kPropDescription = "description"; ///< The JSON property name for
 QString const kPropCreationDateTime = "creationDateTime"; ///< The JSON property name for the created date/time
 QString const kPropModificationDateTime = "modificationDateTime"; ///< The JSON property name for the modification date/time
 QString const kPropEnabled = "enabled"; ///< The JSON property for the enabled/disabled state of the group
+qint64 const kCborKeyUuid = 0; ///< The CBOR key for the UUID
+qint64 const kCborKeyName = 1; ///< The CBOR key for the name
+qint64 const kCborKeyDescription = 2; ///< The CBOR key for the description
+qint64 const kCborKeyCreationDateTime = 3; ///< The CBOR key for the creation date/time
+qint64 const kCborKeyModificationDateTime = 4; ///< The CBOR key for the modification date/time
+qint64 const kCborKeyEnabled = 5; ///< The CBOR key for the enabled/disabled state of the group
 }
 
 
@@ -55,6 +62,40 @@ Group::Group(QJsonObject const& object, qint32 formatVersion)
 }
 
 
+//**********************************************************************************************************************
+/// \param[in] map The CBOR map
+//**********************************************************************************************************************
+Group::Group(QCborMap const& map)
+   : uuid_(QUuid::fromRfc4122(map.value(kCborKeyUuid).toByteArray()))
+   , name_(map.value(kCborKeyName).toString())
+   , description_(map.value(kCborKeyDescription).toString())
+   , creationDateTime_(dateTimeFromCborValue(map.value(kCborKeyCreationDateTime)))
+   , modificationDateTime_(dateTimeFromCborValue(map.value(kCborKeyModificationDateTime)))
+   , enabled_(map.value(kCborKeyEnabled).toBool(true))
+{
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] uuid The UUID of the group
+/// \param[in] name The name of the group
+/// \param[in] description The description of the group
+/// \param[in] enabled Is the group enabled
+/// \param[in] creationDateTime The creation date/time of the group
+/// \param[in] modificationDateTime The last modification date/time of the group
+//**********************************************************************************************************************
+Group::Group(QUuid const& uuid, QString name, QString description, bool enabled, QDateTime creationDateTime,
+   QDateTime modificationDateTime)
+   : uuid_(uuid)
+   , name_(std::move(name))
+   , description_(std::move(description))
+   , creationDateTime_(std::move(creationDateTime))
+   , modificationDateTime_(std::move(modificationDateTime))
+   , enabled_(enabled)
+{
+}
+
+
 //**********************************************************************************************************************
 /// \return true if and only if the group is valid
 //**********************************************************************************************************************
@@ -117,6 +158,24 @@ void Group::setDescription(QString const& description)
 }
 
 
+//**********************************************************************************************************************
+/// \return The creation date/time of the group
+//**********************************************************************************************************************
+QDateTime Group::creationDateTime() const
+{
+   return creationDateTime_;
+}
+
+
+//**********************************************************************************************************************
+/// \return The last modification date/time of the group
+//**********************************************************************************************************************
+QDateTime Group::modificationDateTime() const
+{
+   return modificationDateTime_;
+}
+
+
 //**********************************************************************************************************************
 /// \return true if and only if the group is enabled.
 //**********************************************************************************************************************
@@ -152,6 +211,22 @@ QJsonObject Group::toJsonObject() const
 }
 
 
+//**********************************************************************************************************************
+/// \return A CBOR map representing the group
+//**********************************************************************************************************************
+QCborMap Group::toCborMap() const
+{
+   QCborMap result;
+   result.insert(kCborKeyUuid, uuid_.toRfc4122());
+   result.insert(kCborKeyName, name_);
+   result.insert(kCborKeyDescription, description_);
+   result.insert(kCborKeyCreationDateTime, creationDateTime_.toMSecsSinceEpoch());
+   result.insert(kCborKeyModificationDateTime, modificationDateTime_.toMSecsSinceEpoch());
+   result.insert(kCborKeyEnabled, enabled_);
+   return result;
+}
+
+
 //**********************************************************************************************************************
 /// \param[in] name The name of the group
 /// \param[in] description The description of the group
@@ -172,6 +247,30 @@ SpGroup Group::create(QJsonObject const& object, qint32 formatVersion)
 }
 
 
+//**********************************************************************************************************************
+/// \param[in] map The CBOR map
+//**********************************************************************************************************************
+SpGroup Group::create(QCborMap const& map)
+{
+   return std::make_shared<Group>(map);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] uuid The UUID of the group
+/// \param[in] name The name of the group
+/// \param[in] description The description of the group
+/// \param[in] enabled Is the group enabled
+/// \param[in] creationDateTime The creation date/time of the group
+/// \param[in] modificationDateTime The last modification date/time of the group
+//**********************************************************************************************************************
+SpGroup Group::create(QUuid const& uuid, QString const& name, QString const& description, bool enabled,
+   QDateTime const& creationDateTime, QDateTime const& modificationDateTime)
+{
+   return std::make_shared<Group>(uuid, name, description, enabled, creationDateTime, modificationDateTime);
+}
+
+
 //**********************************************************************************************************************
 // 
 //**********************************************************************************************************************
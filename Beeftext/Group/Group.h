@@ -26,6 +26,9 @@ class Group
 public: // member functions
    explicit Group(QString name, QString description = QString()); ///< Default constructor
    Group(QJsonObject const& object, qint32 formatVersion); ///< Constructor from JSON object
+   explicit Group(QCborMap const& map); ///< Constructor from CBOR map
+   Group(QUuid const& uuid, QString name, QString description, bool enabled, QDateTime creationDateTime,
+      QDateTime modificationDateTime); ///< Constructor from all the saved properties
    Group(Group const&) = delete; ///< Disabled copy-constructor
    Group(Group&&) = delete; ///< Disabled assignment copy-constructor
    ~Group() = default; ///< Destructor
@@ -37,13 +40,19 @@ public: // member functions
    void setName(QString const& name); ///< Set the name of the group
    QString description() const; ///< Get the description of the group
    void setDescription(QString const& description); ///< Set the description of the group
+   QDateTime creationDateTime() const; ///< Get the creation date/time of the group
+   QDateTime modificationDateTime() const; ///< Get the last modification date/time of the group
    bool enabled() const; ///< Set the enabled/disabled state of the group.
    void setEnabled(bool enable); ///< Get the enabled/disabled state of the group.
    QJsonObject toJsonObject() const; ///< Serialize the group in a JSon object
+   QCborMap toCborMap() const; ///< Serialize the group in a CBOR map
 
 public: // static functions
    static SpGroup create(QString const& name, QString const& description = QString()); ///< Create a SpGroup
    static SpGroup create(QJsonObject const& object, qint32 formatVersion); ///< Create a SpGroup from a JSON object
+   static SpGroup create(QCborMap const& map); ///< Create a SpGroup from a CBOR map
+   static SpGroup create(QUuid const& uuid, QString const& name, QString const& description, bool enabled,
+      QDateTime const& creationDateTime, QDateTime const& modificationDateTime); ///< Create a SpGroup from all its saved properties
 
 private: // member functions
    void touch(); ///< Set the modification date/time to the current date/time
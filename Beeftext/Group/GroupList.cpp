@@ -345,6 +345,50 @@ bool GroupList::readFromJsonArray(QJsonArray const& array, qint32 formatVersion,
 }
 
 
+//**********************************************************************************************************************
+/// \return A CBOR array containing the group list
+//**********************************************************************************************************************
+QCborArray GroupList::toCborArray() const
+{
+   QCborArray result;
+   for (SpGroup const& group: groups_)
+      result.append(group->toCborMap());
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] array The CBOR array to parse
+/// \param[out] outErrorMessage if not null and the function returns false, this variable hold a description of the
+/// error on exit
+/// \return true if and only if the array was parsed successfully
+//**********************************************************************************************************************
+bool GroupList::readFromCborArray(QCborArray const& array, QString* outErrorMessage)
+{
+   try
+   {
+      this->clear();
+      for (QCborValue const& value : array)
+      {
+         if (!value.isMap())
+            throw xmilib::Exception("The group list is invalid.");
+         SpGroup const group = Group::create(value.toMap());
+         if ((!group) || (!group->isValid()))
+            throw xmilib::Exception("The group list contains an invalid group.");
+         if (!this->append(group))
+            throw xmilib::Exception("Could not append one of the groups to the group list.");
+      }
+      return true;
+   }
+   catch (xmilib::Exception const& e)
+   {
+      if (outErrorMessage)
+         *outErrorMessage = e.qwhat();
+      return false;
+   }
+}
+
+
 //**********************************************************************************************************************
 /// \return true if the group list was empty and had to be filled with a default group
 //**********************************************************************************************************************
@@ -413,7 +457,7 @@ bool GroupList::processComboListDrop(QList<QUuid> const& uuids, qint32 index)
    bool changed = false;
    for (QUuid const& uuid : uuids)
    {
-      ComboList::iterator const it = comboList.findByUuid(uuid);
+      ComboList::const_iterator const it = comboList.findByUuid(uuid);
       if ((it == comboList.end()) || ((*it)->group() == group))
          continue;
       (*it)->setGroup(group);
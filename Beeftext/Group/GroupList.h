@@ -69,6 +69,8 @@ public: // member functions
    const_reverse_iterator rend() const; ///< Returns a constant reverse iterator to the end of the list
    QJsonArray toJsonArray() const; ///< Export the group list to a JSON array
    bool readFromJsonArray(QJsonArray const& array, qint32 formatVersion, QString* outErrorMessage); ///< Read the group list from a JSON array
+   QCborArray toCborArray() const; ///< Export the group list to a CBOR array
+   bool readFromCborArray(QCborArray const& array, QString* outErrorMessage); ///< Read the group list from a CBOR array
    bool ensureNotEmpty(); ///< make sure that the group list is not empty, creating one if necessary
    QMenu* createMenu(QString const& title, std::set<SpGroup> const& disabledGroups, QWidget* parent = nullptr); ///< Create a containing the list of groups
    void fillMenu(QMenu* menu, std::set<SpGroup> const& disabledGroups); ///< Clear the menu and fill it with the list of groups
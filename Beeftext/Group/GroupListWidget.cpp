@@ -257,9 +257,7 @@ void GroupListWidget::onActionNewGroup()
       GroupList& groups = comboManager.groupListRef();
       if (!groups.append(group))
          throw xmilib::Exception(tr("The group could not be added to the list."));
-      QString errorMessage;
-      if (!comboManager.saveComboListToFile(&errorMessage))
-         throw xmilib::Exception(errorMessage);
+      comboManager.requestComboListSave();
       this->selectGroup(group);
    }
    catch (xmilib::Exception const& e)
@@ -284,9 +282,7 @@ void GroupListWidget::onActionEditGroup()
       SpGroup group = groups[index];
       if (!GroupDialog::run(group, tr("Edit Group")))
          return;
-      QString errorMessage;
-      if (!comboManager.saveComboListToFile(&errorMessage))
-         throw xmilib::Exception(errorMessage);
+      comboManager.requestComboListSave();
       this->updateGui();
    }
    catch (xmilib::Exception const& e)
@@ -313,8 +309,7 @@ void GroupListWidget::onActionDeleteGroup()
          return;
       comboManager.comboListRef().eraseCombosOfGroup(groups[index]);
       groups.erase(index);
-      if (!comboManager.saveComboListToFile())
-         throw xmilib::Exception("Could not save combo list.");
+      comboManager.requestComboListSave();
       // we force the emission of a selectedGroupChange event, because the system will no do it in that case
       this->onSelectionChanged(QItemSelection(), QItemSelection());
       this->updateGui();
@@ -338,9 +333,7 @@ void GroupListWidget::onActionEnableDisableGroup()
          return;
       group->setEnabled(!group->enabled());
       this->updateGui();
-      QString errorMessage;
-      if (!ComboManager::instance().saveComboListToFile(&errorMessage))
-         throw xmilib::Exception(errorMessage);
+      ComboManager::instance().requestComboListSave();
 
       qint32 const index = this->selectedGroupIndex();
       GroupList& groups = ComboManager::instance().groupListRef();
@@ -378,8 +371,7 @@ void GroupListWidget::onGroupMoved(SpGroup const& group, qint32 newIndex) const
    ComboManager& comboManager = ComboManager::instance();
    ui_.listGroup->setCurrentIndex(comboManager.groupListRef().index(newIndex + 1));
    //+1 because entry at index 0 is '<All combos>'
-   if (!comboManager.saveComboListToFile())
-      throw xmilib::Exception("Could not save combo list.");
+   comboManager.requestComboListSave();
 }
 
 
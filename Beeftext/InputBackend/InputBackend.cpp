@@ -0,0 +1,62 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of abstract input backend interface.
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "InputBackend.h"
+#include "InputBackendHeadless.h"
+#ifdef Q_OS_WIN
+#include "InputBackendWin32.h"
+#endif
+
+
+namespace {
+
+
+std::unique_ptr<InputBackend> inputBackendPtr = nullptr; ///< The global variable containing the input backend
+
+
+}
+
+
+//**********************************************************************************************************************
+/// If no backend type has been set, the Win32 backend is used on Windows, and the headless backend on other platforms.
+///
+/// \return A reference to the input backend
+//**********************************************************************************************************************
+InputBackend& InputBackend::instance()
+{
+   if (!inputBackendPtr)
+#ifdef Q_OS_WIN
+      setInputBackendType(EType::Win32);
+#else
+      setInputBackendType(EType::Headless);
+#endif
+   return *inputBackendPtr;
+}
+
+
+//**********************************************************************************************************************
+/// The type must be set before the input manager is first used, as the input manager only installs the keyboard and
+/// mouse hooks when the Win32 backend is used. The Win32 backend is only available on Windows.
+///
+/// \param[in] type The new input backend type.
+//**********************************************************************************************************************
+void InputBackend::setInputBackendType(EType type)
+{
+   if (inputBackendPtr && (inputBackendPtr->type() == type))
+      return;
+#ifdef Q_OS_WIN
+   if (EType::Win32 == type)
+   {
+      inputBackendPtr = std::make_unique<InputBackendWin32>();
+      return;
+   }
+#endif
+   inputBackendPtr = std::make_unique<InputBackendHeadless>();
+}
@@ -0,0 +1,48 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of abstract input backend interface.
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_INPUT_BACKEND_H
+#define BEEFTEXT_INPUT_BACKEND_H
+
+
+//**********************************************************************************************************************
+/// \brief Abstract input backend class used as an interface.
+///
+/// The backend is the platform-specific part of the substitution pipeline: it is the source of the key events
+/// consumed by the input manager, and it injects the text of substitutions into the foreground application. The
+/// injected input must not be reported as key events.
+//**********************************************************************************************************************
+class InputBackend
+{
+public: // data types
+   enum class EType
+   {
+      Win32, ///< The Win32 backend, using low-level hooks and synthesized input.
+      Headless, ///< The headless backend, fed with scripted key events and recording the injected text.
+   }; ///< Enumeration for the type of input backend
+
+public: // static members
+   static InputBackend& instance(); ///< Return the instance of the input backend
+   static void setInputBackendType(EType type); ///< Set the input backend type.
+
+public: // member functions
+   InputBackend() = default; ///< Default constructor.
+   InputBackend(InputBackend const&) = delete; ///< Disabled copy constructor.
+   InputBackend(InputBackend&&) = delete; ///< Disabled move constructor.
+   virtual ~InputBackend() = default; ///< Default destructor.
+   InputBackend& operator=(InputBackend const&) = delete; ///< Disabled assignment operator.
+   InputBackend& operator=(InputBackend&&) = delete; ///< Disabled move assignment operator.
+   virtual EType type() const = 0; ///< Return the type of input backend of the instance.
+   virtual bool isKeyboardCaptureEnabled() const = 0; ///< Test if the capture of key events is enabled.
+   virtual bool setKeyboardCaptureEnabled(bool enabled) = 0; ///< Enable or disable the capture of key events.
+   virtual void substituteText(qint32 eraseCount, QString const& text, qint32 cursorLeftCount) = 0; ///< Replace the characters before the cursor with text.
+};
+
+
+#endif // BEEFTEXT_INPUT_BACKEND_H
@@ -0,0 +1,183 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of headless input backend class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "InputBackendHeadless.h"
+#include "InputManager.h"
+
+
+//**********************************************************************************************************************
+/// \return The type of input backend of the instance.
+//**********************************************************************************************************************
+InputBackend::EType InputBackendHeadless::type() const
+{
+   return EType::Headless;
+}
+
+
+//**********************************************************************************************************************
+/// \return true if and only if the capture of key events is enabled.
+//**********************************************************************************************************************
+bool InputBackendHeadless::isKeyboardCaptureEnabled() const
+{
+   return captureEnabled_;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] enabled Should the capture of key events be enabled.
+/// \return true if and only if the capture of key events was enabled before the call.
+//**********************************************************************************************************************
+bool InputBackendHeadless::setKeyboardCaptureEnabled(bool enabled)
+{
+   bool const result = captureEnabled_;
+   captureEnabled_ = enabled;
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// The keystroke sequence is built as for the Win32 backend, with the text pasted from a simulated clipboard, and the
+/// key presses it contains are applied to the in-memory document.
+///
+/// \param[in] eraseCount The number of characters to erase before the cursor.
+/// \param[in] text The text to insert.
+/// \param[in] cursorLeftCount The number of positions to move the cursor to the left after the insertion.
+//**********************************************************************************************************************
+void InputBackendHeadless::substituteText(qint32 eraseCount, QString const& text, qint32 cursorLeftCount)
+{
+   lastSequence_ = KeystrokeSequence::forSubstitution({}, eraseCount, true, QString(), cursorLeftCount);
+   bool controlPressed = false;
+   for (KeystrokeSequence::Keystroke const& keystroke: lastSequence_.keystrokes())
+   {
+      if ((KeystrokeSequence::KeyLeftControl == keystroke.virtualKey) ||
+         (KeystrokeSequence::KeyRightControl == keystroke.virtualKey))
+         controlPressed = !keystroke.keyUp;
+      if (keystroke.keyUp)
+         continue;
+      switch (keystroke.virtualKey)
+      {
+      case 0:
+         document_.insert(cursorPosition_++, QChar(keystroke.character));
+         break;
+      case KeystrokeSequence::KeyReturn:
+         document_.insert(cursorPosition_++, QChar::LineFeed);
+         break;
+      case KeystrokeSequence::KeyBackspace:
+         if (cursorPosition_ > 0)
+            document_.remove(--cursorPosition_, 1);
+         break;
+      case KeystrokeSequence::KeyLeft:
+         cursorPosition_ = qMax(0, cursorPosition_ - 1);
+         break;
+      case KeystrokeSequence::KeyV:
+         if (controlPressed)
+         {
+            document_.insert(cursorPosition_, text);
+            cursorPosition_ += text.size();
+         }
+         break;
+      default:
+         break;
+      }
+   }
+   ++injectionCount_;
+}
+
+
+//**********************************************************************************************************************
+/// The text is typed into the in-memory document, and if capture is enabled, the key events are pushed to the input
+/// manager, as the keyboard hook would do.
+///
+/// \param[in] text The text.
+//**********************************************************************************************************************
+void InputBackendHeadless::feedText(QString const& text)
+{
+   InputManager& inputManager = InputManager::instance();
+   for (QChar c: text)
+   {
+      document_.insert(cursorPosition_, c);
+      ++cursorPosition_;
+      if (captureEnabled_)
+         inputManager.pushTypedCharacter(c);
+   }
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void InputBackendHeadless::feedBackspace()
+{
+   if (cursorPosition_ > 0)
+   {
+      document_.remove(cursorPosition_ - 1, 1);
+      --cursorPosition_;
+   }
+   if (captureEnabled_)
+      InputManager::instance().pushKeyEvent(InputManager::EKeyEventType::Backspace);
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void InputBackendHeadless::feedComboBreaker()
+{
+   if (captureEnabled_)
+      InputManager::instance().pushKeyEvent(InputManager::EKeyEventType::ComboBreaker);
+}
+
+
+//**********************************************************************************************************************
+/// \return The in-memory document.
+//**********************************************************************************************************************
+QString InputBackendHeadless::document() const
+{
+   return document_;
+}
+
+
+//**********************************************************************************************************************
+/// \return The position of the cursor in the in-memory document.
+//**********************************************************************************************************************
+qint32 InputBackendHeadless::cursorPosition() const
+{
+   return cursorPosition_;
+}
+
+
+//**********************************************************************************************************************
+/// \return The number of text insertions performed.
+//**********************************************************************************************************************
+qint32 InputBackendHeadless::injectionCount() const
+{
+   return injectionCount_;
+}
+
+
+//**********************************************************************************************************************
+/// \return The keystroke sequence of the last substitution.
+//**********************************************************************************************************************
+KeystrokeSequence const& InputBackendHeadless::lastSequence() const
+{
+   return lastSequence_;
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void InputBackendHeadless::reset()
+{
+   document_.clear();
+   cursorPosition_ = 0;
+   injectionCount_ = 0;
+   lastSequence_.clear();
+}
@@ -0,0 +1,57 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of headless input backend class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_INPUT_BACKEND_HEADLESS_H
+#define BEEFTEXT_INPUT_BACKEND_HEADLESS_H
+
+
+#include "InputBackend.h"
+#include "KeystrokeSequence.h"
+
+
+//**********************************************************************************************************************
+/// \brief Headless input backend class.
+///
+/// This backend does not interact with the system. Scripted key events are fed to the input manager, and the
+/// injected text is applied to an in-memory document, so that the whole substitution pipeline can be run and timed
+/// without a desktop session. Substitutions are performed by applying to the document the same keystroke sequence
+/// the Win32 backend would submit. The backend must be used from the thread that processes the key events.
+//**********************************************************************************************************************
+class InputBackendHeadless: public InputBackend
+{
+public: // member functions
+   InputBackendHeadless() = default; ///< Default constructor.
+   InputBackendHeadless(InputBackendHeadless const&) = delete; ///< Disabled copy constructor.
+   InputBackendHeadless(InputBackendHeadless&&) = delete; ///< Disabled move constructor.
+   ~InputBackendHeadless() override = default; ///< Default destructor.
+   InputBackendHeadless& operator=(InputBackendHeadless const&) = delete; ///< Disabled assignment operator.
+   InputBackendHeadless& operator=(InputBackendHeadless&&) = delete; ///< Disabled move assignment operator.
+   EType type() const override; ///< Return the type of input backend of the instance.
+   bool isKeyboardCaptureEnabled() const override; ///< Test if the capture of key events is enabled.
+   bool setKeyboardCaptureEnabled(bool enabled) override; ///< Enable or disable the capture of key events.
+   void substituteText(qint32 eraseCount, QString const& text, qint32 cursorLeftCount) override; ///< Replace the characters before the cursor with text.
+   void feedText(QString const& text); ///< Feed the key events for typed text.
+   void feedBackspace(); ///< Feed the key event for a backspace.
+   void feedComboBreaker(); ///< Feed a combo breaker event.
+   QString document() const; ///< Return the in-memory document.
+   qint32 cursorPosition() const; ///< Return the position of the cursor in the in-memory document.
+   qint32 injectionCount() const; ///< Return the number of text insertions performed.
+   KeystrokeSequence const& lastSequence() const; ///< Return the keystroke sequence of the last substitution.
+   void reset(); ///< Clear the in-memory document and the injection count.
+
+private: // data members
+   bool captureEnabled_ { true }; ///< Is the capture of key events enabled.
+   QString document_; ///< The in-memory document the typed and injected text is applied to.
+   qint32 cursorPosition_ { 0 }; ///< The position of the cursor in the document.
+   qint32 injectionCount_ { 0 }; ///< The number of text insertions performed.
+   KeystrokeSequence lastSequence_; ///< The keystroke sequence of the last substitution.
+};
+
+
+#endif // #ifndef BEEFTEXT_INPUT_BACKEND_HEADLESS_H
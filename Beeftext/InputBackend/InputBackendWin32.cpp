@@ -0,0 +1,196 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of Win32 input backend class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "InputBackendWin32.h"
+#include "InputManager.h"
+#include "SensitiveApplicationManager.h"
+#include "PreferencesManager.h"
+#include "BeeftextUtils.h"
+#include "Clipboard/ClipboardManager.h"
+#include "SubstitutionLatencyMonitor.h"
+#include "KeystrokeSequence.h"
+#include "BeeftextGlobals.h"
+
+
+namespace {
+
+
+QList<quint16> const modifierKeys = {  VK_LCONTROL, VK_RCONTROL, VK_LMENU, VK_RMENU, VK_LSHIFT, VK_RSHIFT, VK_LWIN,
+   VK_RWIN }; ///< The modifier keys
+
+
+//**********************************************************************************************************************
+/// \return The list of modifier keys that are currently pressed
+//**********************************************************************************************************************
+QList<quint16> pressedModifierKeys()
+{
+   QList<quint16> result;
+   for (quint16 key: modifierKeys)
+      if (GetKeyState(key) < 0)
+         result.append(key);
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] virtualKey The virtual key code
+/// \return true if and only if the key is an extended key
+//**********************************************************************************************************************
+bool isExtendedKey(quint16 virtualKey)
+{
+   switch (virtualKey)
+   {
+   case VK_RCONTROL: case VK_RMENU: case VK_LWIN: case VK_RWIN: case VK_LEFT: case VK_RIGHT: case VK_UP: case VK_DOWN:
+   case VK_HOME: case VK_END: case VK_PRIOR: case VK_NEXT: case VK_INSERT: case VK_DELETE:
+      return true;
+   default:
+      return false;
+   }
+}
+
+
+//**********************************************************************************************************************
+/// \brief Convert a keystroke to a keyboard input event tagged as injected by Beeftext, so that the keyboard hook
+/// ignores it.
+///
+/// \param[in] keystroke The keystroke
+/// \return The input event
+//**********************************************************************************************************************
+INPUT toInput(KeystrokeSequence::Keystroke const& keystroke)
+{
+   INPUT input;
+   ZeroMemory(&input, sizeof(input));
+   input.type = INPUT_KEYBOARD;
+   input.ki.wVk = keystroke.virtualKey;
+   input.ki.wScan = keystroke.virtualKey ? static_cast<WORD>(MapVirtualKey(keystroke.virtualKey, MAPVK_VK_TO_VSC))
+      : keystroke.character;
+   input.ki.dwFlags = (keystroke.virtualKey ? 0 : KEYEVENTF_UNICODE) | (keystroke.keyUp ? KEYEVENTF_KEYUP : 0) |
+      (isExtendedKey(keystroke.virtualKey) ? KEYEVENTF_EXTENDEDKEY : 0);
+   input.ki.dwExtraInfo = InputManager::injectedEventTag;
+   return input;
+}
+
+
+//**********************************************************************************************************************
+/// \brief Submit keystrokes to the system, in as few calls to SendInput() as possible.
+///
+/// \param[in] sequence The keystroke sequence
+/// \param[in] first The index of the first keystroke to submit
+/// \param[in] count The number of keystrokes to submit
+//**********************************************************************************************************************
+void sendKeystrokes(KeystrokeSequence const& sequence, qint32 first, qint32 count)
+{
+   sequence.forEachChunk(first, count, [](KeystrokeSequence::Keystroke const* keystrokes, qint32 chunkSize) -> bool
+   {
+      INPUT inputs[KeystrokeSequence::maxChunkSize];
+      for (qint32 i = 0; i < chunkSize; ++i)
+         inputs[i] = toInput(keystrokes[i]);
+      UINT const sent = SendInput(static_cast<UINT>(chunkSize), inputs, sizeof(INPUT));
+      if (sent == static_cast<UINT>(chunkSize))
+         return true;
+      globals::debugLog().addWarning(QString("Only %1 of %2 synthetic keystrokes could be sent.").arg(sent)
+         .arg(chunkSize));
+      return false; // the input was blocked by another thread or by UIPI, there is no point in sending the rest
+   });
+}
+
+
+//**********************************************************************************************************************
+/// \brief Submit keystrokes one at a time, waiting after each key release.
+///
+/// \param[in] sequence The keystroke sequence
+/// \param[in] delayMs The delay after each key release, in milliseconds
+//**********************************************************************************************************************
+void sendKeystrokesWithDelay(KeystrokeSequence const& sequence, qint32 delayMs)
+{
+   QVector<KeystrokeSequence::Keystroke> const& keystrokes = sequence.keystrokes();
+   for (qint32 i = 0; i < keystrokes.size(); ++i)
+   {
+      sendKeystrokes(sequence, i, 1);
+      if (keystrokes[i].keyUp)
+         qApp->thread()->msleep(static_cast<quint32>(delayMs));
+   }
+}
+
+
+}
+
+
+//**********************************************************************************************************************
+/// \return The type of input backend of the instance.
+//**********************************************************************************************************************
+InputBackend::EType InputBackendWin32::type() const
+{
+   return EType::Win32;
+}
+
+
+//**********************************************************************************************************************
+/// \return true if and only if the keyboard hook is installed.
+//**********************************************************************************************************************
+bool InputBackendWin32::isKeyboardCaptureEnabled() const
+{
+   return InputManager::instance().isKeyboardHookEnable();
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] enabled Should the capture of key events be enabled.
+/// \return true if and only if the capture of key events was enabled before the call.
+//**********************************************************************************************************************
+bool InputBackendWin32::setKeyboardCaptureEnabled(bool enabled)
+{
+   return InputManager::instance().setKeyboardHookEnabled(enabled);
+}
+
+
+//**********************************************************************************************************************
+/// The text is pasted using the clipboard, unless the foreground application is a sensitive application, in which
+/// case the typing of the text is simulated. All the keystrokes, including the release and restoration of the modifier
+/// keys that are currently pressed, are submitted in a single burst, so they cannot be interleaved with the user's
+/// keystrokes. Very long sequences are split into several bursts. When the text is typed and a delay between
+/// keystrokes is set in the preferences, the keystrokes are submitted one at a time.
+///
+/// \param[in] eraseCount The number of characters to erase before the cursor.
+/// \param[in] text The text to insert.
+/// \param[in] cursorLeftCount The number of positions to move the cursor to the left after the insertion.
+//**********************************************************************************************************************
+void InputBackendWin32::substituteText(qint32 eraseCount, QString const& text, qint32 cursorLeftCount)
+{
+   bool const paste = !SensitiveApplicationManager::instance().isSensitiveApplication(getActiveExecutableFileName());
+   if (paste)
+   {
+      LatencySpan const backupSpan(ESubstitutionPhase::ClipboardBackup);
+      ClipboardManager& clipboardManager = ClipboardManager::instance();
+      clipboardManager.backupClipboard();
+      clipboardManager.setText(text);
+   }
+
+   KeystrokeSequence const sequence = KeystrokeSequence::forSubstitution(pressedModifierKeys(), eraseCount, paste,
+      text, cursorLeftCount);
+   qint32 const delayMs = PreferencesManager::instance().delayBetweenKeystrokesMs();
+   if (paste || (delayMs <= 0))
+   {
+      LatencySpan const injectionSpan(ESubstitutionPhase::InputInjection);
+      sendKeystrokes(sequence, 0, sequence.size());
+   }
+   else
+   {
+      LatencySpan const typingSpan(ESubstitutionPhase::Typing);
+      sendKeystrokesWithDelay(sequence, delayMs);
+   }
+
+   if (paste)
+      QTimer::singleShot(1000, []()
+      {
+         LatencySpan const restoreSpan(ESubstitutionPhase::ClipboardRestore);
+         ClipboardManager::instance().restoreClipboard();
+      }); ///< We need to delay clipboard restoration to avoid unexpected behaviours
+}
@@ -0,0 +1,40 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of Win32 input backend class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_INPUT_BACKEND_WIN32_H
+#define BEEFTEXT_INPUT_BACKEND_WIN32_H
+
+
+#include "InputBackend.h"
+
+
+//**********************************************************************************************************************
+/// \brief Win32 input backend class.
+///
+/// Key events are captured by the low-level hooks of the input manager, and text is injected using synthesized
+/// keystrokes, or the clipboard. The keystrokes of a substitution are submitted in a single burst, and they are tagged
+/// with InputManager::injectedEventTag, so the hooks can stay installed during substitutions.
+//**********************************************************************************************************************
+class InputBackendWin32: public InputBackend
+{
+public: // member functions
+   InputBackendWin32() = default; ///< Default constructor.
+   InputBackendWin32(InputBackendWin32 const&) = delete; ///< Disabled copy constructor.
+   InputBackendWin32(InputBackendWin32&&) = delete; ///< Disabled move constructor.
+   ~InputBackendWin32() override = default; ///< Default destructor.
+   InputBackendWin32& operator=(InputBackendWin32 const&) = delete; ///< Disabled assignment operator.
+   InputBackendWin32& operator=(InputBackendWin32&&) = delete; ///< Disabled move assignment operator.
+   EType type() const override; ///< Return the type of input backend of the instance.
+   bool isKeyboardCaptureEnabled() const override; ///< Test if the capture of key events is enabled.
+   bool setKeyboardCaptureEnabled(bool enabled) override; ///< Enable or disable the capture of key events.
+   void substituteText(qint32 eraseCount, QString const& text, qint32 cursorLeftCount) override; ///< Replace the characters before the cursor with text.
+};
+
+
+#endif // #ifndef BEEFTEXT_INPUT_BACKEND_WIN32_H
@@ -0,0 +1,177 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of keystroke sequence class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#include "stdafx.h"
+#include "KeystrokeSequence.h"
+
+
+#ifdef Q_OS_WIN
+static_assert((VK_BACK == KeystrokeSequence::KeyBackspace) && (VK_RETURN == KeystrokeSequence::KeyReturn) &&
+   (VK_LEFT == KeystrokeSequence::KeyLeft) && (VK_LCONTROL == KeystrokeSequence::KeyLeftControl) &&
+   (VK_RCONTROL == KeystrokeSequence::KeyRightControl), "The key codes must match the Windows virtual key codes.");
+#endif
+
+
+qint32 const KeystrokeSequence::maxChunkSize; // the value is set in the declaration
+
+
+//**********************************************************************************************************************
+/// The modifier keys currently pressed are released first and pressed again at the end, so they do not alter the
+/// synthesized keystrokes. The keyword is then erased, the text is pasted using Ctrl+V or typed, and the cursor is
+/// moved to the left.
+///
+/// \param[in] pressedModifiers The modifier keys that are currently pressed
+/// \param[in] eraseCount The number of characters to erase
+/// \param[in] paste Should the text be pasted from the clipboard rather than typed
+/// \param[in] typedText The text to type. This parameter is ignored if paste is true
+/// \param[in] cursorLeftCount The number of positions to move the cursor to the left after the insertion
+/// \return The sequence
+//**********************************************************************************************************************
+KeystrokeSequence KeystrokeSequence::forSubstitution(QList<quint16> const& pressedModifiers, qint32 eraseCount,
+   bool paste, QString const& typedText, qint32 cursorLeftCount)
+{
+   KeystrokeSequence result;
+   result.keystrokes_.reserve(2 * (pressedModifiers.size() + qMax(0, eraseCount) + qMax(0, cursorLeftCount)
+      + (paste ? 2 : typedText.size())));
+   for (quint16 const key: pressedModifiers)
+      result.appendKeyUp(key);
+   result.appendKeyPress(KeyBackspace, eraseCount);
+   if (paste)
+   {
+      result.appendKeyDown(KeyLeftControl);
+      result.appendKeyPress(KeyV);
+      result.appendKeyUp(KeyLeftControl);
+   }
+   else
+      result.appendText(typedText);
+   result.appendKeyPress(KeyLeft, cursorLeftCount);
+   for (quint16 const key: pressedModifiers)
+      result.appendKeyDown(key);
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] virtualKey The virtual key code
+//**********************************************************************************************************************
+void KeystrokeSequence::appendKeyDown(quint16 virtualKey)
+{
+   keystrokes_.append({ virtualKey, 0, false });
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] virtualKey The virtual key code
+//**********************************************************************************************************************
+void KeystrokeSequence::appendKeyUp(quint16 virtualKey)
+{
+   keystrokes_.append({ virtualKey, 0, true });
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] virtualKey The virtual key code
+/// \param[in] count The number of times the key is pressed and released
+//**********************************************************************************************************************
+void KeystrokeSequence::appendKeyPress(quint16 virtualKey, qint32 count)
+{
+   for (qint32 i = 0; i < count; ++i)
+   {
+      this->appendKeyDown(virtualKey);
+      this->appendKeyUp(virtualKey);
+   }
+}
+
+
+//**********************************************************************************************************************
+/// Line feeds are synthesized using the Return key, as Windows does not handle them properly as unicode input.
+///
+/// \param[in] c The character
+//**********************************************************************************************************************
+void KeystrokeSequence::appendCharacter(QChar c)
+{
+   if (QChar::LineFeed == c)
+   {
+      this->appendKeyPress(KeyReturn);
+      return;
+   }
+   keystrokes_.append({ 0, c.unicode(), false });
+   keystrokes_.append({ 0, c.unicode(), true });
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] text The text
+//**********************************************************************************************************************
+void KeystrokeSequence::appendText(QString const& text)
+{
+   for (QChar const c: text)
+      this->appendCharacter(c);
+}
+
+
+//**********************************************************************************************************************
+/// \return The keystrokes
+//**********************************************************************************************************************
+QVector<KeystrokeSequence::Keystroke> const& KeystrokeSequence::keystrokes() const
+{
+   return keystrokes_;
+}
+
+
+//**********************************************************************************************************************
+/// \return The number of keystrokes
+//**********************************************************************************************************************
+qint32 KeystrokeSequence::size() const
+{
+   return keystrokes_.size();
+}
+
+
+//**********************************************************************************************************************
+/// The range is split into consecutive chunks of at most maxChunkSize keystrokes, and the handler is called for each
+/// chunk, in order, until it returns false. The end of the range is clamped to the sequence.
+///
+/// \param[in] first The index of the first keystroke of the range, which must not be negative
+/// \param[in] count The number of keystrokes in the range
+/// \param[in] handler The function called with a pointer to the first keystroke of a chunk and the size of the chunk
+/// \return true if and only if the handler returned true for every chunk
+//**********************************************************************************************************************
+bool KeystrokeSequence::forEachChunk(qint32 first, qint32 count, ChunkHandler const& handler) const
+{
+   Q_ASSERT(first >= 0);
+   first = qMax(0, first);
+   qint32 const end = qMin(keystrokes_.size(), first + count);
+   while (first < end)
+   {
+      qint32 const chunkSize = qMin<qint32>(maxChunkSize, end - first);
+      if (!handler(keystrokes_.constData() + first, chunkSize))
+         return false;
+      first += chunkSize;
+   }
+   return true;
+}
+
+
+//**********************************************************************************************************************
+/// \return true if and only if the sequence is empty
+//**********************************************************************************************************************
+bool KeystrokeSequence::isEmpty() const
+{
+   return keystrokes_.isEmpty();
+}
+
+
+//**********************************************************************************************************************
+// 
+//**********************************************************************************************************************
+void KeystrokeSequence::clear()
+{
+   keystrokes_.clear();
+}
@@ -0,0 +1,73 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of keystroke sequence class
+///  
+/// Copyright (c) Xavier Michelon. All rights reserved.  
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.  
+
+
+#ifndef BEEFTEXT_KEYSTROKE_SEQUENCE_H
+#define BEEFTEXT_KEYSTROKE_SEQUENCE_H
+
+
+#include <functional>
+
+
+//**********************************************************************************************************************
+/// \brief A sequence of synthetic keystrokes.
+///
+/// The sequence is independent from the way it is submitted, so the keystrokes generated for a substitution can be
+/// inspected, or applied to an in-memory document by the headless backend. The key codes are the Windows virtual key
+/// codes, but the class does not depend on the Windows API.
+//**********************************************************************************************************************
+class KeystrokeSequence
+{
+public: // data types
+   enum: quint16 {
+      KeyBackspace = 0x08, ///< The Backspace key (VK_BACK)
+      KeyReturn = 0x0d, ///< The Return key (VK_RETURN)
+      KeyLeft = 0x25, ///< The Left arrow key (VK_LEFT)
+      KeyV = 0x56, ///< The V key
+      KeyLeftControl = 0xa2, ///< The left Control key (VK_LCONTROL)
+      KeyRightControl = 0xa3, ///< The right Control key (VK_RCONTROL)
+   }; ///< The virtual key codes used in the sequences built by the class
+   struct Keystroke
+   {
+      quint16 virtualKey { 0 }; ///< The virtual key code, or 0 for a unicode character
+      quint16 character { 0 }; ///< The unicode character, if virtualKey is 0
+      bool keyUp { false }; ///< Is the keystroke a key release
+   }; ///< A single key press or release
+   typedef std::function<bool(Keystroke const*, qint32)> ChunkHandler; ///< Type definition for chunk handlers, returning false stops the iteration
+
+public: // static data members
+   static qint32 const maxChunkSize = 512; ///< The maximum number of keystrokes submitted to the system at once
+
+public: // static member functions
+   static KeystrokeSequence forSubstitution(QList<quint16> const& pressedModifiers, qint32 eraseCount, bool paste,
+      QString const& typedText, qint32 cursorLeftCount); ///< Build the sequence for a substitution
+
+public: // member functions
+   KeystrokeSequence() = default; ///< Default constructor.
+   KeystrokeSequence(KeystrokeSequence const&) = default; ///< Default copy constructor.
+   KeystrokeSequence(KeystrokeSequence&&) = default; ///< Default move constructor.
+   ~KeystrokeSequence() = default; ///< Default destructor.
+   KeystrokeSequence& operator=(KeystrokeSequence const&) = default; ///< Default assignment operator.
+   KeystrokeSequence& operator=(KeystrokeSequence&&) = default; ///< Default move assignment operator.
+   void appendKeyDown(quint16 virtualKey); ///< Append a key press
+   void appendKeyUp(quint16 virtualKey); ///< Append a key release
+   void appendKeyPress(quint16 virtualKey, qint32 count = 1); ///< Append key press and release pairs
+   void appendCharacter(QChar c); ///< Append the press and release of a character
+   void appendText(QString const& text); ///< Append the press and release of every character of a text
+   QVector<Keystroke> const& keystrokes() const; ///< Return the keystrokes
+   qint32 size() const; ///< Return the number of keystrokes
+   bool forEachChunk(qint32 first, qint32 count, ChunkHandler const& handler) const; ///< Call a function for every chunk of a range of keystrokes
+   bool isEmpty() const; ///< Check if the sequence is empty
+   void clear(); ///< Clear the sequence
+
+private: // data members
+   QVector<Keystroke> keystrokes_; ///< The keystrokes
+};
+
+
+#endif // #ifndef BEEFTEXT_KEYSTROKE_SEQUENCE_H
@@ -13,16 +13,25 @@
 #include "MainWindow.h"
 #include "BeeftextUtils.h"
 #include "Combo/ComboPicker/ComboPickerWindow.h"
+#include "InputBackend/InputBackend.h"
 #include <XMiLib/Exception.h>
 
 
 using namespace xmilib;
 
 
+#ifdef Q_OS_WIN
+
+
 namespace {
 
 qint32 const kTextBufferSize = 10;
 ///< The size of the buffer that will receive the text resulting from the processing of the key stroke
+quint32 const kModifierKeys[] = { VK_SHIFT, VK_LSHIFT, VK_RSHIFT, VK_CONTROL, VK_LCONTROL, VK_RCONTROL, VK_MENU,
+   VK_LMENU, VK_RMENU, VK_RWIN, VK_LWIN, VK_CAPITAL }; ///< The keys whose state is retrieved for every keystroke
+std::atomic<InputManager*> hookInputManager { nullptr };
+///< The input manager the hook procedures report to. The hook procedures are called in the hook thread, possibly
+///< before the construction of the instance is complete, so they cannot use InputManager::instance()
 
 
 //**********************************************************************************************************************
@@ -44,57 +53,46 @@ bool getForegroundWindowInputLocale(HKL& outHkl)
 
 
 //**********************************************************************************************************************
-/// \brief Check whether a keystroke match a shortcut.
+/// \brief Compute the key code of a keystroke, to be compared with the key code of shortcuts.
 /// 
 /// \param[in] keyStroke The keystroke.
-/// \param[in] shortcut The shortcut.
-/// \return true if and only if the keystroke match the shortcut.
+/// \return The key code of the keystroke, as returned by Shortcut::nativeKeyCode().
 //**********************************************************************************************************************
-bool doesKeystrokeMatchShortcut(InputManager::KeyStroke const& keyStroke, SpShortcut const& shortcut)
+quint64 keyStrokeKeyCode(InputManager::KeyStroke const& keyStroke)
 {
-   if (!shortcut)
-      return false;
-   if (keyStroke.virtualKey != shortcut->nativeVirtualKey())
-      return false;
-   Qt::KeyboardModifiers const modifiers = shortcut->nativeModifiers();
    quint8 const* ks = keyStroke.keyboardState;
-   return bool((ks[VK_LCONTROL] & 0x80) || (ks[VK_RCONTROL] & 0x80)) == modifiers.testFlag(Qt::ControlModifier)
-      && bool((ks[VK_LMENU] & 0x80) || (ks[VK_RMENU] & 0x80)) == modifiers.testFlag(Qt::AltModifier)
-      && bool((ks[VK_LWIN] & 0x80) || (ks[VK_RWIN] & 0x80)) == modifiers.testFlag(Qt::MetaModifier)
-      && bool((ks[VK_LSHIFT] & 0x80) || (ks[VK_RSHIFT] & 0x80)) == modifiers.testFlag(Qt::ShiftModifier);   
-}
-
-
-//**********************************************************************************************************************
-/// \brief Check if a keystroke is the manual substitution shortcut.
-///
-/// \return true if and only if keystroke correspond to the shortcut.
-//**********************************************************************************************************************
-bool isComboTriggerShortcut(InputManager::KeyStroke const& keyStroke)
-{
-   return doesKeystrokeMatchShortcut(keyStroke, PreferencesManager::instance().comboTriggerShortcut());
+   Qt::KeyboardModifiers modifiers = Qt::NoModifier;
+   if ((ks[VK_LCONTROL] & 0x80) || (ks[VK_RCONTROL] & 0x80))
+      modifiers |= Qt::ControlModifier;
+   if ((ks[VK_LMENU] & 0x80) || (ks[VK_RMENU] & 0x80))
+      modifiers |= Qt::AltModifier;
+   if ((ks[VK_LWIN] & 0x80) || (ks[VK_RWIN] & 0x80))
+      modifiers |= Qt::MetaModifier;
+   if ((ks[VK_LSHIFT] & 0x80) || (ks[VK_RSHIFT] & 0x80))
+      modifiers |= Qt::ShiftModifier;
+   return Shortcut::nativeKeyCode(modifiers, keyStroke.virtualKey);
 }
 
 
 //**********************************************************************************************************************
-/// \brief Check if a keystroke is the shortcut for the combo picker window.
+/// \brief Check whether a key is a combo breaker that must bypass the normal key processing.
 ///
-/// \return true if and only if keystroke correspond to the shortcut.
+/// \param[in] virtualKey The virtual key code.
+/// \return true if and only if the key is a combo breaker.
 //**********************************************************************************************************************
-bool isComboPickerShortcut(InputManager::KeyStroke const& keyStroke)
+bool isComboBreakerKey(quint32 virtualKey)
 {
-   return doesKeystrokeMatchShortcut(keyStroke, PreferencesManager::instance().comboPickerShortcut());
-}
-
-
-//**********************************************************************************************************************
-/// \brief Check if a keystroke is the shortcut for the app enable/disable shortcut.
-///
-/// \return true if and only if keystroke correspond to the shortcut
-//**********************************************************************************************************************
-bool isAppEnableDisableShortcut(InputManager::KeyStroke const& keyStroke)
-{
-   return doesKeystrokeMatchShortcut(keyStroke, PreferencesManager::instance().appEnableDisableShortcut());
+   // on some layout (e.g. US International, direction key + alt lead to garbage char if ToUnicode is pressed, so
+   // we bypass normal processing for those keys(note this is different for the dead key issue described in
+   // processKey().
+   switch (virtualKey)
+   {
+   case VK_UP: case VK_RIGHT: case VK_DOWN: case VK_LEFT: case VK_PRIOR: case VK_NEXT: case VK_HOME: case VK_END: 
+   case VK_INSERT: case VK_DELETE:
+      return true;
+   default:
+      return false;
+   }
 }
 
 
@@ -115,6 +113,11 @@ LRESULT CALLBACK InputManager::keyboardProcedure(int nCode, WPARAM wParam, LPARA
       KeyStroke keyStroke = { 0, 0, { 0 } };
       KBDLLHOOKSTRUCT* keyEvent = reinterpret_cast<KBDLLHOOKSTRUCT*>(lParam);
 
+      // the events we inject when performing a substitution are tagged, and must not be processed. Other injected
+      // events, such as the ones generated by on-screen keyboards, are processed as usual.
+      if (injectedEventTag == keyEvent->dwExtraInfo)
+         return CallNextHookEx(nullptr, nCode, wParam, lParam);
+
       // we ignore shift / caps lock key events
       if ((keyEvent->vkCode == VK_LSHIFT) || (keyEvent->vkCode == VK_RSHIFT) || (keyEvent->vkCode == VK_CAPITAL))
          return CallNextHookEx(nullptr, nCode, wParam, lParam);
@@ -123,16 +126,12 @@ LRESULT CALLBACK InputManager::keyboardProcedure(int nCode, WPARAM wParam, LPARA
       // GetKeyboardState() do not properly report state for modifier keys if the key event in a window other that one
       // from the current process, so we need to manually fetch the valid states manually using GetKeyState()
       // We do not actually need the state of the other key, so we do not event bother calling GetKeyboardState()
-      QList<quint32> keyList = {
-         VK_SHIFT, VK_LSHIFT, VK_RSHIFT, VK_CONTROL, VK_LCONTROL,
-         VK_RCONTROL, VK_MENU, VK_LMENU, VK_RMENU, VK_RWIN, VK_LWIN, VK_CAPITAL
-      };
-      for (quint32 key: keyList)
+      for (quint32 key: kModifierKeys)
          keyStroke.keyboardState[key] = static_cast<quint8>(GetKeyState(static_cast<quint16>(key)));
 
       // our event handler will return false if we want to 'intercept' the keystroke and not pass it to the next hook,
       // but the MSDN documentation says we MUST do it if nCode < 0
-      if ((!instance().onKeyboardEvent(keyStroke)) && (nCode >= 0))
+      if ((!hookInputManager.load()->onKeyboardEvent(keyStroke)) && (nCode >= 0))
          return 0;
    }
    return CallNextHookEx(nullptr, nCode, wParam, lParam);
@@ -153,12 +152,18 @@ LRESULT CALLBACK InputManager::mouseProcedure(int nCode, WPARAM wParam, LPARAM l
    if ((WM_LBUTTONDOWN == wParam) || (WM_RBUTTONDOWN == wParam) || (WM_MOUSEWHEEL == wParam) ||
       (WM_MBUTTONDOWN == wParam)) // note we consider mouse wheel moves as clicks
    {
-      instance().onMouseClickEvent(nCode, wParam, lParam);
+      hookInputManager.load()->onMouseClickEvent(nCode, wParam, lParam);
    }
    return CallNextHookEx(nullptr, nCode, wParam, lParam);
 }
 
 
+ULONG_PTR const InputManager::injectedEventTag = 0x46454542; // "BEEF" in little-endian ASCII
+
+
+#endif // #ifdef Q_OS_WIN
+
+
 //**********************************************************************************************************************
 /// \return The only allowed instance of the class
 //**********************************************************************************************************************
@@ -174,14 +179,27 @@ InputManager& InputManager::instance()
 //**********************************************************************************************************************
 InputManager::InputManager()
    : QObject(nullptr)
-   , useLegacyKeyProcessing_(!isAppRunningOnWindows10OrHigher())
 {
+   clock_.start();
+   connect(this, &InputManager::comboPickerShortcutTriggered, this, &showComboPickerWindow, Qt::QueuedConnection);
+#ifdef Q_OS_WIN
+   // The low-level hook procedures are called in the thread that installed the hooks, while this thread pumps
+   // messages. Running them in a dedicated thread keeps them responsive when the GUI thread is busy. The matching
+   // engine receives the key events through a lock-free queue, and is notified once per burst of events.
+   useLegacyKeyProcessing_ = !isAppRunningOnWindows10OrHigher();
+   hookInputManager.store(this);
+   hookThread_.setObjectName("KeyboardHookThread");
+   hookThreadContext_.moveToThread(&hookThread_);
+   hookThread_.start(QThread::HighestPriority);
+   if (InputBackend::EType::Win32 != InputBackend::instance().type())
+      return; // other backends feed the key events themselves
    this->enableKeyboardHook();
 #ifdef NDEBUG
    // to avoid being locked with all input unresponsive when in debug (because one forgot that breakpoints should be
    // avoided, for instance), we only enable the low level mouse hook in release configuration
    this->enableMouseHook();
 #endif
+#endif // #ifdef Q_OS_WIN
 }
 
 
@@ -190,19 +208,114 @@ InputManager::InputManager()
 //**********************************************************************************************************************
 InputManager::~InputManager()
 {
+#ifdef Q_OS_WIN
    this->disableKeyboardHook();
    this->disableMouseHook();
+   hookThread_.quit();
+   hookThread_.wait();
+#endif // #ifdef Q_OS_WIN
+}
+
+
+#ifdef Q_OS_WIN
+//**********************************************************************************************************************
+/// If the function is called from the hook thread, it is run immediately. Otherwise the calling thread is blocked until
+/// the hook thread has run the function.
+///
+/// \param[in] function The function
+//**********************************************************************************************************************
+void InputManager::runInHookThread(std::function<void()> const& function)
+{
+   if (QThread::currentThread() == &hookThread_)
+      function();
+   else
+      QMetaObject::invokeMethod(&hookThreadContext_, function, Qt::BlockingQueuedConnection);
+}
+#endif // #ifdef Q_OS_WIN
+
+
+//**********************************************************************************************************************
+/// The queue has a single producer: this function is called from the hook thread, or from the thread of the input
+/// backend when the hooks are not used. The matching engine is notified only if it has not yet been notified of the
+/// events pending in the queue. If the queue is full, the event is dropped and counted, and the next event that makes
+/// it to the queue is flagged, so the matching engine knows where the drop occurred.
+///
+/// \param[in] type The type of event
+/// \param[in] c The character, for events of type Character
+//**********************************************************************************************************************
+void InputManager::pushKeyEvent(EKeyEventType type, QChar c)
+{
+   keyEventsWereDropped_ = !keyEvents_.push({ type, c, keyEventsWereDropped_, clock_.nsecsElapsed() });
+   if (!keyEventsNotificationPending_.exchange(true))
+      emit keyEventsAvailable();
+}
+
+
+//**********************************************************************************************************************
+/// This function must be called from the thread that handles the keyEventsAvailable() signal.
+///
+/// \param[out] outEvent If the function returns true, receives the oldest pending key event
+/// \return true if and only if an event was popped
+//**********************************************************************************************************************
+bool InputManager::popKeyEvent(KeyEvent& outEvent)
+{
+   if (keyEvents_.pop(outEvent))
+      return true;
+   keyEventsNotificationPending_.store(false);
+   return keyEvents_.pop(outEvent); // an event may have been pushed before the flag was cleared
+}
+
+
+//**********************************************************************************************************************
+/// \return The number of pending key events
+//**********************************************************************************************************************
+quint32 InputManager::keyEventQueueDepth() const
+{
+   return keyEvents_.size();
 }
 
 
+//**********************************************************************************************************************
+/// \return The largest number of pending key events so far
+//**********************************************************************************************************************
+quint32 InputManager::maxKeyEventQueueDepth() const
+{
+   return keyEvents_.maxSize();
+}
+
+
+//**********************************************************************************************************************
+/// \return The number of key events that were dropped because the queue was full
+//**********************************************************************************************************************
+quint64 InputManager::droppedKeyEventCount() const
+{
+   return keyEvents_.droppedCount();
+}
+
+
+//**********************************************************************************************************************
+/// This function can be called from any thread.
+///
+/// \return The time elapsed since the creation of the input manager, in nanoseconds
+//**********************************************************************************************************************
+qint64 InputManager::timestampNs() const
+{
+   return clock_.nsecsElapsed();
+}
+
+
+#ifdef Q_OS_WIN
 //**********************************************************************************************************************
 /// \param[in] keyStroke The key stroke
 /// \return true if the event can be passed down to the keyboard hooked chain, and false it it should be removed
 //**********************************************************************************************************************
 bool InputManager::onKeyboardEvent(KeyStroke const& keyStroke)
 {
+   // This function is called for every keystroke, so it performs no heap allocation: shortcuts are compared as plain
+   // key codes and the text resulting from the keystroke is stored in a stack buffer
    PreferencesManager const& prefs = PreferencesManager::instance();
-   if (prefs.enableAppEnableDisableShortcut() && isAppEnableDisableShortcut(keyStroke))
+   quint64 const keyCode = keyStrokeKeyCode(keyStroke);
+   if (prefs.enableAppEnableDisableShortcut() && (keyCode == prefs.appEnableDisableShortcutKeyCode()))
    {
       emit appEnableDisableShortcutTriggered();
       return false;
@@ -211,135 +324,146 @@ bool InputManager::onKeyboardEvent(KeyStroke const& keyStroke)
    if (!prefs.beeftextEnabled())
       return true;
 
-   if ((!prefs.useAutomaticSubstitution()) && isComboTriggerShortcut(keyStroke))
+   if ((!prefs.useAutomaticSubstitution()) && (keyCode == prefs.comboTriggerShortcutKeyCode()))
    {
       emit substitutionShortcutTriggered();
       return false;
    }
 
-   if (prefs.comboPickerEnabled() && isComboPickerShortcut(keyStroke))
+   if (prefs.comboPickerEnabled() && (keyCode == prefs.comboPickerShortcutKeyCode()))
    {
-      showComboPickerWindow();
+      emit comboPickerShortcutTriggered();
       return false;
    }
 
-   // on some layout (e.g. US International, direction key + alt lead to garbage char if ToUnicode is pressed, so
-   // we bypass normal processing for those keys(note this is different for the dead key issue described in
-   // processKey().
-   QList<quint32> const breakers = { VK_UP, VK_RIGHT, VK_DOWN, VK_LEFT, VK_PRIOR, VK_NEXT, VK_HOME, VK_END, VK_INSERT, 
-      VK_DELETE };
-   if (breakers.contains(keyStroke.virtualKey))
+   if (isComboBreakerKey(keyStroke.virtualKey))
    {
-      emit comboBreakerTyped();
+      this->pushKeyEvent(EKeyEventType::ComboBreaker);
       return true;
    }
 
    bool isDeadKey = false;
-   QString text = this->processKey(keyStroke, isDeadKey);
-   if (text.isEmpty())
-      return true;
+   WCHAR text[kTextBufferSize];
+   qint32 const size = this->processKey(keyStroke, text, kTextBufferSize, isDeadKey);
+   for (qint32 i = 0; i < size; ++i)
+      this->pushTypedCharacter(QChar(text[i]));
+   return true;
+}
+#endif // #ifdef Q_OS_WIN
+
 
-   for (QChar c: text)
+//**********************************************************************************************************************
+/// Like pushKeyEvent(), this function must be called from the single producer thread of the queue.
+///
+/// \param[in] c The character
+//**********************************************************************************************************************
+void InputManager::pushTypedCharacter(QChar c)
+{
+   if (QChar('\b') == c)
    {
-      if (QChar('\b') == c)
-      {
-         emit backspaceTyped();
-         continue;
-      }
-      if (!c.isPrint())
-      {
-         emit comboBreakerTyped();
-         continue;
-      }
-      if (c.isSpace())
-      {
-         if (prefs.comboTriggersOnSpace() && prefs.useAutomaticSubstitution())
-            emit characterTyped(c);
-         else
-            emit comboBreakerTyped();
-         continue;
-      }
-      emit characterTyped(c);
+      this->pushKeyEvent(EKeyEventType::Backspace);
+      return;
    }
-   return true;
+   if (!c.isPrint())
+   {
+      this->pushKeyEvent(EKeyEventType::ComboBreaker);
+      return;
+   }
+   if (c.isSpace())
+   {
+      PreferencesManager const& prefs = PreferencesManager::instance();
+      if (prefs.comboTriggersOnSpace() && prefs.useAutomaticSubstitution())
+         this->pushKeyEvent(EKeyEventType::Character, c);
+      else
+         this->pushKeyEvent(EKeyEventType::ComboBreaker);
+      return;
+   }
+   this->pushKeyEvent(EKeyEventType::Character, c);
 }
 
 
+#ifdef Q_OS_WIN
 //**********************************************************************************************************************
 /// \param[in] keyStroke The key stroke
+/// \param[out] outText The buffer that receives the text resulting of the keystroke
+/// \param[in] bufferSize The size of the buffer
 /// \param[out] outIsDeadKey Is the key a dead key
-/// \return The text resulting of the keystroke
+/// \return The number of characters resulting of the keystroke
 //**********************************************************************************************************************
-QString InputManager::processKey(KeyStroke const& keyStroke, bool& outIsDeadKey)
+qint32 InputManager::processKey(KeyStroke const& keyStroke, WCHAR* outText, qint32 bufferSize, bool& outIsDeadKey)
 {
    // Windows version before Windows 10 build 1607, there is not option to ensure that ToUnicode() / ToUnicodeEx does
    // not modify the keyboard state, which forces us to perform a special treatment for dead keys.
-   return useLegacyKeyProcessing_ ? processKeyLegacy(keyStroke, outIsDeadKey) : processKeyModern(keyStroke);
+   return useLegacyKeyProcessing_ ? processKeyLegacy(keyStroke, outText, bufferSize, outIsDeadKey) 
+      : processKeyModern(keyStroke, outText, bufferSize);
 }
 
 
 //**********************************************************************************************************************
 /// \param[in] keyStroke The key stroke
-/// \return The text resulting of the keystroke
+/// \param[out] outText The buffer that receives the text resulting of the keystroke
+/// \param[in] bufferSize The size of the buffer
+/// \return The number of characters resulting of the keystroke
 //**********************************************************************************************************************
-QString InputManager::processKeyModern(KeyStroke const& keyStroke)
+qint32 InputManager::processKeyModern(KeyStroke const& keyStroke, WCHAR* outText, qint32 bufferSize)
 {
    // Windows allow each window to have its own input locale, so we try to obtain the locale (HKL) of the active window
    // and pass it to ToUnicodeEx(). If we fail to do so we call ToUnicode instead, which use the system-wide locale
-   WCHAR textBuffer[kTextBufferSize];
    HKL hkl = nullptr;
    qint32 const size = getForegroundWindowInputLocale(hkl)
-      ? ToUnicodeEx(keyStroke.virtualKey, keyStroke.scanCode, keyStroke.keyboardState, textBuffer, kTextBufferSize
-         , 1 << 2, hkl) : ToUnicode(keyStroke.virtualKey, keyStroke.scanCode, keyStroke.keyboardState, textBuffer
-         , kTextBufferSize, 1 << 2);
-   return size > 0 ? QString::fromWCharArray(textBuffer, size): QString();
+      ? ToUnicodeEx(keyStroke.virtualKey, keyStroke.scanCode, keyStroke.keyboardState, outText, bufferSize
+         , 1 << 2, hkl) : ToUnicode(keyStroke.virtualKey, keyStroke.scanCode, keyStroke.keyboardState, outText
+         , bufferSize, 1 << 2);
+   return qMax(size, 0);
 }
 
 
 //**********************************************************************************************************************
 /// \param[in] keyStroke The key stroke
+/// \param[out] outText The buffer that receives the text resulting of the keystroke
+/// \param[in] bufferSize The size of the buffer
 /// \param[out] outIsDeadKey Is the key a dead key
-/// \return The text resulting of the keystroke
+/// \return The number of characters resulting of the keystroke
 //**********************************************************************************************************************
-QString InputManager::processKeyLegacy(KeyStroke const& keyStroke, bool& outIsDeadKey)
+qint32 InputManager::processKeyLegacy(KeyStroke const& keyStroke, WCHAR* outText, qint32 bufferSize, 
+   bool& outIsDeadKey)
 {
    // The core of this function is the call to ToUnicodeEx() - or ToUnicode() - who transforms a keystroke into 
    // an actual text output, taking into account the current input locale (a.k.a. keyboard layout).
    // now the tricky part: ToUnicode() "consumes" the dead key that may be stored in the kernel-mode keyboard buffer
    // so we need to manually restore the dead key by calling ToUnicode() again
-   WCHAR textBuffer[kTextBufferSize] = { 0 };
+   WCHAR scratchBuffer[kTextBufferSize] = { 0 };
    outIsDeadKey = false;
    // for some unkown reasons, in this legacy code ToUnicodeEx cause failures with dead keys in some locales.
-   qint32 const size = ToUnicode(keyStroke.virtualKey, keyStroke.scanCode, keyStroke.keyboardState, textBuffer, 
-      kTextBufferSize, 0);
+   qint32 const size = ToUnicode(keyStroke.virtualKey, keyStroke.scanCode, keyStroke.keyboardState, outText, 
+      bufferSize, 0);
 
    if (-1 == size)
    {
       // the key is a dead key. We have consumed it so we need to:
       // 1 - Restore it by repeating the call to ToUnicode()
       // 2 - Save the key because we will need to apply it again before the next 'normal' keystroke
-      ToUnicode(keyStroke.virtualKey, keyStroke.scanCode, keyStroke.keyboardState, textBuffer, kTextBufferSize, 0);
+      ToUnicode(keyStroke.virtualKey, keyStroke.scanCode, keyStroke.keyboardState, scratchBuffer, kTextBufferSize, 0);
       deadKey_ = keyStroke;
       outIsDeadKey = true;
-      return QString();
+      return 0;
    }
 
    if (size > 0)
    {
       // The key is a normal key that will result in text output.
       // if the previous key was a dead key, we have already consumed the dead key so we must restore it 
-      QString result = QString::fromWCharArray(textBuffer, size);
       if (0 != deadKey_.virtualKey)
       {
-         ToUnicode(deadKey_.virtualKey, deadKey_.scanCode, deadKey_.keyboardState, textBuffer, kTextBufferSize, 0);
+         ToUnicode(deadKey_.virtualKey, deadKey_.scanCode, deadKey_.keyboardState, scratchBuffer, kTextBufferSize, 0);
          deadKey_.virtualKey = 0;
       }
-      return result;
+      return size;
    }
 
    // final case: size is 0, the key is a modifier, we do nothing
    // values of size < -1 also lead here but should not happen according to the documentation for ToUnicode()
-   return QString();
+   return 0;
 }
 
 
@@ -348,7 +472,7 @@ QString InputManager::processKeyLegacy(KeyStroke const& keyStroke, bool& outIsDe
 //**********************************************************************************************************************
 void InputManager::onMouseClickEvent(int, WPARAM, LPARAM)
 {
-   emit comboBreakerTyped();
+   this->pushKeyEvent(EKeyEventType::ComboBreaker);
 }
 
 
@@ -369,7 +493,8 @@ void InputManager::enableKeyboardHook()
    if (keyboardHook_)
       return;
    HMODULE const moduleHandle = GetModuleHandle(nullptr);
-   keyboardHook_ = SetWindowsHookEx(WH_KEYBOARD_LL, keyboardProcedure, moduleHandle, 0);
+   this->runInHookThread([&]()
+      { keyboardHook_ = SetWindowsHookEx(WH_KEYBOARD_LL, keyboardProcedure, moduleHandle, 0); });
    if (!keyboardHook_)
       throw Exception("Could not register a keyboard hook.");
 }
@@ -382,7 +507,7 @@ void InputManager::disableKeyboardHook()
 {
    if (keyboardHook_)
    {
-      UnhookWindowsHookEx(keyboardHook_);
+      this->runInHookThread([&]() { UnhookWindowsHookEx(keyboardHook_); });
       keyboardHook_ = nullptr;
    }
 }
@@ -420,7 +545,7 @@ void InputManager::enableMouseHook()
    if (mouseHook_)
       return;
    HMODULE const moduleHandle = GetModuleHandle(nullptr);
-   mouseHook_ = SetWindowsHookEx(WH_MOUSE_LL, mouseProcedure, moduleHandle, 0);
+   this->runInHookThread([&]() { mouseHook_ = SetWindowsHookEx(WH_MOUSE_LL, mouseProcedure, moduleHandle, 0); });
    if (!mouseHook_)
       throw Exception("Could not register a mouse hook.");
 }
@@ -433,7 +558,7 @@ void InputManager::disableMouseHook()
 {
    if (mouseHook_)
    {
-      UnhookWindowsHookEx(mouseHook_);
+      this->runInHookThread([&]() { UnhookWindowsHookEx(mouseHook_); });
       mouseHook_ = nullptr;
    }
 }
@@ -452,3 +577,6 @@ bool InputManager::setMouseHookEnabled(bool enabled)
       this->disableMouseHook();
    return result;
 }
+
+
+#endif // #ifdef Q_OS_WIN
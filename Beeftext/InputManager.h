@@ -12,6 +12,7 @@
 
 
 #include "BeeftextUtils.h"
+#include "SpscRingBuffer.h"
 
 
 //**********************************************************************************************************************
@@ -23,41 +24,71 @@ class InputManager : public QObject
 public: // data types
    enum { 
       KeyboardStateSize = 256, ///< The size of the keyboard state array
+      KeyEventQueueCapacity = 1024, ///< The capacity of the queue of key events
    }; 
    struct KeyStroke {
       quint32 virtualKey; ///< The virtual keyCode
       quint32 scanCode; ///< The scanCode
       quint8 keyboardState[KeyboardStateSize]; ///< The state of the keyboard at the moment the keystroke occurred
    };
+   enum class EKeyEventType: quint8 {
+      Character, ///< A character was typed
+      Backspace, ///< Backspace was typed
+      ComboBreaker, ///< A key or mouse event breaking the current combo occurred
+   }; ///< Enumeration for the type of key events
+   struct KeyEvent {
+      EKeyEventType type { EKeyEventType::ComboBreaker }; ///< The type of event
+      QChar character; ///< The character, for events of type Character
+      bool followsDrop { false }; ///< Were key events dropped between the previous event in the queue and this one
+      qint64 timestampNs { 0 }; ///< The time the event was pushed, as returned by timestampNs()
+   }; ///< A compact key event, as passed from the hook thread to the matching engine
+#ifdef Q_OS_WIN
+public: // static data members
+   static ULONG_PTR const injectedEventTag; ///< The extra information attached to the input events injected by Beeftext
+#endif // #ifdef Q_OS_WIN
+
 public: // static member functions
    static InputManager& instance(); ///< Return the only allowed instance of the class
 
+public: // friends
+   friend class InputManagerTests;
+
 public: // member functions
    InputManager(InputManager const&) = delete; ///< Disabled copy constructor
    InputManager(InputManager&&) = delete; ///< Disabled move constructor
    ~InputManager(); ///< Default destructor
    InputManager& operator=(InputManager const&) = delete; ///< Disabled assignment operator
    InputManager& operator=(InputManager&&) = delete; ///< Disabled move assignment operator
+#ifdef Q_OS_WIN
+   bool isKeyboardHookEnable() const; ///< Is the keyboard hook enabled
+   bool setKeyboardHookEnabled(bool enabled); ///< Enable or disable the keyboard hook
+#endif // #ifdef Q_OS_WIN
+   void pushKeyEvent(EKeyEventType type, QChar c = QChar()); ///< Push a key event to the queue
+   void pushTypedCharacter(QChar c); ///< Push the key event corresponding to a typed character
+   bool popKeyEvent(KeyEvent& outEvent); ///< Pop the oldest pending key event
+   quint32 keyEventQueueDepth() const; ///< Return the number of pending key events
+   quint32 maxKeyEventQueueDepth() const; ///< Return the largest number of pending key events so far
+   quint64 droppedKeyEventCount() const; ///< Return the number of key events dropped because the queue was full
+   qint64 timestampNs() const; ///< Return the time elapsed since the creation of the input manager
 
 signals:
-   void comboBreakerTyped(); ///< Signal for combo breaking events
-   void characterTyped(QChar c); ///< Signal for character typed
-   void backspaceTyped(); ///< Signal for backspace typed
+   void keyEventsAvailable(); ///< Signal emitted when key events are pushed to an empty queue
    void substitutionShortcutTriggered();  ///< Signal emitted when the manual substitution shortcut is triggered
    void comboMenuShortcutTriggered(); ///< Signal emitted when the combo menu shortcut is triggered.
    void appEnableDisableShortcutTriggered(); ///< Signal emitted when the app enable/disable shortcut has been triggered.
+   void comboPickerShortcutTriggered(); ///< Signal emitted when the combo picker shortcut has been triggered.
 
 private: // member functions
    InputManager(); ///< Default constructor
+#ifdef Q_OS_WIN
+   void runInHookThread(std::function<void()> const& function); ///< Synchronously run a function in the hook thread
    bool onKeyboardEvent(KeyStroke const& keyStroke); ///< The callback function called at every key event
-   QString processKey(KeyStroke const& keyStroke, bool& outIsDeadKey); ///< Process a key stroke and return the generated characters 
-   static QString processKeyModern(KeyStroke const& keyStroke); ///< Process a key stroke and return the generated characters 
-   QString processKeyLegacy(KeyStroke const& keyStroke, bool& outIsDeadKey); ///< Process a key stroke and return the generated characters 
+   qint32 processKey(KeyStroke const& keyStroke, WCHAR* outText, qint32 bufferSize, bool& outIsDeadKey); ///< Process a key stroke and store the generated characters 
+   static qint32 processKeyModern(KeyStroke const& keyStroke, WCHAR* outText, qint32 bufferSize); ///< Process a key stroke and store the generated characters 
+   qint32 processKeyLegacy(KeyStroke const& keyStroke, WCHAR* outText, qint32 bufferSize, bool& outIsDeadKey); ///< Process a key stroke and store the generated characters 
    void onMouseClickEvent(int, WPARAM, LPARAM); ///< Process a mouse click event
-   bool isKeyboardHookEnable() const; ///< Is the keyboard hook enabled
    void enableKeyboardHook(); ///< Enable the keyboard hook
    void disableKeyboardHook(); ///< Disable the keyboard hook
-   bool setKeyboardHookEnabled(bool enabled); ///< Enable or disable the keyboard hook
    bool isMouseHookEnabled() const; ///< Is the mouse hook enabled
    void enableMouseHook(); ///< Enable the mouse hook
    void disableMouseHook(); ///< Disable the mouse hook
@@ -66,16 +97,21 @@ private: // member functions
 private: // static member functions
    static LRESULT CALLBACK keyboardProcedure(int nCode, WPARAM wParam, LPARAM lParam); ///< The keyboard event callback
    static LRESULT CALLBACK mouseProcedure(int nCode, WPARAM wParam, LPARAM lParam); ///< The mouse event callback
-
-
-   friend void performTextSubstitution(qint32 charCount, QString const& newText, qint32 cursorPos,
-      ETriggerSource source);
+#endif // #ifdef Q_OS_WIN
 
 private: // data members
+   SpscRingBuffer<KeyEvent, KeyEventQueueCapacity> keyEvents_; ///< The queue of key events for the matching engine
+   std::atomic<bool> keyEventsNotificationPending_ { false }; ///< Was keyEventsAvailable() emitted and not handled yet
+   bool keyEventsWereDropped_ { false }; ///< Were key events dropped since the last event pushed, used by the producer only
+   QElapsedTimer clock_; ///< The clock used to timestamp key events
+#ifdef Q_OS_WIN
+   QThread hookThread_; ///< The thread the hooks are installed in, and whose event loop runs the hook procedures
+   QObject hookThreadContext_; ///< An object living in the hook thread, used to invoke functions in this thread
    HHOOK keyboardHook_ { nullptr }; ///< The handle to the keyboard hook used to be notified of keyboard events
    HHOOK mouseHook_ { nullptr }; ///< The handle to the mouse hook used to be notified of mouse event
    KeyStroke deadKey_ = { 0, 0, { 0 } }; ///< The currently active dead key
    bool useLegacyKeyProcessing_ { false }; ///< Should we use the legacy key processing code
+#endif // #ifdef Q_OS_WIN
 };
 
 
@@ -0,0 +1,218 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of keystroke trace recording and file functions
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "KeystrokeTrace.h"
+
+
+namespace {
+
+
+quint32 const kFileMagic = 0x4B544642; ///< The magic number at the beginning of keystroke trace files ("BFTK")
+quint8 const kFileVersion = 1; ///< The version of the keystroke trace file format
+quint8 const kLastEventKind = static_cast<quint8>(EKeystrokeTraceEventKind::Match); ///< The last valid event kind
+
+
+//**********************************************************************************************************************
+/// \param[in] c The character
+/// \return The kind of trace event for the character
+//**********************************************************************************************************************
+EKeystrokeTraceEventKind eventKindForCharacter(QChar c)
+{
+   if (c.isSpace())
+      return EKeystrokeTraceEventKind::Space;
+   if (c.isLetter())
+      return EKeystrokeTraceEventKind::Letter;
+   if (c.isDigit())
+      return EKeystrokeTraceEventKind::Digit;
+   return EKeystrokeTraceEventKind::Symbol;
+}
+
+
+} // anonymous namespace
+
+
+//**********************************************************************************************************************
+/// The file starts with a magic number, a version and the event count, followed by the events. Each event is stored
+/// as its kind and delay, and Match events also store the keyword length.
+///
+/// \param[in] trace The trace
+/// \param[in] path The path of the file
+/// \param[out] outErrorMessage If the function returns false and this parameter is not null, receives a description
+/// of the error
+/// \return true if and only if the trace was successfully saved
+//**********************************************************************************************************************
+bool saveKeystrokeTrace(KeystrokeTrace const& trace, QString const& path, QString* outErrorMessage)
+{
+   QFile file(path);
+   if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+   {
+      if (outErrorMessage)
+         *outErrorMessage = QString("Could not open file for writing: '%1'").arg(QDir::toNativeSeparators(path));
+      return false;
+   }
+   QDataStream stream(&file);
+   stream << kFileMagic << kFileVersion << static_cast<quint32>(trace.size());
+   for (KeystrokeTraceEvent const& event: trace)
+   {
+      stream << static_cast<quint8>(event.kind) << event.delayUs;
+      if (EKeystrokeTraceEventKind::Match == event.kind)
+         stream << event.keywordLength;
+   }
+   if (stream.status() != QDataStream::Ok)
+   {
+      if (outErrorMessage)
+         *outErrorMessage = QString("An error occurred while writing file '%1'").arg(QDir::toNativeSeparators(path));
+      return false;
+   }
+   return true;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] path The path of the file
+/// \param[out] outTrace The trace
+/// \param[out] outErrorMessage If the function returns false and this parameter is not null, receives a description
+/// of the error
+/// \return true if and only if the trace was successfully loaded
+//**********************************************************************************************************************
+bool loadKeystrokeTrace(QString const& path, KeystrokeTrace& outTrace, QString* outErrorMessage)
+{
+   outTrace.clear();
+   QFile file(path);
+   if (!file.open(QIODevice::ReadOnly))
+   {
+      if (outErrorMessage)
+         *outErrorMessage = QString("Could not open file for reading: '%1'").arg(QDir::toNativeSeparators(path));
+      return false;
+   }
+   QDataStream stream(&file);
+   quint32 magic = 0, count = 0;
+   quint8 version = 0;
+   stream >> magic >> version >> count;
+   if ((stream.status() != QDataStream::Ok) || (kFileMagic != magic) || (version > kFileVersion))
+   {
+      if (outErrorMessage)
+         *outErrorMessage = QString("'%1' is not a valid keystroke trace file.").arg(QDir::toNativeSeparators(path));
+      return false;
+   }
+   KeystrokeTrace trace;
+   trace.reserve(static_cast<qint32>(qMin<quint32>(count, 1 << 24)));
+   for (quint32 i = 0; i < count; ++i)
+   {
+      quint8 kind = 0;
+      KeystrokeTraceEvent event;
+      stream >> kind >> event.delayUs;
+      if (kind > kLastEventKind)
+         break;
+      event.kind = static_cast<EKeystrokeTraceEventKind>(kind);
+      if (EKeystrokeTraceEventKind::Match == event.kind)
+         stream >> event.keywordLength;
+      trace.append(event);
+   }
+   if ((stream.status() != QDataStream::Ok) || (static_cast<quint32>(trace.size()) != count))
+   {
+      if (outErrorMessage)
+         *outErrorMessage = QString("The keystroke trace file '%1' is corrupted.").arg(QDir::toNativeSeparators(path));
+      return false;
+   }
+   outTrace = trace;
+   return true;
+}
+
+
+//**********************************************************************************************************************
+/// \return The only allowed instance of the class
+//**********************************************************************************************************************
+KeystrokeTraceRecorder& KeystrokeTraceRecorder::instance()
+{
+   static KeystrokeTraceRecorder instance;
+   return instance;
+}
+
+
+//**********************************************************************************************************************
+/// \return true if and only if a recording is in progress
+//**********************************************************************************************************************
+bool KeystrokeTraceRecorder::isRecording() const
+{
+   return recording_;
+}
+
+
+//**********************************************************************************************************************
+// 
+//**********************************************************************************************************************
+void KeystrokeTraceRecorder::start()
+{
+   trace_.clear();
+   lastTimestampNs_ = -1;
+   recording_ = true;
+}
+
+
+//**********************************************************************************************************************
+/// \return The recorded trace
+//**********************************************************************************************************************
+KeystrokeTrace KeystrokeTraceRecorder::stop()
+{
+   recording_ = false;
+   KeystrokeTrace result;
+   std::swap(result, trace_);
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] event The key event
+//**********************************************************************************************************************
+void KeystrokeTraceRecorder::recordKeyEvent(InputManager::KeyEvent const& event)
+{
+   if (!recording_)
+      return;
+   if (event.followsDrop)
+      this->append(EKeystrokeTraceEventKind::ComboBreaker, event.timestampNs);
+   switch (event.type)
+   {
+   case InputManager::EKeyEventType::Character:
+      this->append(eventKindForCharacter(event.character), event.timestampNs);
+      break;
+   case InputManager::EKeyEventType::Backspace:
+      this->append(EKeystrokeTraceEventKind::Backspace, event.timestampNs);
+      break;
+   case InputManager::EKeyEventType::ComboBreaker:
+   default:
+      this->append(EKeystrokeTraceEventKind::ComboBreaker, event.timestampNs);
+      break;
+   }
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] keywordLength The length of the keyword of the triggered combo
+//**********************************************************************************************************************
+void KeystrokeTraceRecorder::recordMatch(qint32 keywordLength)
+{
+   if (recording_)
+      this->append(EKeystrokeTraceEventKind::Match, InputManager::instance().timestampNs(), keywordLength);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] kind The kind of event
+/// \param[in] timestampNs The timestamp of the event, as returned by InputManager::timestampNs()
+/// \param[in] keywordLength For Match events, the length of the keyword of the triggered combo
+//**********************************************************************************************************************
+void KeystrokeTraceRecorder::append(EKeystrokeTraceEventKind kind, qint64 timestampNs, qint32 keywordLength)
+{
+   qint64 const delayUs = (lastTimestampNs_ < 0) ? 0 : qMax<qint64>(0, timestampNs - lastTimestampNs_) / 1000;
+   lastTimestampNs_ = timestampNs;
+   trace_.append({ kind, static_cast<quint32>(qMin<qint64>(delayUs, std::numeric_limits<quint32>::max())),
+      static_cast<quint8>(qBound(0, keywordLength, 255)) });
+}
@@ -0,0 +1,83 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of keystroke trace recording and file functions
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_KEYSTROKE_TRACE_H
+#define BEEFTEXT_KEYSTROKE_TRACE_H
+
+
+#include "InputManager.h"
+
+
+//**********************************************************************************************************************
+/// \brief Enumeration for the kind of events in a keystroke trace
+///
+/// Traces are anonymized: typed characters are only recorded by category.
+//**********************************************************************************************************************
+enum class EKeystrokeTraceEventKind: quint8
+{
+   Letter, ///< A letter was typed
+   Digit, ///< A digit was typed
+   Symbol, ///< Another printable character was typed
+   Space, ///< A space was typed
+   Backspace, ///< Backspace was typed
+   ComboBreaker, ///< A combo breaker event occurred
+   Match, ///< A combo was triggered. This event is a marker, and is not replayed
+};
+
+
+//**********************************************************************************************************************
+/// \brief An event in a keystroke trace
+//**********************************************************************************************************************
+struct KeystrokeTraceEvent
+{
+   EKeystrokeTraceEventKind kind { EKeystrokeTraceEventKind::ComboBreaker }; ///< The kind of event
+   quint32 delayUs { 0 }; ///< The delay since the previous event, in microseconds
+   quint8 keywordLength { 0 }; ///< For Match events, the length of the keyword of the triggered combo
+};
+
+
+typedef QVector<KeystrokeTraceEvent> KeystrokeTrace; ///< Type definition for keystroke traces
+
+
+bool saveKeystrokeTrace(KeystrokeTrace const& trace, QString const& path, QString* outErrorMessage = nullptr); ///< Save a keystroke trace to file
+bool loadKeystrokeTrace(QString const& path, KeystrokeTrace& outTrace, QString* outErrorMessage = nullptr); ///< Load a keystroke trace from file
+
+
+//**********************************************************************************************************************
+/// \brief A class recording the key events processed by the combo manager into an anonymized keystroke trace
+//**********************************************************************************************************************
+class KeystrokeTraceRecorder
+{
+public: // static member functions
+   static KeystrokeTraceRecorder& instance(); ///< Return the only allowed instance of the class
+
+public: // member functions
+   KeystrokeTraceRecorder(KeystrokeTraceRecorder const&) = delete; ///< Disabled copy constructor
+   KeystrokeTraceRecorder(KeystrokeTraceRecorder&&) = delete; ///< Disabled move constructor
+   ~KeystrokeTraceRecorder() = default; ///< Default destructor
+   KeystrokeTraceRecorder& operator=(KeystrokeTraceRecorder const&) = delete; ///< Disabled assignment operator
+   KeystrokeTraceRecorder& operator=(KeystrokeTraceRecorder&&) = delete; ///< Disabled move assignment operator
+   bool isRecording() const; ///< Check whether a recording is in progress
+   void start(); ///< Start a new recording
+   KeystrokeTrace stop(); ///< Stop the recording and return the recorded trace
+   void recordKeyEvent(InputManager::KeyEvent const& event); ///< Record a key event
+   void recordMatch(qint32 keywordLength); ///< Record the triggering of a combo
+
+private: // member functions
+   KeystrokeTraceRecorder() = default; ///< Default constructor
+   void append(EKeystrokeTraceEventKind kind, qint64 timestampNs, qint32 keywordLength = 0); ///< Append an event
+
+private: // data members
+   bool recording_ { false }; ///< Is a recording in progress
+   KeystrokeTrace trace_; ///< The trace being recorded
+   qint64 lastTimestampNs_ { -1 }; ///< The timestamp of the last recorded event, or -1 if there is none
+};
+
+
+#endif // #ifndef BEEFTEXT_KEYSTROKE_TRACE_H
@@ -0,0 +1,133 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the substitution latency diagnostics dialog class
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "LatencyDiagnosticsDialog.h"
+#include "SubstitutionLatencyMonitor.h"
+#include "InputManager.h"
+#include "BeeftextConstants.h"
+#include <XMiLib/XMiLibConstants.h>
+
+
+namespace {
+
+
+qint32 const kRefreshIntervalMs = 1000; ///< The interval between refreshes of the statistics
+
+
+//**********************************************************************************************************************
+/// \param[in] durationNs The duration in nanoseconds
+/// \return A human readable string for the duration
+//**********************************************************************************************************************
+QString durationString(double durationNs)
+{
+   if (durationNs < 1000000.0)
+      return QString("%1 us").arg(durationNs / 1000.0, 0, 'f', 1);
+   return QString("%1 ms").arg(durationNs / 1000000.0, 0, 'f', 2);
+}
+
+
+} // anonymous namespace
+
+
+//**********************************************************************************************************************
+/// \param[in] parent The parent widget of the dialog
+//**********************************************************************************************************************
+LatencyDiagnosticsDialog::LatencyDiagnosticsDialog(QWidget* parent)
+   : QDialog(parent, xmilib::constants::kDefaultDialogFlags)
+{
+   this->setWindowTitle(tr("Substitution Latency"));
+   QStringList const headers = { tr("Count"), tr("Mean"), tr("p50"), tr("p90"), tr("p99"), tr("Max") };
+   qint32 const phaseCount = static_cast<qint32>(ESubstitutionPhase::Count);
+   table_ = new QTableWidget(phaseCount, headers.size(), this);
+   table_->setHorizontalHeaderLabels(headers);
+   table_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+   table_->setSelectionMode(QAbstractItemView::NoSelection);
+   for (qint32 row = 0; row < phaseCount; ++row)
+   {
+      table_->setVerticalHeaderItem(row, new QTableWidgetItem(SubstitutionLatencyMonitor::phaseName(
+         static_cast<ESubstitutionPhase>(row))));
+      for (qint32 column = 0; column < headers.size(); ++column)
+      {
+         QTableWidgetItem* item = new QTableWidgetItem;
+         item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+         table_->setItem(row, column, item);
+      }
+   }
+   queueLabel_ = new QLabel(this);
+
+   QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+   QPushButton* resetButton = buttonBox->addButton(tr("&Reset"), QDialogButtonBox::ResetRole);
+   QPushButton* exportButton = buttonBox->addButton(tr("&Export..."), QDialogButtonBox::ActionRole);
+   connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+   connect(resetButton, &QPushButton::clicked, this, &LatencyDiagnosticsDialog::onReset);
+   connect(exportButton, &QPushButton::clicked, this, &LatencyDiagnosticsDialog::onExport);
+
+   QVBoxLayout* layout = new QVBoxLayout(this);
+   layout->addWidget(table_);
+   layout->addWidget(queueLabel_);
+   layout->addWidget(buttonBox);
+
+   this->onRefresh();
+   table_->resizeColumnsToContents();
+   this->resize(table_->verticalHeader()->width() + table_->horizontalHeader()->length() + 60,
+      this->sizeHint().height());
+   connect(&refreshTimer_, &QTimer::timeout, this, &LatencyDiagnosticsDialog::onRefresh);
+   refreshTimer_.start(kRefreshIntervalMs);
+}
+
+
+//**********************************************************************************************************************
+// 
+//**********************************************************************************************************************
+void LatencyDiagnosticsDialog::onRefresh() const
+{
+   SubstitutionLatencyMonitor const& monitor = SubstitutionLatencyMonitor::instance();
+   for (qint32 row = 0; row < static_cast<qint32>(ESubstitutionPhase::Count); ++row)
+   {
+      LatencyHistogram const& histogram = monitor.histogram(static_cast<ESubstitutionPhase>(row));
+      bool const empty = (0 == histogram.count());
+      table_->item(row, 0)->setText(QString::number(histogram.count()));
+      table_->item(row, 1)->setText(empty ? QString() : durationString(histogram.mean()));
+      table_->item(row, 2)->setText(empty ? QString() : durationString(histogram.percentile(50.0)));
+      table_->item(row, 3)->setText(empty ? QString() : durationString(histogram.percentile(90.0)));
+      table_->item(row, 4)->setText(empty ? QString() : durationString(histogram.percentile(99.0)));
+      table_->item(row, 5)->setText(empty ? QString() : durationString(histogram.max()));
+   }
+   InputManager const& inputManager = InputManager::instance();
+   queueLabel_->setText(tr("Key event queue: %1 pending, %2 at most, %3 dropped.")
+      .arg(inputManager.keyEventQueueDepth()).arg(inputManager.maxKeyEventQueueDepth())
+      .arg(inputManager.droppedKeyEventCount()));
+}
+
+
+//**********************************************************************************************************************
+// 
+//**********************************************************************************************************************
+void LatencyDiagnosticsDialog::onReset() const
+{
+   SubstitutionLatencyMonitor::instance().reset();
+   this->onRefresh();
+}
+
+
+//**********************************************************************************************************************
+// 
+//**********************************************************************************************************************
+void LatencyDiagnosticsDialog::onExport()
+{
+   QString const path = QFileDialog::getSaveFileName(this, tr("Export Latency Histograms"),
+      QDir(QStandardPaths::writableLocation(QStandardPaths::DesktopLocation))
+      .absoluteFilePath("BeeftextLatency.json"), constants::jsonFileDialogFilter());
+   if (path.isEmpty())
+      return;
+   QString errMsg;
+   if (!SubstitutionLatencyMonitor::instance().saveToJsonFile(path, &errMsg))
+      QMessageBox::critical(this, tr("Error"), errMsg);
+}
@@ -0,0 +1,40 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of the substitution latency diagnostics dialog class
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_LATENCY_DIAGNOSTICS_DIALOG_H
+#define BEEFTEXT_LATENCY_DIAGNOSTICS_DIALOG_H
+
+
+//**********************************************************************************************************************
+/// \brief A dialog displaying the latency histograms of the substitution phases and the key event queue statistics
+//**********************************************************************************************************************
+class LatencyDiagnosticsDialog: public QDialog
+{
+   Q_OBJECT
+public: // member functions
+   explicit LatencyDiagnosticsDialog(QWidget* parent = nullptr); ///< Default constructor
+   LatencyDiagnosticsDialog(LatencyDiagnosticsDialog const&) = delete; ///< Disabled copy constructor
+   LatencyDiagnosticsDialog(LatencyDiagnosticsDialog&&) = delete; ///< Disabled move constructor
+   ~LatencyDiagnosticsDialog() override = default; ///< Default destructor
+   LatencyDiagnosticsDialog& operator=(LatencyDiagnosticsDialog const&) = delete; ///< Disabled assignment operator
+   LatencyDiagnosticsDialog& operator=(LatencyDiagnosticsDialog&&) = delete; ///< Disabled move assignment operator
+
+private slots:
+   void onRefresh() const; ///< Refresh the displayed statistics
+   void onReset() const; ///< Slot for the 'Reset' button
+   void onExport(); ///< Slot for the 'Export' button
+
+private: // data members
+   QTableWidget* table_ { nullptr }; ///< The table displaying the histograms
+   QLabel* queueLabel_ { nullptr }; ///< The label displaying the key event queue statistics
+   QTimer refreshTimer_; ///< The timer used to refresh the statistics
+};
+
+
+#endif // #ifndef BEEFTEXT_LATENCY_DIAGNOSTICS_DIALOG_H
@@ -0,0 +1,174 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of latency histogram class
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "LatencyHistogram.h"
+#include <cmath>
+
+
+namespace {
+
+
+QString const kKeyCount = "count"; ///< The JSON key for the number of recorded durations
+QString const kKeyMin = "minNs"; ///< The JSON key for the smallest recorded duration
+QString const kKeyMax = "maxNs"; ///< The JSON key for the largest recorded duration
+QString const kKeyMean = "meanNs"; ///< The JSON key for the mean duration
+QString const kKeyPercentiles = "percentilesNs"; ///< The JSON key for the percentiles
+QString const kKeyBuckets = "buckets"; ///< The JSON key for the non-empty buckets
+QString const kKeyLowerBound = "lowerNs"; ///< The JSON key for the lower bound of a bucket
+QString const kKeyUpperBound = "upperNs"; ///< The JSON key for the upper bound of a bucket
+QList<double> const kExportedPercentiles = { 50.0, 90.0, 95.0, 99.0, 99.9 }; ///< The percentiles included in exports
+
+
+} // anonymous namespace
+
+
+//**********************************************************************************************************************
+/// \param[in] durationNs The duration in nanoseconds. Negative values are counted as zero.
+//**********************************************************************************************************************
+void LatencyHistogram::record(qint64 durationNs)
+{
+   durationNs = qMax<qint64>(0, durationNs);
+   ++counts_[static_cast<size_t>(bucketIndex(durationNs))];
+   min_ = count_ ? qMin(min_, durationNs) : durationNs;
+   max_ = count_ ? qMax(max_, durationNs) : durationNs;
+   ++count_;
+   sum_ += static_cast<double>(durationNs);
+}
+
+
+//**********************************************************************************************************************
+// 
+//**********************************************************************************************************************
+void LatencyHistogram::reset()
+{
+   *this = LatencyHistogram();
+}
+
+
+//**********************************************************************************************************************
+/// \return The number of recorded durations
+//**********************************************************************************************************************
+quint64 LatencyHistogram::count() const
+{
+   return count_;
+}
+
+
+//**********************************************************************************************************************
+/// \return The smallest recorded duration, in nanoseconds, or 0 if the histogram is empty
+//**********************************************************************************************************************
+qint64 LatencyHistogram::min() const
+{
+   return min_;
+}
+
+
+//**********************************************************************************************************************
+/// \return The largest recorded duration, in nanoseconds, or 0 if the histogram is empty
+//**********************************************************************************************************************
+qint64 LatencyHistogram::max() const
+{
+   return max_;
+}
+
+
+//**********************************************************************************************************************
+/// \return The mean of the recorded durations, in nanoseconds, or 0 if the histogram is empty
+//**********************************************************************************************************************
+double LatencyHistogram::mean() const
+{
+   return count_ ? sum_ / static_cast<double>(count_) : 0.0;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] percentile The percentile, between 0 and 100
+/// \return The largest duration counted in the bucket containing the percentile, in nanoseconds, or 0 if the
+/// histogram is empty
+//**********************************************************************************************************************
+qint64 LatencyHistogram::percentile(double percentile) const
+{
+   if (!count_)
+      return 0;
+   quint64 const rank = qMax<quint64>(1, static_cast<quint64>(std::ceil(qBound(0.0, percentile, 100.0) * 0.01 *
+      static_cast<double>(count_))));
+   quint64 cumulativeCount = 0;
+   for (qint32 i = 0; i < BucketCount; ++i)
+   {
+      cumulativeCount += counts_[static_cast<size_t>(i)];
+      if (cumulativeCount >= rank)
+         return qBound(min_, bucketUpperBound(i), max_);
+   }
+   return max_;
+}
+
+
+//**********************************************************************************************************************
+/// \return A JSON object describing the histogram
+//**********************************************************************************************************************
+QJsonObject LatencyHistogram::toJsonObject() const
+{
+   QJsonObject percentiles;
+   for (double const p: kExportedPercentiles)
+      percentiles.insert(QString("p%1").arg(p), this->percentile(p));
+   QJsonArray buckets;
+   for (qint32 i = 0; i < BucketCount; ++i)
+   {
+      quint64 const count = counts_[static_cast<size_t>(i)];
+      if (count)
+         buckets.append(QJsonObject({ { kKeyLowerBound, bucketLowerBound(i) }, { kKeyUpperBound, bucketUpperBound(i) },
+            { kKeyCount, static_cast<qint64>(count) } }));
+   }
+   return QJsonObject({ { kKeyCount, static_cast<qint64>(count_) }, { kKeyMin, min_ }, { kKeyMax, max_ },
+      { kKeyMean, this->mean() }, { kKeyPercentiles, percentiles }, { kKeyBuckets, buckets } });
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] durationNs The duration in nanoseconds. Must be positive
+/// \return The index of the bucket for the duration
+//**********************************************************************************************************************
+qint32 LatencyHistogram::bucketIndex(qint64 durationNs)
+{
+   if (durationNs < SubBucketCount)
+      return static_cast<qint32>(durationNs);
+   qint32 highestBit = 0;
+   for (quint64 v = static_cast<quint64>(durationNs); v > 1; v >>= 1)
+      ++highestBit;
+   qint32 const shift = highestBit - (SubBucketBits - 1); // after the shift, the value is in [HalfCount, Count[
+   return SubBucketCount + (shift - 1) * SubBucketHalfCount + static_cast<qint32>(durationNs >> shift)
+      - SubBucketHalfCount;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] index The index of the bucket
+/// \return The smallest duration counted in the bucket, in nanoseconds
+//**********************************************************************************************************************
+qint64 LatencyHistogram::bucketLowerBound(qint32 index)
+{
+   if (index < SubBucketCount)
+      return index;
+   qint32 const shift = (index - SubBucketCount) / SubBucketHalfCount + 1;
+   return static_cast<qint64>((index - SubBucketCount) % SubBucketHalfCount + SubBucketHalfCount) << shift;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] index The index of the bucket
+/// \return The largest duration counted in the bucket, in nanoseconds
+//**********************************************************************************************************************
+qint64 LatencyHistogram::bucketUpperBound(qint32 index)
+{
+   if (index < SubBucketCount)
+      return index;
+   qint32 const shift = (index - SubBucketCount) / SubBucketHalfCount + 1;
+   return bucketLowerBound(index) + (static_cast<qint64>(1) << shift) - 1;
+}
@@ -0,0 +1,64 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of latency histogram class
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_LATENCY_HISTOGRAM_H
+#define BEEFTEXT_LATENCY_HISTOGRAM_H
+
+
+#include <array>
+
+
+//**********************************************************************************************************************
+/// \brief A histogram of durations with logarithmic buckets, similar to HDR histograms.
+///
+/// Durations are expressed in nanoseconds. Durations smaller than SubBucketCount are counted exactly. Larger durations
+/// are counted in buckets whose width is at most 1/16th of their lower bound, so percentiles are reported with a
+/// relative error below 6.25%, using a fixed amount of memory and a constant recording time.
+//**********************************************************************************************************************
+class LatencyHistogram
+{
+public: // data types
+   enum {
+      SubBucketBits = 5, ///< The number of bits used for the linear sub-buckets
+      SubBucketCount = 1 << SubBucketBits, ///< The number of linear sub-buckets
+      SubBucketHalfCount = SubBucketCount / 2, ///< The number of sub-buckets in each logarithmic bucket
+      BucketCount = SubBucketCount + (62 - SubBucketBits + 1) * SubBucketHalfCount, ///< The total number of buckets
+   };
+
+public: // member functions
+   LatencyHistogram() = default; ///< Default constructor
+   LatencyHistogram(LatencyHistogram const&) = default; ///< Default copy constructor
+   LatencyHistogram(LatencyHistogram&&) = default; ///< Default move constructor
+   ~LatencyHistogram() = default; ///< Default destructor
+   LatencyHistogram& operator=(LatencyHistogram const&) = default; ///< Default assignment operator
+   LatencyHistogram& operator=(LatencyHistogram&&) = default; ///< Default move assignment operator
+   void record(qint64 durationNs); ///< Record a duration
+   void reset(); ///< Reset the histogram
+   quint64 count() const; ///< Return the number of recorded durations
+   qint64 min() const; ///< Return the smallest recorded duration
+   qint64 max() const; ///< Return the largest recorded duration
+   double mean() const; ///< Return the mean of the recorded durations
+   qint64 percentile(double percentile) const; ///< Return the duration for a percentile
+   QJsonObject toJsonObject() const; ///< Return a JSON object describing the histogram
+
+private: // static member functions
+   static qint32 bucketIndex(qint64 durationNs); ///< Return the index of the bucket for a duration
+   static qint64 bucketLowerBound(qint32 index); ///< Return the smallest duration counted in a bucket
+   static qint64 bucketUpperBound(qint32 index); ///< Return the largest duration counted in a bucket
+
+private: // data members
+   std::array<quint64, BucketCount> counts_ {}; ///< The number of durations recorded in each bucket
+   quint64 count_ { 0 }; ///< The number of recorded durations
+   qint64 min_ { 0 }; ///< The smallest recorded duration
+   qint64 max_ { 0 }; ///< The largest recorded duration
+   double sum_ { 0.0 }; ///< The sum of the recorded durations
+};
+
+
+#endif // #ifndef BEEFTEXT_LATENCY_HISTOGRAM_H
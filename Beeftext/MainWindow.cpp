@@ -10,14 +10,17 @@
 #include "stdafx.h"
 #include "MainWindow.h"
 #include "AboutDialog.h"
+#include "LatencyDiagnosticsDialog.h"
 #include "PreferencesDialog.h"
 #include "PreferencesManager.h"
 #include "Combo/ComboManager.h"
+#include "Combo/ComboListBenchmark.h"
 #include "Combo/ComboTableWidget.h"
 #include "Group/GroupListWidget.h"
 #include "BeeftextUtils.h"
 #include "BeeftextConstants.h"
 #include "InputManager.h"
+#include "KeystrokeTrace.h"
 #include <XMiLib/Exception.h>
 
 
@@ -47,6 +50,7 @@ MainWindow::MainWindow()
       { QDesktopServices::openUrl(QUrl(constants::kBeeftextIssueTrackerUrl)); });
    connect(&InputManager::instance(), &InputManager::comboMenuShortcutTriggered, this, &MainWindow::onShowComboMenu);
    connect(&prefs, &PreferencesManager::writeDebugLogFileChanged, this, &MainWindow::onWriteDebugLogFileChanged);
+   connect(&ComboManager::instance(), &ComboManager::comboListWasSaved, this, &MainWindow::onComboListWasSaved);
 }
 
 
@@ -171,6 +175,54 @@ void MainWindow::setupSystemTrayIcon()
    QAction* actionShowStyleSheet = new QAction(tr("Show Stylesheet Editor"), this);
    connect(actionShowStyleSheet, &QAction::triggered, &styleSheetEditor_, &xmilib::StyleSheetEditor::show);
    menu->addAction(actionShowStyleSheet);
+   QAction* actionCheckIndexes = new QAction(tr("Check Combo List Indexes"), this);
+   connect(actionCheckIndexes, &QAction::triggered, [this]()
+   {
+      QString errMsg;
+      if (ComboManager::instance().comboListRef().checkIndexConsistency(&errMsg))
+         QMessageBox::information(this, tr("Combo List Indexes"), tr("The combo list indexes are consistent."));
+      else
+         QMessageBox::critical(this, tr("Combo List Indexes"), errMsg);
+   });
+   menu->addAction(actionCheckIndexes);
+   QAction* actionBenchmarkLoading = new QAction(tr("Benchmark Combo List Loading"), this);
+   connect(actionBenchmarkLoading, &QAction::triggered, [this]()
+   {
+      QString const path = ComboList::existingFilePathInFolder(PreferencesManager::instance().comboListFolderPath());
+      QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+      QString const report = benchmarkComboListLoading(path);
+      QGuiApplication::restoreOverrideCursor();
+      QMessageBox::information(this, tr("Benchmark"), report);
+   });
+   menu->addAction(actionBenchmarkLoading);
+   QAction* actionBenchmarkFormats = new QAction(tr("Benchmark Combo List File Formats"), this);
+   connect(actionBenchmarkFormats, &QAction::triggered, [this]()
+   {
+      QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+      QString const report = benchmarkComboListFileFormats();
+      QGuiApplication::restoreOverrideCursor();
+      QMessageBox::information(this, tr("Benchmark"), report);
+   });
+   menu->addAction(actionBenchmarkFormats);
+   QAction* actionRecordTrace = new QAction(tr("Record Keystroke Trace"), this);
+   actionRecordTrace->setCheckable(true);
+   actionRecordTrace->setChecked(KeystrokeTraceRecorder::instance().isRecording());
+   connect(actionRecordTrace, &QAction::triggered, [this](bool checked)
+   {
+      KeystrokeTraceRecorder& recorder = KeystrokeTraceRecorder::instance();
+      if (checked)
+      {
+         recorder.start();
+         return;
+      }
+      KeystrokeTrace const trace = recorder.stop();
+      QString const path = QFileDialog::getSaveFileName(this, tr("Save Keystroke Trace"), QString(),
+         tr("Keystroke trace files (*.bftrace);;All files (*.*)"));
+      QString errMsg;
+      if ((!path.isEmpty()) && !saveKeystrokeTrace(trace, path, &errMsg))
+         QMessageBox::critical(this, tr("Error"), errMsg);
+   });
+   menu->addAction(actionRecordTrace);
 #endif // #ifndef NDEBUG
    menu->addSeparator();
    menu->addAction(ui_.actionExit);
@@ -379,6 +431,15 @@ void MainWindow::onActionGenerateCheatSheet()
 }
 
 
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void MainWindow::onActionShowLatencyDiagnostics()
+{
+   LatencyDiagnosticsDialog(this).exec();
+}
+
+
 //**********************************************************************************************************************
 /// \param[in] value The new value for the preference.
 //**********************************************************************************************************************
@@ -388,6 +449,17 @@ void MainWindow::onWriteDebugLogFileChanged(bool value) const
 }
 
 
+//**********************************************************************************************************************
+/// \param[in] success Was the combo list successfully saved.
+/// \param[in] errorMessage If success is false, the description of the error.
+//**********************************************************************************************************************
+void MainWindow::onComboListWasSaved(bool success, QString const& errorMessage)
+{
+   if (!success)
+      QMessageBox::critical(this, tr("Error"), errorMessage);
+}
+
+
 //**********************************************************************************************************************
 //
 //**********************************************************************************************************************
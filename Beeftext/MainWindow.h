@@ -63,7 +63,9 @@ private slots:
    void onActionBackup(); ///< Slot for the 'Backup' action.
    void onActionRestore(); ///< Slot for the 'Restore' action.
    void onActionGenerateCheatSheet(); ///< Slot for the 'Generate Cheat Sheet' action.
+   void onActionShowLatencyDiagnostics(); ///< Slot for the 'Substitution Latency' action.
    void onWriteDebugLogFileChanged(bool value) const; ///< Slot for the change of the 'Write debug log file' preference.
+   void onComboListWasSaved(bool success, QString const& errorMessage); ///< Slot for the saving of the combo list.
 
 private: // data members
    Ui::MainWindow ui_ {}; ///< The GUI for the window
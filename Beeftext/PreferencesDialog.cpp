@@ -13,6 +13,7 @@
 #include "Theme.h"
 #include "I18nManager.h"
 #include "Combo/ComboManager.h"
+#include "Combo/ScriptVariableExecutor.h"
 #include "Backup/BackupManager.h"
 #include "Backup/BackupRestoreDialog.h"
 #include "Update/UpdateManager.h"
@@ -48,6 +49,8 @@ PreferencesDialog::PreferencesDialog(QWidget* parent)
    ui_.labelUpdateCheckStatus->setText(QString());
    ui_.spinDelayBetweenKeystrokes->setRange(PreferencesManager::minDelayBetweenKeystrokesMs(), 
       PreferencesManager::maxDelayBetweenKeystrokesMs());
+   ui_.spinScriptVariableCacheDuration->setRange(PreferencesManager::minScriptVariableCacheDurationSeconds(),
+      PreferencesManager::maxScriptVariableCacheDurationSeconds());
    I18nManager::instance().fillLocaleCombo(*ui_.comboLocale);
    this->loadPreferences();
    if (isInPortableMode())
@@ -128,6 +131,8 @@ void PreferencesDialog::loadPreferences() const
    ui_.editCustomSound->setText(QDir::toNativeSeparators(prefs_.customSoundPath()));
    blocker = QSignalBlocker(ui_.checkUseLegacyCopyPaste);
    ui_.checkUseLegacyCopyPaste->setChecked(prefs_.useLegacyCopyPaste());
+   blocker = QSignalBlocker(ui_.checkUseBinaryComboListFile);
+   ui_.checkUseBinaryComboListFile->setChecked(prefs_.useBinaryComboListFile());
    blocker = QSignalBlocker(ui_.checkComboTriggersOnSpace);
    ui_.checkComboTriggersOnSpace->setChecked(prefs_.comboTriggersOnSpace());
    blocker = QSignalBlocker(ui_.checkKeepFinalSpaceCharacter);
@@ -136,6 +141,12 @@ void PreferencesDialog::loadPreferences() const
    ui_.checkUseCustomPowershellVersion->setChecked(prefs_.useCustomPowershellVersion());
    blocker = QSignalBlocker(ui_.editCustomPowerShellPath);
    ui_.editCustomPowerShellPath->setText(QDir::toNativeSeparators(prefs_.customPowershellPath()));
+   blocker = QSignalBlocker(ui_.editScriptInterpreterArguments);
+   ui_.editScriptInterpreterArguments->setText(prefs_.scriptInterpreterArguments());
+   blocker = QSignalBlocker(ui_.spinScriptVariableCacheDuration);
+   ui_.spinScriptVariableCacheDuration->setValue(prefs_.scriptVariableCacheDurationSeconds());
+   blocker = QSignalBlocker(ui_.checkPrewarmScriptVariables);
+   ui_.checkPrewarmScriptVariables->setChecked(prefs_.prewarmScriptVariables());
    this->updateGui();
    // ReSharper restore CppAssignedValueIsNeverUsed
    // ReSharper restore CppEntityAssignedButNoRead
@@ -228,6 +239,7 @@ void PreferencesDialog::updateGui() const
    bool const customPowershell = ui_.checkUseCustomPowershellVersion->isChecked();
    ui_.editCustomPowerShellPath->setEnabled(customPowershell);
    ui_.buttonChangeCustomPowershellVersion->setEnabled(customPowershell);
+   ui_.checkPrewarmScriptVariables->setEnabled(ui_.spinScriptVariableCacheDuration->value() > 0);
 
    ui_.comboTheme->setEnabled(prefs_.useCustomTheme());
 }
@@ -763,6 +775,18 @@ void PreferencesDialog::onCheckUseLegacyCopyPaste() const
 }
 
 
+//**********************************************************************************************************************
+/// \param[in] value Is the checkbox checked?
+//**********************************************************************************************************************
+void PreferencesDialog::onCheckUseBinaryComboListFile(bool value)
+{
+   prefs_.setUseBinaryComboListFile(value);
+   QString errorMsg;
+   if (!ComboManager::instance().writeComboListFile(&errorMsg)) // the file is rewritten in the new format
+      QMessageBox::critical(this, tr("Error"), errorMsg);
+}
+
+
 //**********************************************************************************************************************
 /// \param[in] checked Is the check box checked.
 //**********************************************************************************************************************
@@ -783,6 +807,7 @@ void PreferencesDialog::onCheckUseCustomPowerShellVersion(bool checked)
       }
    }
    prefs_.setUseCustomPowershellVersion(ui_.checkUseCustomPowershellVersion->isChecked());
+   ScriptVariableExecutor::instance().clearCache();
    this->updateGui();
 }
 
@@ -797,11 +822,44 @@ void PreferencesDialog::onChangeCustomPowershellVersion()
    if (path.isEmpty())
       return;
    prefs_.setCustomPowershellPath(path);
+   ScriptVariableExecutor::instance().clearCache();
    QSignalBlocker blocker(ui_.editCustomPowerShellPath);
    ui_.editCustomPowerShellPath->setText(QDir::toNativeSeparators(path));
 }
 
 
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void PreferencesDialog::onEditScriptInterpreterArgumentsFinished() const
+{
+   QString const arguments = ui_.editScriptInterpreterArguments->text().trimmed();
+   if (arguments == prefs_.scriptInterpreterArguments())
+      return;
+   prefs_.setScriptInterpreterArguments(arguments);
+   ScriptVariableExecutor::instance().clearCache();
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] value The new value for the spin box.
+//**********************************************************************************************************************
+void PreferencesDialog::onSpinScriptVariableCacheDurationChanged(int value)
+{
+   prefs_.setScriptVariableCacheDurationSeconds(value);
+   this->updateGui();
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] checked Is the check box checked.
+//**********************************************************************************************************************
+void PreferencesDialog::onCheckPrewarmScriptVariables(bool checked) const
+{
+   prefs_.setPrewarmScriptVariables(checked);
+}
+
+
 //**********************************************************************************************************************
 //
 //**********************************************************************************************************************
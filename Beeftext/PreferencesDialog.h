@@ -84,8 +84,12 @@ private slots:
    static void onOpenTranslationFolder(); ///< Slot for the 'Translation Folder' button.
    void onRefreshLanguageList() const; ///< Slot for the 'Refresh Language List' button.
    void onCheckUseLegacyCopyPaste() const; ///< Set for the 'Use legacy copy/paste'.
+   void onCheckUseBinaryComboListFile(bool value); ///< Slot for the 'Use binary combo list file' checkbox.
    void onCheckUseCustomPowerShellVersion(bool checked); ///< Slot for the 'Use custom PowerShell version' check box.
    void onChangeCustomPowershellVersion(); ///< Slot for the 'Change' button of the custom PowerShell version.
+   void onEditScriptInterpreterArgumentsFinished() const; ///< Slot for the end of the edition of the script interpreter arguments.
+   void onSpinScriptVariableCacheDurationChanged(int value); ///< Slot for the 'Script variable cache duration' spin value change.
+   void onCheckPrewarmScriptVariables(bool checked) const; ///< Slot for the 'Pre-warm script variables' check box.
    void onExport(); ///< Slot for the 'Export' button.
    void onImport(); ///< Slot for the 'Import' button.
 
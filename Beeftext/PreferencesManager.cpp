@@ -72,6 +72,10 @@ QString const kKeyAlreadyConvertedRichTextCombos = "AlreadyConvertedRichTextComb
 QString const kKeyUseCustomPowershellVersion = "UseCustomPowershellVersion"; ///< The setting key for the 'Use custom PowerShell version'.
 QString const kKeyCustomPowershellPath = "CustomPowershellPath"; ///< The setting key for the 'Custom PowerShell path'.
 QString const kKeyTheme = "Theme"; ///< The setting key for the 'Theme' preference.
+QString const kKeyUseBinaryComboListFile = "UseBinaryComboListFile"; ///< The setting key for the 'Use binary combo list file' preference.
+QString const kKeyScriptInterpreterArguments = "ScriptInterpreterArguments"; ///< The setting key for the 'Script interpreter arguments' preference.
+QString const kKeyScriptVariableCacheDuration = "ScriptVariableCacheDuration"; ///< The setting key for the 'Script variable cache duration' preference.
+QString const kKeyPrewarmScriptVariables = "PrewarmScriptVariables"; ///< The setting key for the 'Pre-warm script variables' preference.
 
 
 SpShortcut const kDefaultAppEnableDisableShortcut = std::make_shared<Shortcut>(Qt::AltModifier | Qt::ShiftModifier
@@ -106,6 +110,12 @@ bool const kDefaultComboTriggersOnSpace = false; ///< The default value for the
 bool const kDefaultKeepFinalSpaceCharacter = false; ///< The default value for the 'Combo triggers on space' preference.
 bool const kDefaultUseCustomPowershellVersion = false; ///< The default value for the 'Use custom PowerShell version' preference.
 ETheme const kDefaultTheme = ETheme::Light; ///< The default value for the theme preference.
+bool const kDefaultUseBinaryComboListFile = false; ///< The default value for the 'Use binary combo list file' preference.
+QString const kDefaultScriptInterpreterArguments = "-NonInteractive -ExecutionPolicy Unrestricted -File"; ///< The default value for the 'Script interpreter arguments' preference.
+qint32 const kDefaultScriptVariableCacheDurationSeconds = 0; ///< The default value for the 'Script variable cache duration' preference.
+qint32 const kMinValueScriptVariableCacheDurationSeconds = 0; ///< The minimum value for the 'Script variable cache duration' preference.
+qint32 const kMaxValueScriptVariableCacheDurationSeconds = 3600; ///< The maximum value for the 'Script variable cache duration' preference.
+bool const kDefaultPrewarmScriptVariables = false; ///< The default value for the 'Pre-warm script variables' preference.
 
 
 }
@@ -219,6 +229,10 @@ void PreferencesManager::reset()
    this->setWriteDebugLogFile(kDefaultWriteDebugLogFile);
    this->resetWarnings();
    this->setUseLegacyCopyPaste(kDefaultUseLegacyCopyPaste);
+   this->setUseBinaryComboListFile(kDefaultUseBinaryComboListFile);
+   this->setScriptInterpreterArguments(kDefaultScriptInterpreterArguments);
+   this->setScriptVariableCacheDurationSeconds(kDefaultScriptVariableCacheDurationSeconds);
+   this->setPrewarmScriptVariables(kDefaultPrewarmScriptVariables);
    if (!isInPortableMode())
    {
       this->setAutoStartAtLogin(kDefaultAutoStartAtLogin);
@@ -383,6 +397,14 @@ void PreferencesManager::toJsonDocument(QJsonDocument& outDoc) const
       kKeyRichTextDeprecationWarningHasAlreadyBeenDisplayed, 
       kDefaultkKeyRichTextDeprecationWarningHasAlreadyBeenDisplayed);
    object[kKeyUseLegacyCopyPaste] = this->readSettings<bool>(kKeyUseLegacyCopyPaste, kDefaultUseLegacyCopyPaste);
+   object[kKeyUseBinaryComboListFile] = this->readSettings<bool>(kKeyUseBinaryComboListFile, 
+      kDefaultUseBinaryComboListFile);
+   object[kKeyScriptInterpreterArguments] = this->readSettings<QString>(kKeyScriptInterpreterArguments,
+      kDefaultScriptInterpreterArguments);
+   object[kKeyScriptVariableCacheDuration] = this->readSettings<qint32>(kKeyScriptVariableCacheDuration,
+      kDefaultScriptVariableCacheDurationSeconds);
+   object[kKeyPrewarmScriptVariables] = this->readSettings<bool>(kKeyPrewarmScriptVariables,
+      kDefaultPrewarmScriptVariables);
    outDoc = QJsonDocument(object);
 }
 
@@ -439,6 +461,15 @@ void PreferencesManager::fromJsonDocument(QJsonDocument const& doc)
    settings_->setValue(kKeyRichTextDeprecationWarningHasAlreadyBeenDisplayed, objectValue<bool>(object,
       kKeyRichTextDeprecationWarningHasAlreadyBeenDisplayed));
    this->setUseLegacyCopyPaste(objectValue<bool>(object, kKeyUseLegacyCopyPaste));
+   if (object.contains(kKeyUseBinaryComboListFile)) // absent from files exported by older versions
+      settings_->setValue(kKeyUseBinaryComboListFile, objectValue<bool>(object, kKeyUseBinaryComboListFile));
+   if (object.contains(kKeyScriptInterpreterArguments))
+      settings_->setValue(kKeyScriptInterpreterArguments, objectValue<QString>(object, 
+         kKeyScriptInterpreterArguments));
+   if (object.contains(kKeyScriptVariableCacheDuration))
+      this->setScriptVariableCacheDurationSeconds(objectValue<qint32>(object, kKeyScriptVariableCacheDuration));
+   if (object.contains(kKeyPrewarmScriptVariables))
+      settings_->setValue(kKeyPrewarmScriptVariables, objectValue<bool>(object, kKeyPrewarmScriptVariables));
    this->init();
 }
 
@@ -863,6 +894,7 @@ void PreferencesManager::setComboTriggerShortcut(SpShortcut const& shortcut)
       settings_->setValue(kKeyComboTriggerShortcutKeyCode, shortcut->nativeVirtualKey());
       settings_->setValue(kKeyComboTriggerShortcutScanCode, shortcut->nativeScanCode());
       cachedComboTriggerShortcut_ = newShortcut;
+      cachedComboTriggerShortcutKey_ = cachedComboTriggerShortcut_->nativeKeyCode();
    }
 }
 
@@ -876,6 +908,17 @@ SpShortcut PreferencesManager::comboPickerShortcut() const
 }
 
 
+//**********************************************************************************************************************
+/// This function can be called from the keyboard hook thread.
+///
+/// \return The key code of the combo picker shortcut, as returned by Shortcut::nativeKeyCode()
+//**********************************************************************************************************************
+quint64 PreferencesManager::comboPickerShortcutKeyCode() const
+{
+   return cachedComboPickerShortcutKey_;
+}
+
+
 //**********************************************************************************************************************
 /// \brief Return the default combo picker shortcut.
 /// 
@@ -1129,6 +1172,17 @@ SpShortcut PreferencesManager::comboTriggerShortcut() const
 }
 
 
+//**********************************************************************************************************************
+/// This function can be called from the keyboard hook thread.
+///
+/// \return The key code of the combo trigger shortcut, as returned by Shortcut::nativeKeyCode()
+//**********************************************************************************************************************
+quint64 PreferencesManager::comboTriggerShortcutKeyCode() const
+{
+   return cachedComboTriggerShortcutKey_;
+}
+
+
 //**********************************************************************************************************************
 /// \param[in] shortcut The shortcut
 //**********************************************************************************************************************
@@ -1144,6 +1198,7 @@ void PreferencesManager::setComboPickerShortcut(SpShortcut const& shortcut)
       settings_->setValue(kKeyComboPickerShortcutKeyCode, shortcut->nativeVirtualKey());
       settings_->setValue(kKeyComboPickerShortcutScanCode, shortcut->nativeScanCode());
       cachedComboPickerShortcut_ = newShortcut;
+      cachedComboPickerShortcutKey_ = cachedComboPickerShortcut_->nativeKeyCode();
    }
 }
 
@@ -1175,6 +1230,7 @@ void PreferencesManager::cacheComboTriggerShortcut()
    SpShortcut const shortcut = this->readShortcutFromPreferences(kKeyComboTriggerShortcutModifiers,
       kKeyComboTriggerShortcutKeyCode, kKeyComboTriggerShortcutScanCode);
    cachedComboTriggerShortcut_ = shortcut ? shortcut : kDefaultComboTriggerShortcut;
+   cachedComboTriggerShortcutKey_ = cachedComboTriggerShortcut_->nativeKeyCode();
 }
 
 
@@ -1186,6 +1242,7 @@ void PreferencesManager::cacheComboPickerShortcut()
    SpShortcut const shortcut = this->readShortcutFromPreferences(kKeyComboPickerShortcutModifiers,
       kKeyComboPickerShortcutKeyCode, kKeyComboPickerShortcutScanCode);
    cachedComboPickerShortcut_ = shortcut ? shortcut : defaultComboPickerShortcut();
+   cachedComboPickerShortcutKey_ = cachedComboPickerShortcut_->nativeKeyCode();
 }
 
 
@@ -1197,6 +1254,7 @@ void PreferencesManager::cacheAppEnableDisableShortcut()
    SpShortcut const shortcut = this->readShortcutFromPreferences(kKeyAppEnableShortcutModifiers,
       kKeyAppEnableShortcutKeyCode, kKeyAppEnableShortcutScanCode);
    cachedAppEnableDisableShortcut_ = shortcut ? shortcut : defaultAppEnableDisableShortcut();
+   cachedAppEnableDisableShortcutKey_ = cachedAppEnableDisableShortcut_->nativeKeyCode();
 }
 
 
@@ -1304,6 +1362,7 @@ void PreferencesManager::setAppEnableDisableShortcut(SpShortcut const& shortcut)
       settings_->setValue(kKeyAppEnableShortcutKeyCode, shortcut->nativeVirtualKey());
       settings_->setValue(kKeyAppEnableShortcutScanCode, shortcut->nativeScanCode());
       cachedAppEnableDisableShortcut_ = newShortcut;
+      cachedAppEnableDisableShortcutKey_ = cachedAppEnableDisableShortcut_->nativeKeyCode();
    }
 }
 
@@ -1317,6 +1376,17 @@ SpShortcut PreferencesManager::appEnableDisableShortcut() const
 }
 
 
+//**********************************************************************************************************************
+/// This function can be called from the keyboard hook thread.
+///
+/// \return The key code of the shortcut to enable/disable the application, as returned by Shortcut::nativeKeyCode()
+//**********************************************************************************************************************
+quint64 PreferencesManager::appEnableDisableShortcutKeyCode() const
+{
+   return cachedAppEnableDisableShortcutKey_;
+}
+
+
 //**********************************************************************************************************************
 //
 //**********************************************************************************************************************
@@ -1367,6 +1437,24 @@ bool PreferencesManager::useLegacyCopyPaste() const
 }
 
 
+//**********************************************************************************************************************
+/// \param[in] value The value for the preference.
+//**********************************************************************************************************************
+void PreferencesManager::setUseBinaryComboListFile(bool value) const
+{
+   settings_->setValue(kKeyUseBinaryComboListFile, value);
+}
+
+
+//**********************************************************************************************************************
+/// \return The value for the preference.
+//**********************************************************************************************************************
+bool PreferencesManager::useBinaryComboListFile() const
+{
+   return readSettings<bool>(kKeyUseBinaryComboListFile, kDefaultUseBinaryComboListFile);
+}
+
+
 //**********************************************************************************************************************
 /// \param[in] value The value for the preference.
 //**********************************************************************************************************************
@@ -1421,6 +1509,81 @@ QString PreferencesManager::customPowershellPath() const
 }
 
 
+//**********************************************************************************************************************
+/// \param[in] arguments The arguments passed to the script interpreter, before the path of the script.
+//**********************************************************************************************************************
+void PreferencesManager::setScriptInterpreterArguments(QString const& arguments) const
+{
+   settings_->setValue(kKeyScriptInterpreterArguments, arguments);
+}
+
+
+//**********************************************************************************************************************
+/// \return The arguments passed to the script interpreter, before the path of the script.
+//**********************************************************************************************************************
+QString PreferencesManager::scriptInterpreterArguments() const
+{
+   return readSettings<QString>(kKeyScriptInterpreterArguments, kDefaultScriptInterpreterArguments);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] value The duration in seconds. 0 means the results of scripts are not cached.
+//**********************************************************************************************************************
+void PreferencesManager::setScriptVariableCacheDurationSeconds(qint32 value) const
+{
+   settings_->setValue(kKeyScriptVariableCacheDuration, qBound<qint32>(kMinValueScriptVariableCacheDurationSeconds, 
+      value, kMaxValueScriptVariableCacheDurationSeconds));
+}
+
+
+//**********************************************************************************************************************
+/// \return The duration in seconds. 0 means the results of scripts are not cached.
+//**********************************************************************************************************************
+qint32 PreferencesManager::scriptVariableCacheDurationSeconds() const
+{
+   return qBound<qint32>(kMinValueScriptVariableCacheDurationSeconds, this->readSettings<qint32>(
+      kKeyScriptVariableCacheDuration, kDefaultScriptVariableCacheDurationSeconds), 
+      kMaxValueScriptVariableCacheDurationSeconds);
+}
+
+
+//**********************************************************************************************************************
+/// \return The minimum value for the preference.
+//**********************************************************************************************************************
+qint32 PreferencesManager::minScriptVariableCacheDurationSeconds()
+{
+   return kMinValueScriptVariableCacheDurationSeconds;
+}
+
+
+//**********************************************************************************************************************
+/// \return The maximum value for the preference.
+//**********************************************************************************************************************
+qint32 PreferencesManager::maxScriptVariableCacheDurationSeconds()
+{
+   return kMaxValueScriptVariableCacheDurationSeconds;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] value The value for the preference
+//**********************************************************************************************************************
+void PreferencesManager::setPrewarmScriptVariables(bool value) const
+{
+   settings_->setValue(kKeyPrewarmScriptVariables, value);
+}
+
+
+//**********************************************************************************************************************
+/// \return The value for the preference.
+//**********************************************************************************************************************
+bool PreferencesManager::prewarmScriptVariables() const
+{
+   return readSettings<bool>(kKeyPrewarmScriptVariables, kDefaultPrewarmScriptVariables);
+}
+
+
 //**********************************************************************************************************************
 /// \param[in] theme The theme.
 //**********************************************************************************************************************
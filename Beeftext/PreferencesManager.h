@@ -13,6 +13,7 @@
 
 #include "Shortcut.h"
 #include "Theme.h"
+#include <atomic>
 
 
 //**********************************************************************************************************************
@@ -78,6 +79,7 @@ public: // member functions
    static QString defaultComboListFolderPath(); ///< Get the default combo list folder path
    void setComboTriggerShortcut(SpShortcut const& shortcut); ///< Set the combo trigger shortcut
    SpShortcut comboTriggerShortcut() const; ///< Retrieve the combo trigger shortcut
+   quint64 comboTriggerShortcutKeyCode() const; ///< Retrieve the key code of the combo trigger shortcut
    void setAutoBackup(bool value) const; ///< Set the value for the 'Auto backup' preference
    bool autoBackup() const; ///< Get the value for the 'Auto backup' preference
    void setUseCustomBackupLocation(bool value) const; ///< Set the value for the 'Use custom backup location' preference.
@@ -103,22 +105,34 @@ public: // member functions
    void setComboPickerEnabled(bool value); ///< Set the value for the 'Combo picker enabled'  preference.
    void setComboPickerShortcut(SpShortcut const& shortcut); ///< Set the combo picker shortcut.
    SpShortcut comboPickerShortcut() const; ///< Retrieve the combo picker shortcut.
+   quint64 comboPickerShortcutKeyCode() const; ///< Retrieve the key code of the combo picker shortcut.
    static SpShortcut defaultComboPickerShortcut(); ///< Return the default combo picker shortcut.
    void setEnableAppEnableDisableShortcut(bool enable); ///< Get the value for the 'Enable app enable/disable' shortcut.
    bool  enableAppEnableDisableShortcut() const; ///< Get the value for the 'Enable app enable/disable' shortcut.
    void setAppEnableDisableShortcut(SpShortcut const& shortcut); ///< Set the shortcut short to enable/disable the application.
    SpShortcut appEnableDisableShortcut() const; ///< Retrieve the shortcut to enable/disable the application.
+   quint64 appEnableDisableShortcutKeyCode() const; ///< Retrieve the key code of the shortcut to enable/disable the application.
    static SpShortcut defaultAppEnableDisableShortcut(); ///< Return the default combo shortcut to enable/disable the application. 
    void setBeeftextEnabled(bool enabled); ///< Set if beeftext is enabled.
    bool beeftextEnabled() const; ///< Set if beeftext is enabled.
    void setUseLegacyCopyPaste(bool value) const; ///< Set he value for the 'Use legacy copy/paste' preference.
    bool useLegacyCopyPaste() const; ///< Get the value for the 'Use legacy copy/paste' preference.
+   void setUseBinaryComboListFile(bool value) const; ///< Set the value for the 'Use binary combo list file' preference.
+   bool useBinaryComboListFile() const; ///< Get the value for the 'Use binary combo list file' preference.
    void setAlreadyConvertedRichTextCombos(bool value) const; ///< Set the value for the 'Already converted rich text combos' preference.
    bool alreadyConvertedRichTextCombos() const; ///< Get the value for the 'Already converted rich text combos' preference.
    void setUseCustomPowershellVersion(bool value) const; ///< Set the value for the 'Use custom PowerShell version'.
    bool useCustomPowershellVersion() const; ///< Get the value for the 'Use custom PowerShell version'.
    void setCustomPowershellPath(QString const& path) const; ///< Set the value for the 'Custom PowerShell Path'.
    QString customPowershellPath() const; ///< Set the value for the 'Custom PowerShell Path'.
+   void setScriptInterpreterArguments(QString const& arguments) const; ///< Set the value for the 'Script interpreter arguments' preference.
+   QString scriptInterpreterArguments() const; ///< Get the value for the 'Script interpreter arguments' preference.
+   void setScriptVariableCacheDurationSeconds(qint32 value) const; ///< Set the value for the 'Script variable cache duration' preference.
+   qint32 scriptVariableCacheDurationSeconds() const; ///< Get the value for the 'Script variable cache duration' preference.
+   static qint32 minScriptVariableCacheDurationSeconds(); ///< Get the minimum value for the 'Script variable cache duration' preference.
+   static qint32 maxScriptVariableCacheDurationSeconds(); ///< Get the maximum value for the 'Script variable cache duration' preference.
+   void setPrewarmScriptVariables(bool value) const; ///< Set the value for the 'Pre-warm script variables' preference.
+   bool prewarmScriptVariables() const; ///< Get the value for the 'Pre-warm script variables' preference.
    void setTheme(ETheme theme); ///< Set the theme parameter.
    ETheme theme() const; ///< Get the theme.
 signals:
@@ -143,18 +157,23 @@ private: // member functions
    
 private: // data members
    std::unique_ptr<QSettings> settings_ { nullptr }; ///< The Qt settings instance
-   bool cachedUseAutomaticSubstitution_ { true }; ///< Cached value for the 'use automatic substitution' preference value
-   bool cachedComboTriggersOnSpace_{ false }; ///< Cached vaue for the 'combo trigger on space' preference.
+   // The cached values read by the keyboard hook thread are atomic. The hook thread reads the shortcuts as plain key
+   // codes (see Shortcut::nativeKeyCode())
+   std::atomic<bool> cachedUseAutomaticSubstitution_ { true }; ///< Cached value for the 'use automatic substitution' preference value
+   std::atomic<bool> cachedComboTriggersOnSpace_{ false }; ///< Cached vaue for the 'combo trigger on space' preference.
    bool cachedKeepFinalSpaceCharacter_{ false }; ///< Cached vaue for the 'keep final space character' preference.
    SpShortcut cachedComboTriggerShortcut_; ///< Cached value for the 'combo trigger shortcut' preference
-   bool cachedComboPickerEnabled_ { true }; ///< Cached value for the 'Combo picker enabled' preference.
+   std::atomic<quint64> cachedComboTriggerShortcutKey_ { 0 }; ///< Cached key code for the 'combo trigger shortcut' preference
+   std::atomic<bool> cachedComboPickerEnabled_ { true }; ///< Cached value for the 'Combo picker enabled' preference.
    SpShortcut cachedComboPickerShortcut_; ///< Cached value for the 'combo picker shortcut' preference
-   bool cachedEnableAppEnableDisableShortcut_ { true }; ///< Cached value for the 'app enable/disable shortcut' preference.
+   std::atomic<quint64> cachedComboPickerShortcutKey_ { 0 }; ///< Cached key code for the 'combo picker shortcut' preference
+   std::atomic<bool> cachedEnableAppEnableDisableShortcut_ { true }; ///< Cached value for the 'app enable/disable shortcut' preference.
    SpShortcut cachedAppEnableDisableShortcut_; ///< Cached value for the 'app enable/disable shortcut' preference.
+   std::atomic<quint64> cachedAppEnableDisableShortcutKey_ { 0 }; ///< Cached key code for the 'app enable/disable shortcut' preference.
    bool cachedEmojiShortcodesEnabled_ { false }; ///< Cached value for the 'emoji shortcodes enabled' preference
    QString cachedEmojiLeftDelimiter_; ///< Cached value for the 'emoji left delimiter' preference.
    QString cachedEmojiRightDelimiter_; ///< Cached value for the 'emoji right delimiter' preference.
-   bool cachedBeeftextEnabled_ { true }; ///< Cached value for the 'Beeftext enabled' preference.
+   std::atomic<bool> cachedBeeftextEnabled_ { true }; ///< Cached value for the 'Beeftext enabled' preference.
    bool cachedUseCustomTheme_ { true }; ///< Cached value for the 'Use custom theme' preference.
    ETheme cachedTheme_ { ETheme::Light }; ///< Cached value for the 'Theme' preference.
 };
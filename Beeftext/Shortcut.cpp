@@ -131,3 +131,27 @@ quint32 Shortcut::nativeScanCode() const
    return nativeScanCode_;
 }
 
+
+//**********************************************************************************************************************
+/// Only the Control, Alt, Meta and Shift modifiers are taken into account. The result can be compared to the key code
+/// of a keystroke without any allocation, which is what the keyboard hook does.
+///
+/// \param[in] modifiers The modifiers
+/// \param[in] nativeVirtualKey The native virtual key code
+/// \return The modifiers and virtual key packed into a plain value
+//**********************************************************************************************************************
+quint64 Shortcut::nativeKeyCode(Qt::KeyboardModifiers modifiers, quint32 nativeVirtualKey)
+{
+   Qt::KeyboardModifiers const mask = Qt::ControlModifier | Qt::AltModifier | Qt::MetaModifier | Qt::ShiftModifier;
+   return (static_cast<quint64>(static_cast<quint32>(modifiers & mask)) << 32) | nativeVirtualKey;
+}
+
+
+//**********************************************************************************************************************
+/// \return The modifiers and virtual key of the shortcut packed into a plain value
+//**********************************************************************************************************************
+quint64 Shortcut::nativeKeyCode() const
+{
+   return nativeKeyCode(modifiers_, nativeVirtualKey_);
+}
+
@@ -16,6 +16,9 @@
 //**********************************************************************************************************************
 class Shortcut
 {
+public: // static member functions
+   static quint64 nativeKeyCode(Qt::KeyboardModifiers modifiers, quint32 nativeVirtualKey); ///< Pack modifiers and a virtual key into a plain value
+
 public: // member functions
 	Shortcut(Qt::KeyboardModifiers const& modifiers, quint32 nativeVirtualKey, quint32 nativeScanCode); ///< Default constructor
 	Shortcut(Shortcut const&) = delete; ///< Disabled copy constructor
@@ -30,6 +33,7 @@ public: // member functions
    Qt::KeyboardModifiers nativeModifiers() const; ///< Return the native modifiers field of the shortcut
    quint32 nativeVirtualKey() const; ///< Return the native virtual key of the shortcut
    quint32 nativeScanCode() const; ///< Return the native scan code of the shortcut
+   quint64 nativeKeyCode() const; ///< Return the modifiers and virtual key of the shortcut packed into a plain value
 
 private: // data members
    Qt::KeyboardModifiers modifiers_; ///< The modifiers for the shortcut
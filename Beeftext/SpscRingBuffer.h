@@ -0,0 +1,105 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of a lock-free single-producer single-consumer ring buffer
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_SPSC_RING_BUFFER_H
+#define BEEFTEXT_SPSC_RING_BUFFER_H
+
+
+#include <atomic>
+
+
+//**********************************************************************************************************************
+/// \brief A fixed-capacity lock-free ring buffer with a single producer thread and a single consumer thread.
+///
+/// push() must only be called by the producer thread, and pop() by the consumer thread. When the buffer is full,
+/// pushed values are dropped and counted. Indices increase freely and are wrapped using the capacity, which must be
+/// a power of two.
+//**********************************************************************************************************************
+template <typename T, quint32 capacity>
+class SpscRingBuffer
+{
+   static_assert((capacity > 0) && (0 == (capacity & (capacity - 1))), "The capacity must be a power of two.");
+
+public: // member functions
+   SpscRingBuffer() = default; ///< Default constructor
+   SpscRingBuffer(SpscRingBuffer const&) = delete; ///< Disabled copy constructor
+   SpscRingBuffer(SpscRingBuffer&&) = delete; ///< Disabled move constructor
+   ~SpscRingBuffer() = default; ///< Default destructor
+   SpscRingBuffer& operator=(SpscRingBuffer const&) = delete; ///< Disabled assignment operator
+   SpscRingBuffer& operator=(SpscRingBuffer&&) = delete; ///< Disabled move assignment operator
+
+   //*******************************************************************************************************************
+   /// \param[in] value The value
+   /// \return true if and only if the value was pushed. If the buffer is full, false is returned and the value is
+   /// dropped
+   //*******************************************************************************************************************
+   bool push(T const& value)
+   {
+      quint32 const tail = tail_.load(std::memory_order_relaxed);
+      quint32 const size = tail - head_.load(std::memory_order_acquire);
+      if (size >= capacity)
+      {
+         droppedCount_.fetch_add(1, std::memory_order_relaxed);
+         return false;
+      }
+      buffer_[tail & (capacity - 1)] = value;
+      tail_.store(tail + 1, std::memory_order_release);
+      if (size + 1 > maxSize_.load(std::memory_order_relaxed))
+         maxSize_.store(size + 1, std::memory_order_relaxed);
+      return true;
+   }
+
+   //*******************************************************************************************************************
+   /// \param[out] outValue If the function returns true, receives the oldest value of the buffer
+   /// \return true if and only if a value was popped
+   //*******************************************************************************************************************
+   bool pop(T& outValue)
+   {
+      quint32 const head = head_.load(std::memory_order_relaxed);
+      if (head == tail_.load(std::memory_order_acquire))
+         return false;
+      outValue = buffer_[head & (capacity - 1)];
+      head_.store(head + 1, std::memory_order_release);
+      return true;
+   }
+
+   //*******************************************************************************************************************
+   /// \return The number of values in the buffer. The value may be outdated as soon as it is returned
+   //*******************************************************************************************************************
+   quint32 size() const
+   {
+      return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+   }
+
+   //*******************************************************************************************************************
+   /// \return The largest number of values the buffer has contained
+   //*******************************************************************************************************************
+   quint32 maxSize() const
+   {
+      return maxSize_.load(std::memory_order_relaxed);
+   }
+
+   //*******************************************************************************************************************
+   /// \return The number of values that were dropped because the buffer was full
+   //*******************************************************************************************************************
+   quint64 droppedCount() const
+   {
+      return droppedCount_.load(std::memory_order_relaxed);
+   }
+
+private: // data members
+   T buffer_[capacity] {}; ///< The storage for the values
+   alignas(64) std::atomic<quint32> head_ { 0 }; ///< The index of the next value to pop, written by the consumer
+   alignas(64) std::atomic<quint32> tail_ { 0 }; ///< The index of the next value to push, written by the producer
+   std::atomic<quint32> maxSize_ { 0 }; ///< The largest number of values the buffer has contained
+   std::atomic<quint64> droppedCount_ { 0 }; ///< The number of values dropped because the buffer was full
+};
+
+
+#endif // #ifndef BEEFTEXT_SPSC_RING_BUFFER_H
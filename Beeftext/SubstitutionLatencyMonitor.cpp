@@ -0,0 +1,187 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of substitution latency monitor class
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "SubstitutionLatencyMonitor.h"
+
+
+namespace {
+
+
+QString const kKeyPhases = "phases"; ///< The JSON key for the phases
+QString const kKeyExportDateTime = "exportDateTime"; ///< The JSON key for the date/time of the export
+
+
+//**********************************************************************************************************************
+/// \param[in] phase The phase
+/// \return The identifier of the phase in JSON exports
+//**********************************************************************************************************************
+QString phaseJsonKey(ESubstitutionPhase phase)
+{
+   switch (phase)
+   {
+   case ESubstitutionPhase::Matching: return "matching";
+   case ESubstitutionPhase::SnippetEvaluation: return "snippetEvaluation";
+   case ESubstitutionPhase::ClipboardBackup: return "clipboardBackup";
+   case ESubstitutionPhase::InputInjection: return "inputInjection";
+   case ESubstitutionPhase::Typing: return "typing";
+   case ESubstitutionPhase::ClipboardRestore: return "clipboardRestore";
+   case ESubstitutionPhase::TextSubstitution: return "textSubstitution";
+   case ESubstitutionPhase::TriggerToCompletion: return "triggerToCompletion";
+   default: return "unknown";
+   }
+}
+
+
+} // anonymous namespace
+
+
+//**********************************************************************************************************************
+/// \return The only allowed instance of the class
+//**********************************************************************************************************************
+SubstitutionLatencyMonitor& SubstitutionLatencyMonitor::instance()
+{
+   static SubstitutionLatencyMonitor instance;
+   return instance;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] phase The phase
+/// \return The display name of the phase
+//**********************************************************************************************************************
+QString SubstitutionLatencyMonitor::phaseName(ESubstitutionPhase phase)
+{
+   switch (phase)
+   {
+   case ESubstitutionPhase::Matching: return QObject::tr("Matching");
+   case ESubstitutionPhase::SnippetEvaluation: return QObject::tr("Snippet evaluation");
+   case ESubstitutionPhase::ClipboardBackup: return QObject::tr("Clipboard backup");
+   case ESubstitutionPhase::InputInjection: return QObject::tr("Input injection");
+   case ESubstitutionPhase::Typing: return QObject::tr("Typing");
+   case ESubstitutionPhase::ClipboardRestore: return QObject::tr("Clipboard restore");
+   case ESubstitutionPhase::TextSubstitution: return QObject::tr("Text substitution");
+   case ESubstitutionPhase::TriggerToCompletion: return QObject::tr("Trigger to completion");
+   default: return QObject::tr("Unknown");
+   }
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] phase The phase
+/// \param[in] durationNs The duration of the phase, in nanoseconds
+//**********************************************************************************************************************
+void SubstitutionLatencyMonitor::record(ESubstitutionPhase phase, qint64 durationNs)
+{
+   Q_ASSERT((phase >= ESubstitutionPhase::Matching) && (phase < ESubstitutionPhase::Count));
+   histograms_[static_cast<size_t>(phase)].record(durationNs);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] phase The phase
+/// \return The histogram for the phase
+//**********************************************************************************************************************
+LatencyHistogram const& SubstitutionLatencyMonitor::histogram(ESubstitutionPhase phase) const
+{
+   Q_ASSERT((phase >= ESubstitutionPhase::Matching) && (phase < ESubstitutionPhase::Count));
+   return histograms_[static_cast<size_t>(phase)];
+}
+
+
+//**********************************************************************************************************************
+// 
+//**********************************************************************************************************************
+void SubstitutionLatencyMonitor::reset()
+{
+   for (LatencyHistogram& histogram: histograms_)
+      histogram.reset();
+}
+
+
+//**********************************************************************************************************************
+/// \return A JSON document describing all histograms
+//**********************************************************************************************************************
+QJsonDocument SubstitutionLatencyMonitor::toJsonDocument() const
+{
+   QJsonObject phases;
+   for (qint32 i = 0; i < static_cast<qint32>(ESubstitutionPhase::Count); ++i)
+   {
+      ESubstitutionPhase const phase = static_cast<ESubstitutionPhase>(i);
+      phases.insert(phaseJsonKey(phase), this->histogram(phase).toJsonObject());
+   }
+   return QJsonDocument(QJsonObject({ { kKeyExportDateTime, QDateTime::currentDateTime().toString(Qt::ISODate) },
+      { kKeyPhases, phases } }));
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] path The path of the file
+/// \param[out] outErrorMessage If the function returns false and this parameter is not null, receives a description
+/// of the error
+/// \return true if and only if the file was successfully saved
+//**********************************************************************************************************************
+bool SubstitutionLatencyMonitor::saveToJsonFile(QString const& path, QString* outErrorMessage) const
+{
+   QFile file(path);
+   if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+   {
+      if (outErrorMessage)
+         *outErrorMessage = QString("Could not open file for writing: '%1'").arg(QDir::toNativeSeparators(path));
+      return false;
+   }
+   QByteArray const data = this->toJsonDocument().toJson();
+   if (data.size() != file.write(data))
+   {
+      if (outErrorMessage)
+         *outErrorMessage = QString("An error occurred while writing file '%1'").arg(QDir::toNativeSeparators(path));
+      return false;
+   }
+   return true;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] phase The phase
+//**********************************************************************************************************************
+LatencySpan::LatencySpan(ESubstitutionPhase phase)
+   : phase_(phase)
+{
+   timer_.start();
+}
+
+
+//**********************************************************************************************************************
+// 
+//**********************************************************************************************************************
+LatencySpan::~LatencySpan()
+{
+   this->finish();
+}
+
+
+//**********************************************************************************************************************
+// 
+//**********************************************************************************************************************
+void LatencySpan::finish()
+{
+   if (!active_)
+      return;
+   SubstitutionLatencyMonitor::instance().record(phase_, timer_.nsecsElapsed());
+   active_ = false;
+}
+
+
+//**********************************************************************************************************************
+// 
+//**********************************************************************************************************************
+void LatencySpan::cancel()
+{
+   active_ = false;
+}
@@ -0,0 +1,88 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of substitution latency monitor class
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_SUBSTITUTION_LATENCY_MONITOR_H
+#define BEEFTEXT_SUBSTITUTION_LATENCY_MONITOR_H
+
+
+#include "LatencyHistogram.h"
+
+
+//**********************************************************************************************************************
+/// \brief Enumeration for the phases of a substitution whose duration is monitored
+//**********************************************************************************************************************
+enum class ESubstitutionPhase: qint32
+{
+   Matching = 0, ///< Looking up the combos matching the typed text
+   SnippetEvaluation = 1, ///< Evaluating the snippet of the combo
+   ClipboardBackup = 2, ///< Backing up the clipboard and putting the snippet into it
+   InputInjection = 3, ///< Submitting the keystrokes that erase the keyword, insert the text and move the cursor
+   Typing = 4, ///< Synthesizing keystrokes one at a time, when a delay between keystrokes is set
+   ClipboardRestore = 5, ///< Restoring the clipboard after the substitution
+   TextSubstitution = 6, ///< The whole text substitution, from the clipboard backup to the last keystroke
+   TriggerToCompletion = 7, ///< From the keystroke triggering the combo to the end of the text substitution
+   Count = 8, ///< The number of phases
+};
+
+
+//**********************************************************************************************************************
+/// \brief A class aggregating the durations of the phases of substitutions into histograms.
+///
+/// Substitutions are performed in the main thread, and the monitor must only be used from this thread.
+//**********************************************************************************************************************
+class SubstitutionLatencyMonitor
+{
+public: // static member functions
+   static SubstitutionLatencyMonitor& instance(); ///< Return the only allowed instance of the class
+   static QString phaseName(ESubstitutionPhase phase); ///< Return the display name of a phase
+
+public: // member functions
+   SubstitutionLatencyMonitor(SubstitutionLatencyMonitor const&) = delete; ///< Disabled copy constructor
+   SubstitutionLatencyMonitor(SubstitutionLatencyMonitor&&) = delete; ///< Disabled move constructor
+   ~SubstitutionLatencyMonitor() = default; ///< Default destructor
+   SubstitutionLatencyMonitor& operator=(SubstitutionLatencyMonitor const&) = delete; ///< Disabled assignment operator
+   SubstitutionLatencyMonitor& operator=(SubstitutionLatencyMonitor&&) = delete; ///< Disabled move assignment operator
+   void record(ESubstitutionPhase phase, qint64 durationNs); ///< Record the duration of a phase
+   LatencyHistogram const& histogram(ESubstitutionPhase phase) const; ///< Return the histogram for a phase
+   void reset(); ///< Reset all histograms
+   QJsonDocument toJsonDocument() const; ///< Return a JSON document describing all histograms
+   bool saveToJsonFile(QString const& path, QString* outErrorMessage = nullptr) const; ///< Save the histograms to a JSON file
+
+private: // member functions
+   SubstitutionLatencyMonitor() = default; ///< Default constructor
+
+private: // data members
+   std::array<LatencyHistogram, static_cast<size_t>(ESubstitutionPhase::Count)> histograms_; ///< The histograms
+};
+
+
+//**********************************************************************************************************************
+/// \brief A class measuring the duration of a phase using a monotonic clock, from its construction to its destruction
+/// or to the call to finish(), whichever comes first.
+//**********************************************************************************************************************
+class LatencySpan
+{
+public: // member functions
+   explicit LatencySpan(ESubstitutionPhase phase); ///< Default constructor
+   LatencySpan(LatencySpan const&) = delete; ///< Disabled copy constructor
+   LatencySpan(LatencySpan&&) = delete; ///< Disabled move constructor
+   ~LatencySpan(); ///< Destructor
+   LatencySpan& operator=(LatencySpan const&) = delete; ///< Disabled assignment operator
+   LatencySpan& operator=(LatencySpan&&) = delete; ///< Disabled move assignment operator
+   void finish(); ///< Record the duration of the phase now
+   void cancel(); ///< Cancel the span, the duration of the phase will not be recorded
+
+private: // data members
+   ESubstitutionPhase phase_; ///< The phase
+   QElapsedTimer timer_; ///< The timer
+   bool active_ { true }; ///< Is the span still active
+};
+
+
+#endif // #ifndef BEEFTEXT_SUBSTITUTION_LATENCY_MONITOR_H
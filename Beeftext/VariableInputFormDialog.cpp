@@ -0,0 +1,85 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of dialog class for interactively providing the values of several variables at once
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "VariableInputFormDialog.h"
+#include <XMiLib/XMiLibConstants.h>
+
+
+//**********************************************************************************************************************
+/// \param[in] descriptions The descriptions of the variables
+/// \param[out] outUserInputs The values entered by the user, in the same order as the descriptions
+/// \return true if and only if the user validated the dialog
+//**********************************************************************************************************************
+bool VariableInputFormDialog::run(QStringList const& descriptions, QStringList& outUserInputs)
+{
+   VariableInputFormDialog dlg(descriptions);
+   if (Accepted != dlg.exec())
+      return false;
+   outUserInputs = dlg.userInputs();
+   return true;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] descriptions The descriptions of the variables
+//**********************************************************************************************************************
+VariableInputFormDialog::VariableInputFormDialog(QStringList const& descriptions)
+   : QDialog(nullptr, xmilib::constants::kDefaultDialogFlags)
+{
+   QFormLayout* formLayout = new QFormLayout;
+   for (QString const& description: descriptions)
+   {
+      QLineEdit* edit = new QLineEdit(this);
+      formLayout->addRow(description, edit);
+      edits_.append(edit);
+   }
+   QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+   connect(buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+   connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+   QVBoxLayout* layout = new QVBoxLayout(this);
+   layout->addLayout(formLayout);
+   layout->addWidget(buttonBox);
+   this->show();
+}
+
+
+//**********************************************************************************************************************
+/// \return The values entered by the user, in the same order as the descriptions
+//**********************************************************************************************************************
+QStringList VariableInputFormDialog::userInputs() const
+{
+   QStringList result;
+   for (QLineEdit const* edit: edits_)
+      result.append(edit->text());
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] event The event.
+//**********************************************************************************************************************
+void VariableInputFormDialog::showEvent(QShowEvent* event)
+{
+   this->raise();
+   this->activateWindow();
+   QDialog::showEvent(event);
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] event The event
+//**********************************************************************************************************************
+void VariableInputFormDialog::changeEvent(QEvent* event)
+{
+   if ((event->type() == QEvent::ActivationChange) && !this->isActiveWindow())
+      this->reject(); // when the dialog looses the focus, we dismiss is because we don't know where the input
+         // focus can be now.
+   QWidget::changeEvent(event);
+}
@@ -0,0 +1,41 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of dialog class for interactively providing the values of several variables at once
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_VARIABLE_INPUT_FORM_DIALOG_H
+#define BEEFTEXT_VARIABLE_INPUT_FORM_DIALOG_H
+
+
+//**********************************************************************************************************************
+/// \brief A dialog class for interactively providing the values of several variables in a single form
+//**********************************************************************************************************************
+class VariableInputFormDialog: public QDialog
+{
+   Q_OBJECT
+public: // static member functions
+   static bool run(QStringList const& descriptions, QStringList& outUserInputs); ///< Run the dialog
+
+public: // member functions
+   explicit VariableInputFormDialog(QStringList const& descriptions); ///< Default constructor
+   VariableInputFormDialog(VariableInputFormDialog const&) = delete; ///< Disabled copy-constructor
+   VariableInputFormDialog(VariableInputFormDialog&&) = delete; ///< Disabled assignment copy-constructor
+   ~VariableInputFormDialog() override = default; ///< Destructor
+   VariableInputFormDialog& operator=(VariableInputFormDialog const&) = delete; ///< Disabled assignment operator
+   VariableInputFormDialog& operator=(VariableInputFormDialog&&) = delete; ///< Disabled move assignment operator
+   QStringList userInputs() const; ///< Return the values entered by the user
+
+protected: // member functions
+   void showEvent(QShowEvent* event) override; ///< Callback for the show event
+   void changeEvent(QEvent*) override; ///< Change event handler
+
+private: // data members
+   QList<QLineEdit*> edits_; ///< The line edits, one per variable
+};
+
+
+#endif // #ifndef BEEFTEXT_VARIABLE_INPUT_FORM_DIALOG_H
@@ -18,6 +18,7 @@
 #include "I18nManager.h"
 #include "Combo/ComboManager.h"
 #include "Combo/LastUseFile.h"
+#include "BenchmarkCommandLine.h"
 #include <XMiLib/SingleInstanceApp.h>
 #include <XMiLib/SystemUtils.h>
 #include <XMiLib/Exception.h>
@@ -48,6 +49,11 @@ int main(int argc, char *argv[])
    {
       QApplication app(argc, argv);
 
+      // benchmarks use a sandbox data folder, so they can run alongside a running instance of the application
+      QStringList const arguments = QCoreApplication::arguments();
+      if (isBenchmarkCommandLine(arguments))
+         return runBenchmarkCommandLine(arguments);
+
       // check for an existing instance of the application
       SingleInstanceApplication singleInstanceApp("BeeftextSingleInstanceIdentifier");
       if (!singleInstanceApp.isFirstInstance())
@@ -102,6 +108,7 @@ int main(int argc, char *argv[])
          &window, &MainWindow::onAnotherAppInstanceLaunch);
       prefs.setAlreadyLaunched();
       qint32 const returnCode = QApplication::exec();
+      comboManager.flushComboListSave();
       saveLastUseDateTimes(comboManager.comboListRef());
       debugLog.addInfo(QString("Application exited with return code %1").arg(returnCode));
       I18nManager::instance().unloadTranslation(); // required to avoid crash because otherwise the app instance could be destroyed before the translators
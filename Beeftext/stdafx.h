@@ -14,6 +14,7 @@
 #include <QtMultimedia>
 #include <QtWidgets>
 #include <QtNetwork>
+#include <QtConcurrent>
 #include <QtGui>
 #include <QtCore>
 
@@ -0,0 +1,138 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the tests for the input manager
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "InputManagerTests.h"
+#include "AllocationCounter.h"
+#include "InputManager.h"
+#include "PreferencesManager.h"
+#include "InputBackend/InputBackend.h"
+#include <QtTest>
+
+
+namespace {
+
+
+qint32 const kKeystrokeCount = 256; ///< The number of keystrokes processed by each test, less than the queue capacity
+
+
+#ifdef Q_OS_WIN
+//**********************************************************************************************************************
+/// \param[in] virtualKey The virtual key code
+/// \return A keystroke with no modifier key pressed
+//**********************************************************************************************************************
+InputManager::KeyStroke keyStroke(quint32 virtualKey)
+{
+   InputManager::KeyStroke result = { virtualKey, MapVirtualKey(virtualKey, MAPVK_VK_TO_VSC), { 0 } };
+   return result;
+}
+#endif // #ifdef Q_OS_WIN
+
+
+//**********************************************************************************************************************
+/// \brief Remove all the pending events from the key event queue
+//**********************************************************************************************************************
+void drainKeyEvents()
+{
+   InputManager::KeyEvent event;
+   while (InputManager::instance().popKeyEvent(event))
+      ;
+}
+
+
+} // anonymous namespace
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void InputManagerTests::initTestCase()
+{
+   QCOMPARE(InputBackend::instance().type(), InputBackend::EType::Headless);
+   QVERIFY(PreferencesManager::instance().beeftextEnabled());
+   (void)InputManager::instance();
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void InputManagerTests::cleanup()
+{
+   drainKeyEvents();
+}
+
+
+//**********************************************************************************************************************
+/// The first event pushed to an empty queue notifies the matching engine, which can allocate a queued signal event.
+/// This happens once per burst of keystrokes, so the measure starts after it.
+//**********************************************************************************************************************
+void InputManagerTests::keyboardEventDoesNotAllocate()
+{
+#ifdef Q_OS_WIN
+   InputManager& inputManager = InputManager::instance();
+   InputManager::KeyStroke const stroke = keyStroke('A');
+   inputManager.onKeyboardEvent(stroke);
+   quint32 const depth = inputManager.keyEventQueueDepth();
+   QVERIFY(depth > 0);
+   {
+      AllocationCounter const counter;
+      for (qint32 i = 0; i < kKeystrokeCount; ++i)
+         QVERIFY(inputManager.onKeyboardEvent(stroke));
+      QCOMPARE(counter.count(), 0LL);
+   }
+   QCOMPARE(inputManager.keyEventQueueDepth(), depth * (kKeystrokeCount + 1));
+#else
+   QSKIP("The keyboard hook callback is only available on Windows");
+#endif // #ifdef Q_OS_WIN
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void InputManagerTests::comboBreakerKeyDoesNotAllocate()
+{
+#ifdef Q_OS_WIN
+   InputManager& inputManager = InputManager::instance();
+   InputManager::KeyStroke const stroke = keyStroke(VK_LEFT);
+   inputManager.onKeyboardEvent(stroke);
+   {
+      AllocationCounter const counter;
+      for (qint32 i = 0; i < kKeystrokeCount; ++i)
+         QVERIFY(inputManager.onKeyboardEvent(stroke));
+      QCOMPARE(counter.count(), 0LL);
+   }
+   QCOMPARE(inputManager.keyEventQueueDepth(), quint32(kKeystrokeCount + 1));
+   InputManager::KeyEvent event;
+   QVERIFY(inputManager.popKeyEvent(event));
+   QCOMPARE(event.type, InputManager::EKeyEventType::ComboBreaker);
+#else
+   QSKIP("The keyboard hook callback is only available on Windows");
+#endif // #ifdef Q_OS_WIN
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void InputManagerTests::typedCharacterDoesNotAllocate()
+{
+   InputManager& inputManager = InputManager::instance();
+   QString const text = "Lorem ipsum, dolor sit amet\b\b\b\b";
+   inputManager.pushTypedCharacter('a');
+   {
+      AllocationCounter const counter;
+      for (qint32 i = 0; i < kKeystrokeCount; ++i)
+         inputManager.pushTypedCharacter(text[i % text.size()]);
+      QCOMPARE(counter.count(), 0LL);
+   }
+   QCOMPARE(inputManager.keyEventQueueDepth(), quint32(kKeystrokeCount + 1));
+   QCOMPARE(inputManager.droppedKeyEventCount(), 0ULL);
+}
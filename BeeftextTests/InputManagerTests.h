@@ -0,0 +1,32 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of the tests for the input manager
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_TESTS_INPUT_MANAGER_TESTS_H
+#define BEEFTEXT_TESTS_INPUT_MANAGER_TESTS_H
+
+
+//**********************************************************************************************************************
+/// \brief Tests for the input manager.
+///
+/// The tests run with the headless input backend, so no hook is installed, and they call the keyboard event callback
+/// directly, as the hook procedure would.
+//**********************************************************************************************************************
+class InputManagerTests: public QObject
+{
+   Q_OBJECT
+private slots:
+   void initTestCase(); ///< Initialize the test case
+   void cleanup(); ///< Clean up after each test
+   void keyboardEventDoesNotAllocate(); ///< Check that processing an ordinary keystroke does not allocate memory
+   void comboBreakerKeyDoesNotAllocate(); ///< Check that processing a combo breaker key does not allocate memory
+   void typedCharacterDoesNotAllocate(); ///< Check that pushing typed characters does not allocate memory
+};
+
+
+#endif // #ifndef BEEFTEXT_TESTS_INPUT_MANAGER_TESTS_H
@@ -0,0 +1,203 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the tests for the keystroke sequence class
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "KeystrokeSequenceTests.h"
+#include "InputBackend/KeystrokeSequence.h"
+#include <QtTest>
+
+
+namespace {
+
+
+quint16 const kKeyLeftShift = 0xa0; ///< The left Shift key (VK_LSHIFT)
+
+
+//**********************************************************************************************************************
+/// \param[in] virtualKey The virtual key code
+/// \param[in] keyUp Is the keystroke a key release
+/// \return A readable description of the keystroke
+//**********************************************************************************************************************
+QString keyString(quint16 virtualKey, bool keyUp)
+{
+   return QString("vk%1 %2").arg(virtualKey, 2, 16, QChar('0')).arg(keyUp ? "up" : "down");
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] c The character
+/// \param[in] keyUp Is the keystroke a key release
+/// \return A readable description of the keystroke
+//**********************************************************************************************************************
+QString characterString(QChar c, bool keyUp)
+{
+   return QString("'%1' %2").arg(c).arg(keyUp ? "up" : "down");
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] virtualKey The virtual key code
+/// \param[in] count The number of key presses
+/// \return The readable descriptions of count press and release pairs of a key
+//**********************************************************************************************************************
+QStringList keyPressStrings(quint16 virtualKey, qint32 count = 1)
+{
+   QStringList result;
+   for (qint32 i = 0; i < count; ++i)
+      result << keyString(virtualKey, false) << keyString(virtualKey, true);
+   return result;
+}
+
+
+//**********************************************************************************************************************
+/// \param[in] sequence The keystroke sequence
+/// \return The readable descriptions of the keystrokes of the sequence, so that QCOMPARE reports meaningful differences
+//**********************************************************************************************************************
+QStringList sequenceStrings(KeystrokeSequence const& sequence)
+{
+   QStringList result;
+   for (KeystrokeSequence::Keystroke const& keystroke: sequence.keystrokes())
+      result.append(keystroke.virtualKey ? keyString(keystroke.virtualKey, keystroke.keyUp) :
+         characterString(QChar(keystroke.character), keystroke.keyUp));
+   return result;
+}
+
+
+} // anonymous namespace
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void KeystrokeSequenceTests::modifiersAreReleasedAndRestored()
+{
+   QList<quint16> const modifiers = { KeystrokeSequence::KeyRightControl, kKeyLeftShift };
+   KeystrokeSequence const sequence = KeystrokeSequence::forSubstitution(modifiers, 1, true, QString(), 0);
+   QStringList const expected = QStringList { keyString(KeystrokeSequence::KeyRightControl, true),
+      keyString(kKeyLeftShift, true) } + keyPressStrings(KeystrokeSequence::KeyBackspace)
+      + QStringList { keyString(KeystrokeSequence::KeyLeftControl, false) } + keyPressStrings(KeystrokeSequence::KeyV)
+      + QStringList { keyString(KeystrokeSequence::KeyLeftControl, true),
+      keyString(KeystrokeSequence::KeyRightControl, false), keyString(kKeyLeftShift, false) };
+   QCOMPARE(sequenceStrings(sequence), expected);
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void KeystrokeSequenceTests::eraseCount()
+{
+   QCOMPARE(sequenceStrings(KeystrokeSequence::forSubstitution({}, 3, false, QString(), 0)),
+      keyPressStrings(KeystrokeSequence::KeyBackspace, 3));
+   QVERIFY(KeystrokeSequence::forSubstitution({}, 0, false, QString(), 0).isEmpty());
+   QVERIFY(KeystrokeSequence::forSubstitution({}, -1, false, QString(), 0).isEmpty());
+}
+
+
+//**********************************************************************************************************************
+/// When pasting, the text is in the clipboard, so the text parameter is ignored.
+//**********************************************************************************************************************
+void KeystrokeSequenceTests::pastedText()
+{
+   KeystrokeSequence const sequence = KeystrokeSequence::forSubstitution({}, 2, true, "ignored", 0);
+   QStringList const expected = keyPressStrings(KeystrokeSequence::KeyBackspace, 2)
+      + QStringList { keyString(KeystrokeSequence::KeyLeftControl, false) } + keyPressStrings(KeystrokeSequence::KeyV)
+      + QStringList { keyString(KeystrokeSequence::KeyLeftControl, true) };
+   QCOMPARE(sequenceStrings(sequence), expected);
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void KeystrokeSequenceTests::typedText()
+{
+   KeystrokeSequence const sequence = KeystrokeSequence::forSubstitution({}, 1, false, "a\nb", 0);
+   QStringList const expected = keyPressStrings(KeystrokeSequence::KeyBackspace)
+      + QStringList { characterString('a', false), characterString('a', true) }
+      + keyPressStrings(KeystrokeSequence::KeyReturn)
+      + QStringList { characterString('b', false), characterString('b', true) };
+   QCOMPARE(sequenceStrings(sequence), expected);
+   for (KeystrokeSequence::Keystroke const& keystroke: sequence.keystrokes())
+      QVERIFY(keystroke.character != QChar::LineFeed);
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void KeystrokeSequenceTests::cursorLeftCount()
+{
+   KeystrokeSequence const sequence = KeystrokeSequence::forSubstitution({}, 0, false, "xy", 4);
+   QStringList const expected = QStringList { characterString('x', false), characterString('x', true),
+      characterString('y', false), characterString('y', true) } + keyPressStrings(KeystrokeSequence::KeyLeft, 4);
+   QCOMPARE(sequenceStrings(sequence), expected);
+}
+
+
+//**********************************************************************************************************************
+/// Erasing a long keyword produces a sequence longer than the maximum chunk size, that must be submitted in several
+/// consecutive chunks covering the whole sequence.
+//**********************************************************************************************************************
+void KeystrokeSequenceTests::chunking()
+{
+   qint32 const maxSize = KeystrokeSequence::maxChunkSize;
+   QCOMPARE(maxSize, 512);
+   KeystrokeSequence const sequence = KeystrokeSequence::forSubstitution({ kKeyLeftShift }, maxSize, true, QString(),
+      3);
+   qint32 const size = sequence.size();
+   QCOMPARE(size, 2 + (2 * maxSize) + 4 + 6);
+
+   QList<qint32> firsts;
+   QList<qint32> sizes;
+   KeystrokeSequence::Keystroke const* const data = sequence.keystrokes().constData();
+   KeystrokeSequence::ChunkHandler const handler = [&](KeystrokeSequence::Keystroke const* chunk, qint32 chunkSize)
+      -> bool
+   {
+      firsts.append(static_cast<qint32>(chunk - data));
+      sizes.append(chunkSize);
+      return true;
+   };
+   QVERIFY(sequence.forEachChunk(0, size, handler));
+   QCOMPARE(firsts, QList<qint32>({ 0, maxSize, 2 * maxSize }));
+   QCOMPARE(sizes, QList<qint32>({ maxSize, maxSize, size - (2 * maxSize) }));
+
+   // a sub-range, and a range exceeding the end of the sequence
+   firsts.clear();
+   sizes.clear();
+   QVERIFY(sequence.forEachChunk(10, maxSize + 20, handler));
+   QVERIFY(sequence.forEachChunk((2 * maxSize) + 1, size, handler));
+   QCOMPARE(firsts, QList<qint32>({ 10, 10 + maxSize, (2 * maxSize) + 1 }));
+   QCOMPARE(sizes, QList<qint32>({ maxSize, 20, size - (2 * maxSize) - 1 }));
+
+   // a range of exactly one chunk, and an empty range
+   firsts.clear();
+   sizes.clear();
+   QVERIFY(sequence.forEachChunk(1, maxSize, handler));
+   QVERIFY(sequence.forEachChunk(size, 1, handler));
+   QCOMPARE(firsts, QList<qint32>({ 1 }));
+   QCOMPARE(sizes, QList<qint32>({ maxSize }));
+}
+
+
+//**********************************************************************************************************************
+//
+//**********************************************************************************************************************
+void KeystrokeSequenceTests::chunkingStopsOnFailure()
+{
+   KeystrokeSequence const sequence = KeystrokeSequence::forSubstitution({}, 2 * KeystrokeSequence::maxChunkSize,
+      false, QString(), 0);
+   qint32 callCount = 0;
+   QVERIFY(!sequence.forEachChunk(0, sequence.size(), [&](KeystrokeSequence::Keystroke const*, qint32) -> bool
+   {
+      ++callCount;
+      return false;
+   }));
+   QCOMPARE(callCount, 1);
+}
@@ -0,0 +1,34 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Declaration of the tests for the keystroke sequence class
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#ifndef BEEFTEXT_TESTS_KEYSTROKE_SEQUENCE_TESTS_H
+#define BEEFTEXT_TESTS_KEYSTROKE_SEQUENCE_TESTS_H
+
+
+//**********************************************************************************************************************
+/// \brief Tests for the keystroke sequence class.
+///
+/// The sequences are the ones the Win32 backend submits to the system for a substitution, so the tests do not need a
+/// desktop session.
+//**********************************************************************************************************************
+class KeystrokeSequenceTests: public QObject
+{
+   Q_OBJECT
+private slots:
+   void modifiersAreReleasedAndRestored(); ///< Check that the pressed modifier keys are released first and restored last
+   void eraseCount(); ///< Check the keystrokes erasing the keyword
+   void pastedText(); ///< Check the keystrokes pasting the text
+   void typedText(); ///< Check the keystrokes typing the text, including line feeds
+   void cursorLeftCount(); ///< Check the keystrokes moving the cursor to the left
+   void chunking(); ///< Check the splitting of long sequences into chunks
+   void chunkingStopsOnFailure(); ///< Check that the iteration on chunks stops when the handler fails
+};
+
+
+#endif // #ifndef BEEFTEXT_TESTS_KEYSTROKE_SEQUENCE_TESTS_H
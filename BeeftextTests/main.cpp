@@ -0,0 +1,41 @@
+/// \file
+/// \author Xavier Michelon
+///
+/// \brief Implementation of the entry point of the test executable
+///
+/// Copyright (c) Xavier Michelon. All rights reserved.
+/// Licensed under the MIT License. See LICENSE file in the project root for full license information.
+
+
+#include "stdafx.h"
+#include "InputManagerTests.h"
+#include "KeystrokeSequenceTests.h"
+#include "BeeftextGlobals.h"
+#include "InputBackend/InputBackend.h"
+#include <QtTest>
+
+
+//**********************************************************************************************************************
+/// The tests run with a temporary sandbox data folder, so they never read or modify the preferences and data of the
+/// user, and with the headless input backend, so no hook is installed.
+///
+/// \param[in] argc The number of command line arguments
+/// \param[in] argv The command line arguments
+/// \return The number of failed test classes
+//**********************************************************************************************************************
+int main(int argc, char *argv[])
+{
+   QApplication app(argc, argv);
+   QTemporaryDir const sandboxDir;
+   if (!sandboxDir.isValid())
+      return 1;
+   globals::setSandboxDataFolderPath(sandboxDir.path());
+   InputBackend::setInputBackendType(InputBackend::EType::Headless);
+
+   qint32 result = 0;
+   InputManagerTests inputManagerTests;
+   result += QTest::qExec(&inputManagerTests, argc, argv) ? 1 : 0;
+   KeystrokeSequenceTests keystrokeSequenceTests;
+   result += QTest::qExec(&keystrokeSequenceTests, argc, argv) ? 1 : 0;
+   return result;
+}